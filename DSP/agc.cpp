@@ -1,14 +1,112 @@
 #include "agc.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace DSP {
 
-Agc::Agc(float targetAmplitude, float maxGain, float windowSize, float biasWindowSize)
+Agc::Agc(float targetAmplitude, float maxGain, float windowSize, float biasWindowSize, Mode mode)
     : mWindowSize(windowSize)
     , mAvg(targetAmplitude)
     , mGain(1)
     , mMaxGain(maxGain)
     , mTargetAmplitude(targetAmplitude)
     , mBiasWindowSize(biasWindowSize)
-    , mBias(0) {}
+    , mBias(0)
+    , mMode(mode)
+    , mAvgBlockDecay(1.0f)
+    , mBiasBlockDecay(1.0f) {
+
+    if(mMode == Mode::Sample) {
+        return;
+    }
+
+    if(mMode == Mode::BlockPower) {
+        mAvg = targetAmplitude * targetAmplitude;
+    }
+
+    // avg[n] = avg[n - 1] * (W - 1) / W + x[n] / W unrolled over a block:
+    // avg[N] = avg[0] * a^N + sum(x[k] * a^(N - 1 - k) / W)
+    mAvgWeights.resize(cBlockSize);
+    mBiasWeights.resize(cBlockSize);
+    double avgDecay = (static_cast<double>(mWindowSize) - 1.0) / mWindowSize;
+    double biasDecay = (static_cast<double>(mBiasWindowSize) - 1.0) / mBiasWindowSize;
+    for(int k = 0; k < cBlockSize; k++) {
+        mAvgWeights[k] = static_cast<float>(std::pow(avgDecay, cBlockSize - 1 - k) / mWindowSize);
+        mBiasWeights[k] = static_cast<float>(std::pow(biasDecay, cBlockSize - 1 - k) / mBiasWindowSize);
+    }
+    mAvgBlockDecay = static_cast<float>(std::pow(avgDecay, cBlockSize));
+    mBiasBlockDecay = static_cast<float>(std::pow(biasDecay, cBlockSize));
+}
+
+int Agc::processBlocks(const complex* inSamples, complex* outSamples, int count) {
+    const float* in = reinterpret_cast<const float*>(inSamples);
+    float* out = reinterpret_cast<float*>(outSamples);
+
+    for(int offset = 0; offset < count; offset += cBlockSize) {
+        processBlock(in + offset * 2, out + offset * 2, std::min(cBlockSize, count - offset));
+    }
+    return count;
+}
+
+void Agc::processBlock(const float* in, float* out, int count) {
+    const float biasRe = mBias.real();
+    const float biasIm = mBias.imag();
+    const float gain = mGain;
+
+    // A partial block uses the tail of the weights, so its last sample still has the highest weight
+    const float* avgWeights = mAvgWeights.data() + cBlockSize - count;
+    const float* biasWeights = mBiasWeights.data() + cBlockSize - count;
+
+    // Four independent partial sums, keeps the loop free of a serial dependency
+    float sumRe[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sumIm[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sumAvg[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const bool power = mMode == Mode::BlockPower;
+
+    int k = 0;
+    for(; k + 4 <= count; k += 4) {
+        for(int lane = 0; lane < 4; lane++) {
+            const float re = in[(k + lane) * 2];
+            const float im = in[(k + lane) * 2 + 1];
+            const float centeredRe = re - biasRe;
+            const float centeredIm = im - biasIm;
+            const float magnitude = centeredRe * centeredRe + centeredIm * centeredIm;
+
+            out[(k + lane) * 2] = centeredRe * gain;
+            out[(k + lane) * 2 + 1] = centeredIm * gain;
+
+            sumRe[lane] += re * biasWeights[k + lane];
+            sumIm[lane] += im * biasWeights[k + lane];
+            sumAvg[lane] += (power ? magnitude : std::sqrt(magnitude)) * avgWeights[k + lane];
+        }
+    }
+    for(; k < count; k++) {
+        const float re = in[k * 2];
+        const float im = in[k * 2 + 1];
+        const float centeredRe = re - biasRe;
+        const float centeredIm = im - biasIm;
+        const float magnitude = centeredRe * centeredRe + centeredIm * centeredIm;
+
+        out[k * 2] = centeredRe * gain;
+        out[k * 2 + 1] = centeredIm * gain;
+
+        sumRe[0] += re * biasWeights[k];
+        sumIm[0] += im * biasWeights[k];
+        sumAvg[0] += (power ? magnitude : std::sqrt(magnitude)) * avgWeights[k];
+    }
+
+    const bool fullBlock = count == cBlockSize;
+    const float avgDecay = fullBlock ? mAvgBlockDecay : std::pow((mWindowSize - 1.0f) / mWindowSize, static_cast<float>(count));
+    const float biasDecay = fullBlock ? mBiasBlockDecay : std::pow((mBiasWindowSize - 1.0f) / mBiasWindowSize, static_cast<float>(count));
+
+    mBias = mBias * biasDecay + complex((sumRe[0] + sumRe[1]) + (sumRe[2] + sumRe[3]), (sumIm[0] + sumIm[1]) + (sumIm[2] + sumIm[3]));
+    mAvg = mAvg * avgDecay + (sumAvg[0] + sumAvg[1]) + (sumAvg[2] + sumAvg[3]);
+
+    mGain = mTargetAmplitude / (power ? std::sqrt(mAvg) : mAvg);
+    if(mGain > mMaxGain) {
+        mGain = mMaxGain;
+    }
+}
 
 } // namespace DSP
@@ -2,17 +2,32 @@
 #define AGC_H
 
 #include <complex>
+#include <vector>
+
+#include "stage.h"
 
 namespace DSP {
 
-class Agc {
+class Agc : public Stage<Agc> {
   public:
     typedef std::complex<float> complex;
 
+    // Sample: bias, magnitude average and gain are updated for every sample (reference behaviour)
+    // Block: the averages are updated once per cBlockSize samples from weighted block sums, the gain is constant within a block
+    // BlockPower: as Block, but tracks the mean squared magnitude, so no square root is needed per sample
+    enum class Mode { Sample, Block, BlockPower };
+
   public:
-    Agc(float targetAmplitude, float maxGain = 20, float windowSize = 1024 * 64, float biasWindowSize = 256 * 1024);
+    Agc(float targetAmplitude, float maxGain = 20, float windowSize = 1024 * 64, float biasWindowSize = 256 * 1024, Mode mode = Mode::Sample);
+
+    int process(const complex* inSamples, complex* outSamples, int count) {
+        if(mMode == Mode::Sample) {
+            return Stage<Agc>::process(inSamples, outSamples, count);
+        }
+        return processBlocks(inSamples, outSamples, count);
+    }
 
-    inline complex process(complex sample) {
+    inline complex processSample(complex sample) {
         float rho;
 
         mBias = (mBias * static_cast<float>(mBiasWindowSize - 1) + sample) / static_cast<float>(mBiasWindowSize);
@@ -29,18 +44,19 @@ class Agc {
         return sample * mGain;
     }
 
-    inline void process(const complex* inSamples, complex* outsamples, unsigned int count) {
-        for(unsigned int i = 0; i < count; i++) {
-            *outsamples = process(*inSamples++);
-            outsamples++;
-        }
-    }
-
   public:
     float getGain() const {
         return mGain;
     }
 
+  private:
+    int processBlocks(const complex* inSamples, complex* outSamples, int count);
+    void processBlock(const float* in, float* out, int count);
+
+  private:
+    // Both windows are much longer than a block, the gain changes less than 0.5% within one
+    static constexpr int cBlockSize = 256;
+
   private:
     uint32_t mWindowSize;
     float mAvg;
@@ -49,6 +65,12 @@ class Agc {
     float mTargetAmplitude;
     float mBiasWindowSize;
     complex mBias;
+    Mode mMode;
+    // Weights of the samples in a full block, the last sample of the block has the highest weight
+    std::vector<float> mAvgWeights;
+    std::vector<float> mBiasWeights;
+    float mAvgBlockDecay;
+    float mBiasBlockDecay;
 };
 
 } // namespace DSP
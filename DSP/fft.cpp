@@ -0,0 +1,220 @@
+#include "fft.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace DSP {
+
+FFT::FFT(int size)
+    : mSize(size)
+    , mStage(stageGeneric)
+    , mStageMinHalf(1) {
+    if(!isPowerOfTwo(size)) {
+        throw std::invalid_argument("FFT size must be a power of two");
+    }
+
+    int bits = 0;
+    while((1 << bits) < mSize) {
+        bits++;
+    }
+
+    mBitReverse.resize(mSize);
+    for(int i = 0; i < mSize; i++) {
+        int reversed = 0;
+        for(int b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        mBitReverse[i] = reversed;
+    }
+
+    // Twiddles are stored stage by stage, so the butterflies read them contiguously.
+    // The stage with butterfly span half starts at offset half - 1.
+    const int twiddleCount = mSize > 1 ? mSize - 1 : 0;
+    mTwiddleRe.resize(twiddleCount);
+    mTwiddleIm.resize(twiddleCount);
+    mInverseTwiddleIm.resize(twiddleCount);
+    for(int half = 1; half < mSize; half <<= 1) {
+        for(int k = 0; k < half; k++) {
+            double phase = -M_PI * k / half;
+            mTwiddleRe[half - 1 + k] = static_cast<float>(std::cos(phase));
+            mTwiddleIm[half - 1 + k] = static_cast<float>(std::sin(phase));
+            mInverseTwiddleIm[half - 1 + k] = -mTwiddleIm[half - 1 + k];
+        }
+    }
+
+    // Stages narrower than the vector width stay on the generic path
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        mStage = stageAVX2;
+        mStageMinHalf = 8;
+    } else if(cpu.hasSSE2()) {
+        mStage = stageSSE;
+        mStageMinHalf = 4;
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        mStage = stageNEON;
+        mStageMinHalf = 4;
+    }
+#endif
+    (void)cpu;
+}
+
+void FFT::forward(float* re, float* im) const {
+    transform(re, im, mTwiddleIm);
+}
+
+void FFT::inverse(float* re, float* im) const {
+    transform(re, im, mInverseTwiddleIm);
+}
+
+void FFT::transform(float* re, float* im, const std::vector<float>& twiddleIm) const {
+    for(int i = 0; i < mSize; i++) {
+        int j = mBitReverse[i];
+        if(i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for(int half = 1; half < mSize; half <<= 1) {
+        StageFunc stage = half >= mStageMinHalf ? mStage : stageGeneric;
+        stage(re, im, &mTwiddleRe[half - 1], &twiddleIm[half - 1], mSize, half);
+    }
+}
+
+void FFT::stageGeneric(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    for(int start = 0; start < size; start += half * 2) {
+        float* ar = re + start;
+        float* ai = im + start;
+        float* br = ar + half;
+        float* bi = ai + half;
+
+        for(int k = 0; k < half; k++) {
+            const float tr = br[k] * wr[k] - bi[k] * wi[k];
+            const float ti = br[k] * wi[k] + bi[k] * wr[k];
+
+            br[k] = ar[k] - tr;
+            bi[k] = ai[k] - ti;
+            ar[k] += tr;
+            ai[k] += ti;
+        }
+    }
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 void FFT::stageSSE(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    for(int start = 0; start < size; start += half * 2) {
+        float* ar = re + start;
+        float* ai = im + start;
+        float* br = ar + half;
+        float* bi = ai + half;
+
+        for(int k = 0; k < half; k += 4) {
+            const __m128 vwr = _mm_loadu_ps(wr + k);
+            const __m128 vwi = _mm_loadu_ps(wi + k);
+            const __m128 vbr = _mm_loadu_ps(br + k);
+            const __m128 vbi = _mm_loadu_ps(bi + k);
+            const __m128 var = _mm_loadu_ps(ar + k);
+            const __m128 vai = _mm_loadu_ps(ai + k);
+
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(vbr, vwr), _mm_mul_ps(vbi, vwi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(vbr, vwi), _mm_mul_ps(vbi, vwr));
+
+            _mm_storeu_ps(br + k, _mm_sub_ps(var, tr));
+            _mm_storeu_ps(bi + k, _mm_sub_ps(vai, ti));
+            _mm_storeu_ps(ar + k, _mm_add_ps(var, tr));
+            _mm_storeu_ps(ai + k, _mm_add_ps(vai, ti));
+        }
+    }
+}
+
+TARGET_AVX2 void FFT::stageAVX2(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    for(int start = 0; start < size; start += half * 2) {
+        float* ar = re + start;
+        float* ai = im + start;
+        float* br = ar + half;
+        float* bi = ai + half;
+
+        for(int k = 0; k < half; k += 8) {
+            const __m256 vwr = _mm256_loadu_ps(wr + k);
+            const __m256 vwi = _mm256_loadu_ps(wi + k);
+            const __m256 vbr = _mm256_loadu_ps(br + k);
+            const __m256 vbi = _mm256_loadu_ps(bi + k);
+            const __m256 var = _mm256_loadu_ps(ar + k);
+            const __m256 vai = _mm256_loadu_ps(ai + k);
+
+            const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(vbr, vwr), _mm256_mul_ps(vbi, vwi));
+            const __m256 ti = _mm256_add_ps(_mm256_mul_ps(vbr, vwi), _mm256_mul_ps(vbi, vwr));
+
+            _mm256_storeu_ps(br + k, _mm256_sub_ps(var, tr));
+            _mm256_storeu_ps(bi + k, _mm256_sub_ps(vai, ti));
+            _mm256_storeu_ps(ar + k, _mm256_add_ps(var, tr));
+            _mm256_storeu_ps(ai + k, _mm256_add_ps(vai, ti));
+        }
+    }
+}
+
+#else
+
+void FFT::stageSSE(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    stageGeneric(re, im, wr, wi, size, half);
+}
+
+void FFT::stageAVX2(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    stageGeneric(re, im, wr, wi, size, half);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+void FFT::stageNEON(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    for(int start = 0; start < size; start += half * 2) {
+        float* ar = re + start;
+        float* ai = im + start;
+        float* br = ar + half;
+        float* bi = ai + half;
+
+        for(int k = 0; k < half; k += 4) {
+            const float32x4_t vwr = vld1q_f32(wr + k);
+            const float32x4_t vwi = vld1q_f32(wi + k);
+            const float32x4_t vbr = vld1q_f32(br + k);
+            const float32x4_t vbi = vld1q_f32(bi + k);
+            const float32x4_t var = vld1q_f32(ar + k);
+            const float32x4_t vai = vld1q_f32(ai + k);
+
+            const float32x4_t tr = vmlsq_f32(vmulq_f32(vbr, vwr), vbi, vwi);
+            const float32x4_t ti = vmlaq_f32(vmulq_f32(vbr, vwi), vbi, vwr);
+
+            vst1q_f32(br + k, vsubq_f32(var, tr));
+            vst1q_f32(bi + k, vsubq_f32(vai, ti));
+            vst1q_f32(ar + k, vaddq_f32(var, tr));
+            vst1q_f32(ai + k, vaddq_f32(vai, ti));
+        }
+    }
+}
+
+#else
+
+void FFT::stageNEON(float* re, float* im, const float* wr, const float* wi, int size, int half) {
+    stageGeneric(re, im, wr, wi, size, half);
+}
+
+#endif
+
+} // namespace DSP
@@ -0,0 +1,58 @@
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#include <vector>
+
+namespace DSP {
+
+// In-place iterative radix-2 FFT on split real / imaginary arrays, size must be a power of two.
+// The butterflies of the larger stages run on the widest SIMD unit available.
+class FFT {
+  public:
+    typedef void (*StageFunc)(float* re, float* im, const float* wr, const float* wi, int size, int half);
+
+  public:
+    FFT(int size);
+
+    void forward(float* re, float* im) const;
+    // Unscaled, the result has to be divided by size()
+    void inverse(float* re, float* im) const;
+
+    int size() const {
+        return mSize;
+    }
+
+  public:
+    static bool isPowerOfTwo(int value) {
+        return value > 0 && (value & (value - 1)) == 0;
+    }
+
+    static int nextPowerOfTwo(int value) {
+        int result = 1;
+        while(result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+  private:
+    void transform(float* re, float* im, const std::vector<float>& twiddleIm) const;
+
+    static void stageGeneric(float* re, float* im, const float* wr, const float* wi, int size, int half);
+    static void stageSSE(float* re, float* im, const float* wr, const float* wi, int size, int half);
+    static void stageAVX2(float* re, float* im, const float* wr, const float* wi, int size, int half);
+    static void stageNEON(float* re, float* im, const float* wr, const float* wi, int size, int half);
+
+  private:
+    int mSize;
+    std::vector<int> mBitReverse;
+    std::vector<float> mTwiddleRe;
+    std::vector<float> mTwiddleIm;
+    std::vector<float> mInverseTwiddleIm;
+    StageFunc mStage;
+    int mStageMinHalf;
+};
+
+} // namespace DSP
+
+#endif // DSP_FFT_H
@@ -0,0 +1,93 @@
+#include "fftfilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace DSP {
+
+FFTFilter::FFTFilter(const std::vector<float>& taps, int fftSize)
+    : mTaps(static_cast<int>(taps.size()))
+    , mBlockSize(0)
+    , mFill(0)
+    , mFlushed(0)
+    , mFFT(fftSize > 0 ? fftSize : FFT::nextPowerOfTwo(std::max<int>(taps.size() * 8, 16))) {
+    const int size = mFFT.size();
+    mBlockSize = size - mTaps + 1;
+
+    // The inverse transform is unscaled, fold the normalization into the filter spectrum
+    mSpectrumRe.assign(size, 0.0f);
+    mSpectrumIm.assign(size, 0.0f);
+    for(int i = 0; i < mTaps; i++) {
+        mSpectrumRe[i] = taps[i] / size;
+    }
+    mFFT.forward(mSpectrumRe.data(), mSpectrumIm.data());
+
+    // The first mTaps - 1 samples of the input block are the history of the previous block
+    mInput.assign(size, 0);
+    mOutput.assign(mBlockSize, 0);
+    mWorkRe.resize(size);
+    mWorkIm.resize(size);
+}
+
+int FFTFilter::process(const complex* inSamples, complex* outSamples, int count) {
+    const int history = mTaps - 1;
+    const int processed = count;
+
+    while(count > 0) {
+        int n = std::min(count, mBlockSize - mFill);
+
+        // The input is consumed before the output is written at the same position, so in == out is fine
+        std::memcpy(&mInput[history + mFill], inSamples, n * sizeof(complex));
+        std::memcpy(outSamples, &mOutput[mFill], n * sizeof(complex));
+
+        mFill += n;
+        inSamples += n;
+        outSamples += n;
+        count -= n;
+
+        if(mFill == mBlockSize) {
+            processBlock();
+            mFill = 0;
+        }
+    }
+    return processed;
+}
+
+int FFTFilter::flush(complex* outSamples, int count) {
+    int n = std::min(count, mBlockSize - mFlushed);
+    std::fill(outSamples, outSamples + n, complex(0.0f, 0.0f));
+    mFlushed += n;
+    return process(outSamples, outSamples, n);
+}
+
+void FFTFilter::processBlock() {
+    const int size = mFFT.size();
+    const int history = mTaps - 1;
+    float* re = mWorkRe.data();
+    float* im = mWorkIm.data();
+
+    for(int i = 0; i < size; i++) {
+        re[i] = mInput[i].real();
+        im[i] = mInput[i].imag();
+    }
+
+    mFFT.forward(re, im);
+
+    const float* hr = mSpectrumRe.data();
+    const float* hi = mSpectrumIm.data();
+    for(int i = 0; i < size; i++) {
+        const float r = re[i] * hr[i] - im[i] * hi[i];
+        im[i] = re[i] * hi[i] + im[i] * hr[i];
+        re[i] = r;
+    }
+
+    mFFT.inverse(re, im);
+
+    // The first mTaps - 1 results are wrapped around by the circular convolution, the rest is valid
+    for(int i = 0; i < mBlockSize; i++) {
+        mOutput[i] = complex(re[history + i], im[history + i]);
+    }
+    std::copy(mInput.end() - history, mInput.end(), mInput.begin());
+}
+
+} // namespace DSP
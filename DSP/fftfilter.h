@@ -0,0 +1,51 @@
+#ifndef DSP_FFTFILTER_H
+#define DSP_FFTFILTER_H
+
+#include <complex>
+#include <vector>
+
+#include "fft.h"
+
+namespace DSP {
+
+// Overlap-save fast convolution, the cost per sample grows with log2 of the tap count instead of linearly.
+// The output is the same as the direct form FIR delayed by blockSize() samples, flush() returns the delayed tail at the end of the stream.
+class FFTFilter {
+  public:
+    typedef std::complex<float> complex;
+
+  public:
+    // fftSize 0 selects the smallest power of two at least eight times the tap count
+    FFTFilter(const std::vector<float>& taps, int fftSize = 0);
+
+    // In-place processing is allowed, always returns count
+    int process(const complex* inSamples, complex* outSamples, int count);
+
+    // Writes up to count of the samples still held back by the block delay, returns 0 once all blockSize() of them are out.
+    // Only for the end of the stream, the filter takes no more input afterwards.
+    int flush(complex* outSamples, int count);
+
+    int blockSize() const {
+        return mBlockSize;
+    }
+
+  private:
+    void processBlock();
+
+  private:
+    int mTaps;
+    int mBlockSize;
+    int mFill;
+    int mFlushed;
+    FFT mFFT;
+    std::vector<float> mSpectrumRe;
+    std::vector<float> mSpectrumIm;
+    std::vector<complex> mInput;
+    std::vector<complex> mOutput;
+    std::vector<float> mWorkRe;
+    std::vector<float> mWorkIm;
+};
+
+} // namespace DSP
+
+#endif // DSP_FFTFILTER_H
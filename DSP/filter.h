@@ -2,12 +2,14 @@
 #define FILTER_H
 
 #include <complex>
-#include <list>
 #include <vector>
 
+#include "firkernels.h"
+#include "stage.h"
+
 namespace DSP {
 
-class FilterBase {
+class FilterBase : public Stage<FilterBase> {
   public:
     typedef std::complex<float> complex;
 
@@ -15,39 +17,31 @@ class FilterBase {
     FilterBase(int taps);
     virtual ~FilterBase() {}
 
-    inline complex process(const complex& in) {
-        complex out = 0.0f;
-
-        mMemory.push_front(in);
-        mMemory.pop_back();
-
-        std::list<complex>::const_reverse_iterator it = mMemory.crbegin();
-
-        for(int i = mTaps - 1; i >= 0; --i, ++it) {
-            out += (*it) * mCoeffs[i];
+    inline complex processSample(const complex& in) {
+        // Every sample is stored twice, so the last mTaps samples are always contiguous in memory
+        mDelayLine[mPos] = in;
+        mDelayLine[mPos + mTaps] = in;
+        if(++mPos == mTaps) {
+            mPos = 0;
         }
-        return out;
+        return mDotProduct(&mDelayLine[mPos], mKernelTaps.data(), mTaps);
     }
 
-    inline void process(const complex* inSamples, complex* outSamples, unsigned int count) {
-        for(unsigned int i = 0; i < count; i++) {
-            *outSamples = process(*inSamples++);
-            outSamples++;
-        }
-    }
+  protected:
+    void initDelayLine();
 
   protected:
     std::vector<float> mCoeffs;
-    std::list<complex> mMemory;
+    std::vector<float> mKernelTaps;
+    std::vector<complex> mDelayLine;
     int mTaps;
+    int mPos;
+    FIR::DotProductFunc mDotProduct;
 };
 
 class RRCFilter : public FilterBase {
   public:
     RRCFilter(int taps, float beta, float symbolrate, float samplerate);
-
-  private:
-    void computeCoeffs(int taps, float beta, float Ts);
 };
 
 } // namespace DSP
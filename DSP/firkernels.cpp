@@ -0,0 +1,163 @@
+#include "firkernels.h"
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace DSP {
+namespace FIR {
+
+DotProductFunc selectDotProduct() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return dotProductAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return dotProductSSE;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return dotProductNEON;
+    }
+#endif
+
+    (void)cpu;
+    return dotProductGeneric;
+}
+
+std::complex<float> dotProductGeneric(const std::complex<float>* samples, const float* taps, int count) {
+    float re = 0.0f;
+    float im = 0.0f;
+
+    for(int i = 0; i < count; i++) {
+        re += samples[i].real() * taps[i * 2];
+        im += samples[i].imag() * taps[i * 2];
+    }
+
+    return {re, im};
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 std::complex<float> dotProductSSE(const std::complex<float>* samples, const float* taps, int count) {
+    const float* in = reinterpret_cast<const float*>(samples);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+
+    // Two complex samples per register, two accumulators to hide the add latency
+    for(; i + 4 <= count; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(in + i * 2), _mm_loadu_ps(taps + i * 2)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(in + i * 2 + 4), _mm_loadu_ps(taps + i * 2 + 4)));
+    }
+    for(; i + 2 <= count; i += 2) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(in + i * 2), _mm_loadu_ps(taps + i * 2)));
+    }
+
+    // [re0, im0, re1, im1] -> [re0 + re1, im0 + im1]
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+
+    float result[4];
+    _mm_storeu_ps(result, acc);
+
+    for(; i < count; i++) {
+        result[0] += samples[i].real() * taps[i * 2];
+        result[1] += samples[i].imag() * taps[i * 2];
+    }
+
+    return {result[0], result[1]};
+}
+
+TARGET_AVX2 std::complex<float> dotProductAVX2(const std::complex<float>* samples, const float* taps, int count) {
+    const float* in = reinterpret_cast<const float*>(samples);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+
+    // Four complex samples per register
+    for(; i + 8 <= count; i += 8) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(in + i * 2), _mm256_loadu_ps(taps + i * 2)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(in + i * 2 + 8), _mm256_loadu_ps(taps + i * 2 + 8)));
+    }
+    for(; i + 4 <= count; i += 4) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(in + i * 2), _mm256_loadu_ps(taps + i * 2)));
+    }
+
+    __m256 acc256 = _mm256_add_ps(acc0, acc1);
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc256), _mm256_extractf128_ps(acc256, 1));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+
+    float result[4];
+    _mm_storeu_ps(result, acc);
+
+    for(; i < count; i++) {
+        result[0] += samples[i].real() * taps[i * 2];
+        result[1] += samples[i].imag() * taps[i * 2];
+    }
+
+    return {result[0], result[1]};
+}
+
+#else
+
+std::complex<float> dotProductSSE(const std::complex<float>* samples, const float* taps, int count) {
+    return dotProductGeneric(samples, taps, count);
+}
+
+std::complex<float> dotProductAVX2(const std::complex<float>* samples, const float* taps, int count) {
+    return dotProductGeneric(samples, taps, count);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+std::complex<float> dotProductNEON(const std::complex<float>* samples, const float* taps, int count) {
+    const float* in = reinterpret_cast<const float*>(samples);
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(in + i * 2), vld1q_f32(taps + i * 2));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(in + i * 2 + 4), vld1q_f32(taps + i * 2 + 4));
+    }
+    for(; i + 2 <= count; i += 2) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(in + i * 2), vld1q_f32(taps + i * 2));
+    }
+
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+
+    float re = vget_lane_f32(sum, 0);
+    float im = vget_lane_f32(sum, 1);
+
+    for(; i < count; i++) {
+        re += samples[i].real() * taps[i * 2];
+        im += samples[i].imag() * taps[i * 2];
+    }
+
+    return {re, im};
+}
+
+#else
+
+std::complex<float> dotProductNEON(const std::complex<float>* samples, const float* taps, int count) {
+    return dotProductGeneric(samples, taps, count);
+}
+
+#endif
+
+} // namespace FIR
+} // namespace DSP
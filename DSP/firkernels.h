@@ -0,0 +1,23 @@
+#ifndef DSP_FIRKERNELS_H
+#define DSP_FIRKERNELS_H
+
+#include <complex>
+
+namespace DSP {
+namespace FIR {
+
+// Dot product of count complex samples with real taps, the taps are stored duplicated (t0, t0, t1, t1, ...)
+// so the interleaved I/Q floats can be multiplied lane by lane
+typedef std::complex<float> (*DotProductFunc)(const std::complex<float>* samples, const float* taps, int count);
+
+DotProductFunc selectDotProduct();
+
+std::complex<float> dotProductGeneric(const std::complex<float>* samples, const float* taps, int count);
+std::complex<float> dotProductSSE(const std::complex<float>* samples, const float* taps, int count);
+std::complex<float> dotProductAVX2(const std::complex<float>* samples, const float* taps, int count);
+std::complex<float> dotProductNEON(const std::complex<float>* samples, const float* taps, int count);
+
+} // namespace FIR
+} // namespace DSP
+
+#endif // DSP_FIRKERNELS_H
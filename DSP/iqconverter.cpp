@@ -0,0 +1,208 @@
+#include "iqconverter.h"
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace DSP {
+namespace IQ {
+
+static constexpr float cU8Offset = 127.5f;
+
+ConvertU8Func selectConvertU8() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return convertU8AVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return convertU8SSE;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return convertU8NEON;
+    }
+#endif
+
+    (void)cpu;
+    return convertU8Generic;
+}
+
+ConvertS16Func selectConvertS16() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return convertS16AVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return convertS16SSE;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return convertS16NEON;
+    }
+#endif
+
+    (void)cpu;
+    return convertS16Generic;
+}
+
+void convertU8Generic(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        out[i] = std::complex<float>(in[i * 2] - cU8Offset, in[i * 2 + 1] - cU8Offset);
+    }
+}
+
+void convertS16Generic(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        out[i] = std::complex<float>(in[i * 2], in[i * 2 + 1]);
+    }
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 void convertU8SSE(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 offset = _mm_set1_ps(cU8Offset);
+    uint32_t i = 0;
+
+    // 16 bytes are 8 complex samples, the interleaved order is kept
+    for(; i + 8 <= count; i += 8) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+        _mm_storeu_ps(o + i * 2, _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), offset));
+        _mm_storeu_ps(o + i * 2 + 4, _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), offset));
+        _mm_storeu_ps(o + i * 2 + 8, _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), offset));
+        _mm_storeu_ps(o + i * 2 + 12, _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), offset));
+    }
+
+    convertU8Generic(in + i * 2, out + i, count - i);
+}
+
+TARGET_SSE2 void convertS16SSE(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    uint32_t i = 0;
+
+    // Sign extension: the value goes to the upper half of a 32 bit lane and is shifted back arithmetically
+    for(; i + 4 <= count; i += 4) {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+
+        _mm_storeu_ps(o + i * 2, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(o + i * 2 + 4, _mm_cvtepi32_ps(hi));
+    }
+
+    convertS16Generic(in + i * 2, out + i, count - i);
+}
+
+TARGET_AVX2 void convertU8AVX2(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    const __m256 offset = _mm256_set1_ps(cU8Offset);
+    uint32_t i = 0;
+
+    for(; i + 8 <= count; i += 8) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+
+        _mm256_storeu_ps(o + i * 2, _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)), offset));
+        _mm256_storeu_ps(o + i * 2 + 8, _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), offset));
+    }
+
+    convertU8Generic(in + i * 2, out + i, count - i);
+}
+
+TARGET_AVX2 void convertS16AVX2(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    uint32_t i = 0;
+
+    for(; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2 + 8));
+
+        _mm256_storeu_ps(o + i * 2, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(lo)));
+        _mm256_storeu_ps(o + i * 2 + 8, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(hi)));
+    }
+
+    convertS16Generic(in + i * 2, out + i, count - i);
+}
+
+#else
+
+void convertU8SSE(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    convertU8Generic(in, out, count);
+}
+
+void convertS16SSE(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    convertS16Generic(in, out, count);
+}
+
+void convertU8AVX2(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    convertU8Generic(in, out, count);
+}
+
+void convertS16AVX2(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    convertS16Generic(in, out, count);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+void convertU8NEON(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    const float32x4_t offset = vdupq_n_f32(cU8Offset);
+    uint32_t i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        uint16x8_t words = vmovl_u8(vld1_u8(in + i * 2));
+
+        vst1q_f32(o + i * 2, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), offset));
+        vst1q_f32(o + i * 2 + 4, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), offset));
+    }
+
+    convertU8Generic(in + i * 2, out + i, count - i);
+}
+
+void convertS16NEON(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    float* o = reinterpret_cast<float*>(out);
+    uint32_t i = 0;
+
+    for(; i + 4 <= count; i += 4) {
+        int16x8_t words = vld1q_s16(in + i * 2);
+
+        vst1q_f32(o + i * 2, vcvtq_f32_s32(vmovl_s16(vget_low_s16(words))));
+        vst1q_f32(o + i * 2 + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(words))));
+    }
+
+    convertS16Generic(in + i * 2, out + i, count - i);
+}
+
+#else
+
+void convertU8NEON(const uint8_t* in, std::complex<float>* out, uint32_t count) {
+    convertU8Generic(in, out, count);
+}
+
+void convertS16NEON(const int16_t* in, std::complex<float>* out, uint32_t count) {
+    convertS16Generic(in, out, count);
+}
+
+#endif
+
+} // namespace IQ
+} // namespace DSP
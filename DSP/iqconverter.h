@@ -0,0 +1,31 @@
+#ifndef DSP_IQCONVERTER_H
+#define DSP_IQCONVERTER_H
+
+#include <complex>
+#include <stdint.h>
+
+namespace DSP {
+namespace IQ {
+
+// Converters from interleaved I/Q integer samples to complex float, count is the number of complex samples.
+// Unsigned 8 bit samples are centered by subtracting 127.5, 16 bit samples keep their integer scale.
+typedef void (*ConvertU8Func)(const uint8_t* in, std::complex<float>* out, uint32_t count);
+typedef void (*ConvertS16Func)(const int16_t* in, std::complex<float>* out, uint32_t count);
+
+ConvertU8Func selectConvertU8();
+ConvertS16Func selectConvertS16();
+
+void convertU8Generic(const uint8_t* in, std::complex<float>* out, uint32_t count);
+void convertU8SSE(const uint8_t* in, std::complex<float>* out, uint32_t count);
+void convertU8AVX2(const uint8_t* in, std::complex<float>* out, uint32_t count);
+void convertU8NEON(const uint8_t* in, std::complex<float>* out, uint32_t count);
+
+void convertS16Generic(const int16_t* in, std::complex<float>* out, uint32_t count);
+void convertS16SSE(const int16_t* in, std::complex<float>* out, uint32_t count);
+void convertS16AVX2(const int16_t* in, std::complex<float>* out, uint32_t count);
+void convertS16NEON(const int16_t* in, std::complex<float>* out, uint32_t count);
+
+} // namespace IQ
+} // namespace DSP
+
+#endif // DSP_IQCONVERTER_H
@@ -25,19 +25,24 @@ class IQSoruce {
         return mBitsPerSample;
     }
 
-    uint32_t getTotalSamples() const {
+    uint64_t getTotalSamples() const {
         return mTotalSamples;
     }
 
-    uint32_t getReadedSamples() const {
+    uint64_t getReadedSamples() const {
         return mReadedSamples;
     }
 
+    // Percentage of the input processed, 0 for streams of unknown length
+    float getProgress() const {
+        return mTotalSamples > 0 ? (mReadedSamples / static_cast<float>(mTotalSamples)) * 100 : 0.0f;
+    }
+
   protected:
     uint16_t mBitsPerSample;
     uint32_t mSampleRate;
-    uint32_t mTotalSamples;
-    uint32_t mReadedSamples;
+    uint64_t mTotalSamples;
+    uint64_t mReadedSamples;
 };
 
 } // namespace DSP
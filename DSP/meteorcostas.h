@@ -7,7 +7,7 @@
 
 namespace DSP {
 
-class MeteorCostas : public PLL {
+class MeteorCostas : public PLL, public Stage<MeteorCostas> {
   private:
     static constexpr float cLockDetectionTreshold = 0.18;
     static constexpr float cUnLockDetectionTreshold = 0.22;
@@ -19,9 +19,15 @@ class MeteorCostas : public PLL {
   public:
     MeteorCostas(Mode mode, float bandWidth, float initPhase = 0.0f, float initFreq = 0.0f, float minFreq = -M_PI, float maxFreq = M_PI, bool brokenModulation = false);
 
-    inline virtual complex process(const complex& sample) override {
-        complex retval;
-        retval = sample * complex(cosf(-mPhase), sinf(-mPhase));
+    // Hides the block loop of PLL, so the loop calls the Costas per sample function
+    using Stage<MeteorCostas>::process;
+
+    inline complex processSample(const complex& sample) {
+        // Mixing written out, std::complex multiplication adds a NaN recovery branch per sample
+        float sinValue;
+        float cosValue;
+        NCO::sinCos(-mPhase, sinValue, cosValue);
+        complex retval(sample.real() * cosValue - sample.imag() * sinValue, sample.real() * sinValue + sample.imag() * cosValue);
         mError = errorFunction(retval);
         advance(mError);
 
@@ -33,12 +39,6 @@ class MeteorCostas : public PLL {
         return retval;
     }
 
-    inline virtual void process(const complex* insamples, complex* outsampes, unsigned int count) {
-        for(unsigned int i = 0; i < count; i++) {
-            *outsampes++ = process(*insamples++);
-        }
-    }
-
   protected:
     float errorFunction(complex value) {
         float error;
@@ -48,7 +48,7 @@ class MeteorCostas : public PLL {
             const float PHASE3 = 3.8682349942715186;
             const float PHASE4 = -0.29067248091319986;
 
-            float phase = atan2f(value.imag(), value.real());
+            float phase = NCO::atan2(value.imag(), value.real());
             float dp1 = normalizePhase(phase - PHASE1);
             float dp2 = normalizePhase(phase - PHASE2);
             float dp3 = normalizePhase(phase - PHASE3);
@@ -89,8 +89,9 @@ class MeteorCostas : public PLL {
         return std::clamp(error, -1.0f, 1.0f);
     }
 
+    // Branchless sign, random symbols would mispredict a compare on every sample. Only differs at +0, where the error is 0 anyway
     inline float step(float val) {
-        return val > 0 ? 1.0f : -1.0f;
+        return std::copysign(1.0f, val);
     }
 
   public:
@@ -1,21 +1,121 @@
 #include "meteordemodulator.h"
 
+#include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <thread>
 
 #include "global.h"
+#include "rootraisedcosine.h"
+#include "spscqueue.h"
+#include "stage.h"
 
 namespace DSP {
 
-MeteorDemodulator::MeteorDemodulator(MeteorCostas::Mode mode, float symbolRate, float costasBw, uint16_t rrcFilterOrder, bool waitForLock, bool brokenM2Modulation)
+// Filters and loops of one process() call, shared by the serial and the pipelined path
+struct MeteorDemodulator::Chain {
+    Chain(const MeteorDemodulator& demodulator, float sourceSampleRate)
+        : sampleRate(sourceSampleRate) {
+        // Decimate wideband recordings, so everything after the AGC runs at a low oversampling ratio
+        if(demodulator.mSamplesPerSymbol > 0.0f) {
+            int interpolation;
+            int decimation;
+            Resampler::rationalRatio(sampleRate, demodulator.mSymbolRate * demodulator.mSamplesPerSymbol, cMaxResamplerInterpolation, interpolation, decimation);
+            if(interpolation < decimation) {
+                resampler = std::make_unique<DSP::Resampler>(interpolation, decimation);
+                sampleRate = sampleRate * interpolation / decimation;
+                std::cout << "Resampling " << sourceSampleRate << "Hz by " << interpolation << "/" << decimation << " to " << sampleRate << "Hz" << std::endl;
+            }
+        }
+
+        // The loop bandwidth is given per sample, keep it the same in Hz as without resampling
+        float pllBandwidth = 2 * M_PI * demodulator.mCostasBw / demodulator.mSymbolRate * (sourceSampleRate / sampleRate);
+        float maxFreqDeviation = 10000.0f * (2.0f * M_PI) / sampleRate; //+-10kHz
+        costas = std::make_unique<DSP::MeteorCostas>(demodulator.mMode, pllBandwidth, 0, 0, -maxFreqDeviation, maxFreqDeviation, demodulator.mBorkenM2Modulation);
+
+        if(demodulator.mRrcFilterOrder > cFFTFilterCrossover) {
+            rrcFFTFilter = std::make_unique<DSP::FFTFilter>(TAPS::rootRaisedCosine(demodulator.mRrcFilterOrder, 0.6f, sampleRate / demodulator.mSymbolRate));
+        } else {
+            rrcFilter = std::make_unique<DSP::RRCFilter>(demodulator.mRrcFilterOrder, 0.6f, demodulator.mSymbolRate, sampleRate);
+        }
+
+        mm = std::make_unique<MM>(sampleRate / demodulator.mSymbolRate, 1e-6, 0.01f, 0.01f);
+    }
+
+    // AGC, resampling and matched filtering, returns the number of samples left in out
+    int filter(Agc& agc, const PLL::complex* in, PLL::complex* out, int count) {
+        count = agc.process(in, out, count);
+        if(resampler) {
+            count = resampler->process(out, out, count);
+        }
+        if(rrcFFTFilter) {
+            return rrcFFTFilter->process(out, out, count);
+        }
+        return rrcFilter->process(out, out, count);
+    }
+
+    // Samples the filters still hold back at the end of the stream, called until it returns 0
+    int flush(PLL::complex* out, int count) {
+        return rrcFFTFilter ? rrcFFTFilter->flush(out, count) : 0;
+    }
+
+    // Carrier and clock recovery, out must hold count samples and receives the symbols
+    int recover(const PLL::complex* in, PLL::complex* out, int count) {
+        return processStages(in, out, count, *costas, *mm);
+    }
+
+    float getCarrierFrequency() const {
+        return costas->getFrequency() / (2 * M_PI) * sampleRate;
+    }
+
+    float sampleRate;
+    std::unique_ptr<DSP::Resampler> resampler;
+    std::unique_ptr<DSP::RRCFilter> rrcFilter;
+    std::unique_ptr<DSP::FFTFilter> rrcFFTFilter;
+    std::unique_ptr<DSP::MeteorCostas> costas;
+    std::unique_ptr<MM> mm;
+};
+
+struct MeteorDemodulator::SampleBlock {
+    std::unique_ptr<PLL::complex[]> samples;
+    uint32_t count;
+    float progress;
+    bool discard;
+    bool last;
+};
+
+struct MeteorDemodulator::SymbolBlock {
+    std::unique_ptr<PLL::complex[]> symbols;
+    int count;
+    int recoveredSymbols;
+    float progress;
+    float carrierFrequency;
+    float lockError;
+    bool locked;
+    bool last;
+};
+
+struct MeteorDemodulator::StageCounter : PassStatistics::Stage {
+    explicit StageCounter(const char* name_)
+        : name(name_) {}
+
+    const char* name;
+};
+
+MeteorDemodulator::MeteorDemodulator(MeteorCostas::Mode mode, float symbolRate, float costasBw, uint16_t rrcFilterOrder, bool waitForLock, bool brokenM2Modulation, float samplesPerSymbol, bool pipelined, Agc::Mode agcMode)
     : mMode(mode)
     , mBorkenM2Modulation(brokenM2Modulation)
     , mWaitForLock(waitForLock)
+    , mPipelined(pipelined)
     , mSymbolRate(symbolRate)
     , mCostasBw(costasBw)
     , mRrcFilterOrder(rrcFilterOrder)
-    , mAgc(0.5f, 100)
+    , mSamplesPerSymbol(samplesPerSymbol)
+    , mAgc(0.5f, 100, 1024 * 64, 256 * 1024, agcMode)
     , mPrevI(0.0f)
+    , mVerbose(true)
+    , mStatistics(nullptr)
+    , mNextTraceTime(0.0)
     , mSamples(nullptr)
     , mProcessedSamples(nullptr) {
     mSamples = std::make_unique<PLL::complex[]>(STREAM_CHUNK_SIZE);
@@ -25,11 +125,16 @@ MeteorDemodulator::MeteorDemodulator(MeteorCostas::Mode mode, float symbolRate,
 MeteorDemodulator::~MeteorDemodulator() {}
 
 void MeteorDemodulator::process(IQSoruce& source, MeteorDecoderCallback_t callback) {
-    float pllBandwidth = 2 * M_PI * mCostasBw / mSymbolRate;
-    float maxFreqDeviation = 10000.0f * (2.0f * M_PI) / source.getSampleRate(); //+-10kHz
-    DSP::MeteorCostas costas(mMode, pllBandwidth, 0, 0, -maxFreqDeviation, maxFreqDeviation, mBorkenM2Modulation);
-    DSP::RRCFilter rrcFilter(mRrcFilterOrder, 0.6f, mSymbolRate, source.getSampleRate());
-    MM mm(source.getSampleRate() / mSymbolRate, 1e-6, 0.01f, 0.01f);
+    Chain chain(*this, source.getSampleRate());
+
+    if(mPipelined) {
+        processPipelined(source, chain, callback);
+    } else {
+        processSerial(source, chain, callback);
+    }
+}
+
+void MeteorDemodulator::processSerial(IQSoruce& source, Chain& chain, MeteorDecoderCallback_t callback) {
     uint32_t readedSamples;
 
     uint64_t bytesWrited = 0;
@@ -42,30 +147,229 @@ void MeteorDemodulator::process(IQSoruce& source, MeteorDecoderCallback_t callba
 
     // Discard the first null samples
     readedSamples = source.read(mSamples.get(), mRrcFilterOrder);
-    mAgc.process(mSamples.get(), mProcessedSamples.get(), readedSamples);
-    rrcFilter.process(mProcessedSamples.get(), mProcessedSamples.get(), readedSamples);
+    chain.filter(mAgc, mSamples.get(), mProcessedSamples.get(), readedSamples);
+
+    StageCounter readCounter("Read");
+    StageCounter filterCounter("AGC+RRC");
+    StageCounter recoveryCounter("Costas+MM");
 
+    MeteorCostas& costas = *chain.costas;
+    auto start = std::chrono::steady_clock::now();
     while((readedSamples = source.read(mSamples.get(), STREAM_CHUNK_SIZE)) > 0) {
-        mAgc.process(mSamples.get(), mProcessedSamples.get(), readedSamples);
-        rrcFilter.process(mProcessedSamples.get(), mProcessedSamples.get(), readedSamples);
-        costas.process(mProcessedSamples.get(), mProcessedSamples.get(), readedSamples);
-
-        mm.process(readedSamples, mProcessedSamples.get(), [progress, &bytesWrited, callback, &costas, this](MM::complex value) mutable {
-            // Append the new samples to the output file
-            if(callback != nullptr && (!mWaitForLock || costas.isLockedOnce())) {
-                callback(value, progress);
+        readCounter.add(readedSamples, start);
+
+        start = std::chrono::steady_clock::now();
+        int processedSamples = chain.filter(mAgc, mSamples.get(), mProcessedSamples.get(), readedSamples);
+        filterCounter.add(readedSamples, start);
+
+        start = std::chrono::steady_clock::now();
+        int symbols = chain.recover(mProcessedSamples.get(), mProcessedSamples.get(), processedSamples);
+        recoveryCounter.add(processedSamples, start);
+
+        // Append the new symbols to the output file
+        if(callback != nullptr && (!mWaitForLock || costas.isLockedOnce())) {
+            callback(mProcessedSamples.get(), symbols, progress);
+        }
+        bytesWrited += symbols * 2;
+        progress = source.getProgress();
+
+        traceCarrier(bytesWrited / 2, chain.getCarrierFrequency(), costas.getError(), costas.isLocked());
+        printStatus(chain.getCarrierFrequency(), costas.getError(), costas.isLocked(), bytesWrited, progress);
+        start = std::chrono::steady_clock::now();
+    }
+
+    int flushedSamples;
+    while((flushedSamples = chain.flush(mProcessedSamples.get(), STREAM_CHUNK_SIZE)) > 0) {
+        int symbols = chain.recover(mProcessedSamples.get(), mProcessedSamples.get(), flushedSamples);
+        if(callback != nullptr && (!mWaitForLock || costas.isLockedOnce())) {
+            callback(mProcessedSamples.get(), symbols, progress);
+        }
+    }
+
+    if(mStatistics) {
+        mStatistics->read = readCounter;
+        mStatistics->filter = filterCounter;
+        mStatistics->recovery = recoveryCounter;
+    }
+
+    if(mVerbose) {
+        std::cout << std::endl;
+    }
+}
+
+void MeteorDemodulator::processPipelined(IQSoruce& source, Chain& chain, MeteorDecoderCallback_t callback) {
+    // Every queue pair forms a loop, the consumer of the last stage hands the blocks back to the first one
+    std::vector<SampleBlock> sampleBlocks(cPipelineDepth);
+    std::vector<SymbolBlock> symbolBlocks(cPipelineDepth);
+    SpscQueue<SampleBlock*> freeSampleBlocks(cPipelineDepth);
+    SpscQueue<SampleBlock*> readedBlocks(cPipelineDepth);
+    SpscQueue<SampleBlock*> filteredBlocks(cPipelineDepth);
+    SpscQueue<SymbolBlock*> freeSymbolBlocks(cPipelineDepth);
+    SpscQueue<SymbolBlock*> symbolQueue(cPipelineDepth);
+
+    for(auto& block : sampleBlocks) {
+        block.samples = std::make_unique<PLL::complex[]>(STREAM_CHUNK_SIZE);
+        freeSampleBlocks.push(&block);
+    }
+    for(auto& block : symbolBlocks) {
+        block.symbols = std::make_unique<PLL::complex[]>(STREAM_CHUNK_SIZE);
+        freeSymbolBlocks.push(&block);
+    }
+
+    StageCounter readCounter("Read");
+    StageCounter filterCounter("AGC+RRC");
+    StageCounter recoveryCounter("Costas+MM");
+    StageCounter writeCounter("Write");
+
+    std::thread reader([&]() {
+        bool first = true;
+        while(true) {
+            SampleBlock* block = freeSampleBlocks.pop();
+            auto start = std::chrono::steady_clock::now();
+
+            // The first null samples only prime the filters
+            block->discard = first;
+            block->count = source.read(block->samples.get(), first ? mRrcFilterOrder : STREAM_CHUNK_SIZE);
+            block->progress = source.getProgress();
+            block->last = block->count == 0 && !first;
+            readCounter.add(block->count, start);
+
+            bool last = block->last;
+            readedBlocks.push(block);
+            if(last) {
+                break;
+            }
+            first = false;
+        }
+    });
+
+    std::thread filter([&]() {
+        while(true) {
+            SampleBlock* block = readedBlocks.pop();
+            auto start = std::chrono::steady_clock::now();
+            uint32_t readed = block->count;
+
+            block->count = chain.filter(mAgc, block->samples.get(), block->samples.get(), block->count);
+            filterCounter.add(readed, start);
+
+            if(!block->last) {
+                filteredBlocks.push(block);
+                continue;
             }
-            bytesWrited += 2;
-        });
-        progress = (source.getReadedSamples() / static_cast<float>(source.getTotalSamples())) * 100;
 
-        float carierFreq = costas.getFrequency() / (2 * M_PI) * source.getSampleRate();
+            // The reader is done, this thread is the only one taking free blocks while the filter tail is flushed
+            float progress = block->progress;
+            while((block->count = chain.flush(block->samples.get(), STREAM_CHUNK_SIZE)) > 0) {
+                block->last = false;
+                filteredBlocks.push(block);
+                block = freeSampleBlocks.pop();
+                block->discard = false;
+                block->progress = progress;
+            }
+            block->last = true;
+            filteredBlocks.push(block);
+            break;
+        }
+    });
+
+    std::thread recovery([&]() {
+        MeteorCostas& costas = *chain.costas;
+        while(true) {
+            SampleBlock* block = filteredBlocks.pop();
+            if(block->discard) {
+                freeSampleBlocks.push(block);
+                continue;
+            }
+
+            SymbolBlock* symbols = freeSymbolBlocks.pop();
+            auto start = std::chrono::steady_clock::now();
+            bool last = block->last;
+
+            symbols->recoveredSymbols = chain.recover(block->samples.get(), symbols->symbols.get(), block->count);
+            symbols->count = (!mWaitForLock || costas.isLockedOnce()) ? symbols->recoveredSymbols : 0;
+            symbols->progress = block->progress;
+            symbols->carrierFrequency = chain.getCarrierFrequency();
+            symbols->lockError = costas.getError();
+            symbols->locked = costas.isLocked();
+            symbols->last = last;
+            recoveryCounter.add(block->count, start);
+
+            freeSampleBlocks.push(block);
+            symbolQueue.push(symbols);
+            if(last) {
+                break;
+            }
+        }
+    });
+
+    uint64_t bytesWrited = 0;
+    while(true) {
+        SymbolBlock* symbols = symbolQueue.pop();
+        auto start = std::chrono::steady_clock::now();
+        bool last = symbols->last;
+
+        if(callback != nullptr && symbols->count > 0) {
+            callback(symbols->symbols.get(), symbols->count, symbols->progress);
+        }
+        bytesWrited += symbols->recoveredSymbols * 2;
+        writeCounter.add(symbols->count, start);
+
+        if(!last) {
+            traceCarrier(bytesWrited / 2, symbols->carrierFrequency, symbols->lockError, symbols->locked);
+            printStatus(symbols->carrierFrequency, symbols->lockError, symbols->locked, bytesWrited, symbols->progress);
+        }
+        freeSymbolBlocks.push(symbols);
+
+        if(last) {
+            break;
+        }
+    }
+
+    reader.join();
+    filter.join();
+    recovery.join();
 
-        std::cout << std::fixed << std::setprecision(2) << " Carrier: " << carierFreq << "Hz\t Lock detector: " << costas.getError() << "\t isLocked: " << costas.isLocked() << "\t OutputSize: " << bytesWrited / 1024.0f / 1024.0f
-                  << "Mb Progress: " << progress << "% \t\t\r" << std::flush;
+    if(mStatistics) {
+        mStatistics->read = readCounter;
+        mStatistics->filter = filterCounter;
+        mStatistics->recovery = recoveryCounter;
     }
 
-    std::cout << std::endl;
+    if(mVerbose) {
+        std::cout << std::endl;
+
+        // Throughput of a stage while it was busy, the stage with the lowest number limits the pipeline
+        for(const StageCounter* counter : {&readCounter, &filterCounter, &recoveryCounter, &writeCounter}) {
+            double rate = counter->busySeconds > 0.0 ? counter->items / counter->busySeconds / 1e6 : 0.0;
+            std::cout << std::fixed << std::setprecision(2) << " " << counter->name << ": " << rate << (counter == &writeCounter ? " Msym/s" : " Msps") << " busy " << counter->busySeconds << "s" << std::endl;
+        }
+    }
+}
+
+void MeteorDemodulator::printStatus(float carrierFrequency, float lockError, bool locked, uint64_t bytesWrited, float progress) const {
+    if(!mVerbose) {
+        return;
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << " Carrier: " << carrierFrequency << "Hz\t Lock detector: " << lockError << "\t isLocked: " << locked << "\t OutputSize: " << bytesWrited / 1024.0f / 1024.0f
+              << "Mb Progress: " << progress << "% \t\t\r" << std::flush;
+}
+
+// Called once per block with the number of symbols recovered so far, the trace gets a point every cTraceInterval seconds of signal
+void MeteorDemodulator::traceCarrier(uint64_t symbols, float carrierFrequency, float lockError, bool locked) {
+    if(!mStatistics) {
+        return;
+    }
+
+    double time = symbols / mSymbolRate;
+    mStatistics->symbols = symbols;
+    if(locked && mStatistics->lockTime < 0.0) {
+        mStatistics->lockTime = time;
+    }
+    if(time >= mNextTraceTime) {
+        mStatistics->carrierTrace.push_back({time, carrierFrequency, lockError, locked});
+        mNextTraceTime = time + cTraceInterval;
+    }
 }
 
 } // namespace DSP
@@ -4,19 +4,23 @@
 #include <functional>
 
 #include "agc.h"
+#include "fftfilter.h"
 #include "filter.h"
 #include "iqsource.h"
 #include "meteorcostas.h"
 #include "mm.h"
+#include "passstatistics.h"
+#include "resampler.h"
 
 namespace DSP {
 
 class MeteorDemodulator {
   public:
-    typedef std::function<void(const PLL::complex&, float progress)> MeteorDecoderCallback_t;
+    // Called once per processed block with the recovered symbols
+    typedef std::function<void(const PLL::complex* symbols, int count, float progress)> MeteorDecoderCallback_t;
 
   public:
-    MeteorDemodulator(MeteorCostas::Mode mode, float symbolRate, float costasBw = 100.0f, uint16_t rrcFilterOrder = 64, bool waitForLock = true, bool brokenM2Modulation = false);
+    MeteorDemodulator(MeteorCostas::Mode mode, float symbolRate, float costasBw = 100.0f, uint16_t rrcFilterOrder = 64, bool waitForLock = true, bool brokenM2Modulation = false, float samplesPerSymbol = 0.0f, bool pipelined = false, Agc::Mode agcMode = Agc::Mode::Sample);
     ~MeteorDemodulator();
 
     MeteorDemodulator& operator=(const MeteorDemodulator&) = delete;
@@ -26,15 +30,53 @@ class MeteorDemodulator {
 
     void process(IQSoruce& source, MeteorDecoderCallback_t callback);
 
+    // The carrier status line on the console, on by default
+    void setVerbose(bool verbose) {
+        mVerbose = verbose;
+    }
+
+    // Stage timers, lock time and carrier trace are added to statistics, nullptr turns it off
+    void setStatistics(PassStatistics* statistics) {
+        mStatistics = statistics;
+    }
+
+  private:
+    struct Chain;
+    struct SampleBlock;
+    struct SymbolBlock;
+    struct StageCounter;
+
+    void processSerial(IQSoruce& source, Chain& chain, MeteorDecoderCallback_t callback);
+    // Reading, filtering, carrier/clock recovery and the callback run on separate threads
+    void processPipelined(IQSoruce& source, Chain& chain, MeteorDecoderCallback_t callback);
+
+    void printStatus(float carrierFrequency, float lockError, bool locked, uint64_t bytesWrited, float progress) const;
+    void traceCarrier(uint64_t symbols, float carrierFrequency, float lockError, bool locked);
+
+  private:
+    // Above this order the RRC filter runs as FFT fast convolution
+    static constexpr uint16_t cFFTFilterCrossover = 64;
+    // Upper limit of the resampler interpolation, keeps the polyphase bank small
+    static constexpr int cMaxResamplerInterpolation = 32;
+    // Number of STREAM_CHUNK_SIZE blocks in flight between two pipeline stages
+    static constexpr int cPipelineDepth = 8;
+    // Seconds of signal between the points of the carrier trace
+    static constexpr double cTraceInterval = 1.0;
+
   private:
     MeteorCostas::Mode mMode;
     bool mBorkenM2Modulation;
     bool mWaitForLock;
+    bool mPipelined;
     float mSymbolRate;
     float mCostasBw;
     uint16_t mRrcFilterOrder;
+    float mSamplesPerSymbol;
     Agc mAgc;
     float mPrevI;
+    bool mVerbose;
+    PassStatistics* mStatistics;
+    double mNextTraceTime;
     std::unique_ptr<PLL::complex[]> mSamples;
     std::unique_ptr<PLL::complex[]> mProcessedSamples;
 };
@@ -27,9 +27,9 @@ MM::MM(float omega, float omegaGain, float muGain, float omegaRelLimit, int inte
     generateInterpTaps();
 }
 
-int MM::process(int count, const complex* in, std::function<void(complex)> callback) {
+int MM::process(const complex* inSamples, complex* outSamples, int count) {
     // Copy data to work buffer
-    std::copy(in, in + count, mpBufStart);
+    std::copy(inSamples, inSamples + count, mpBufStart);
 
     // Process all samples
     int outCount = 0;
@@ -38,9 +38,9 @@ int MM::process(int count, const complex* in, std::function<void(complex)> callb
         complex outVal;
 
         // Calculate new output value
-        int phase = std::clamp<int>(floorf(mPcl.getPhase() * (float)mInterpPhaseCount), 0, mInterpPhaseCount - 1);
+        int phase = std::clamp<int>(floorToInt(mPcl.getPhase() * (float)mInterpPhaseCount), 0, mInterpPhaseCount - 1);
         outVal = mInterpBank.process(&mBuffer[mOffset], phase);
-        callback(outVal);
+        outSamples[outCount++] = outVal;
 
         // Calculate symbol phase error
         // Propagate delay
@@ -53,15 +53,15 @@ int MM::process(int count, const complex* in, std::function<void(complex)> callb
         mp0T = outVal;
         mc0T = step(outVal);
 
-        // Error
-        error = (((mp0T - mp2T) * std::conj(mc1T)) - ((mc0T - mc2T) * std::conj(mp1T))).real();
+        // Error, only the real part of ((p0 - p2) * conj(c1)) - ((c0 - c2) * conj(p1)) is needed
+        error = realOfConjProduct(mp0T - mp2T, mc1T) - realOfConjProduct(mc0T - mc2T, mp1T);
 
         // Clamp symbol phase error
         error = std::clamp(error, -1.0f, 1.0f);
 
         // Advance symbol mOffset and phase
         mPcl.advance(error);
-        float delta = floorf(mPcl.mPhase);
+        float delta = static_cast<float>(floorToInt(mPcl.mPhase));
         mOffset += delta;
 
         mPcl.mPhase -= delta;
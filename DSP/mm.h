@@ -1,8 +1,6 @@
 #ifndef DSP_MM_H
 #define DSP_MM_H
 
-#include <functional>
-
 #include "phasecontrolloop.h"
 #include "polyphasebank.h"
 
@@ -16,7 +14,13 @@ class MM {
     MM(float omega, float omegaGain, float muGain, float omegaRelLimit, int interpPhaseCount = 128, int interpTapCount = 8);
     ~MM() = default;
 
-    int process(int count, const complex* in, std::function<void(complex)> callback);
+    // Writes the recovered symbols to outSamples and returns their number. The output buffer must hold
+    // outputSize(count) symbols, with more than one sample per symbol in-place processing is allowed.
+    int process(const complex* inSamples, complex* outSamples, int count);
+
+    int outputSize(int count) const {
+        return static_cast<int>(count / mPcl.mMinFreq) + 2;
+    }
 
   protected:
     void generateInterpTaps();
@@ -39,6 +43,16 @@ class MM {
     PolyphaseBank<float> mInterpBank;
 
   private:
+    // floorf without the library call, the symbol phase is always far inside the int range
+    static inline int floorToInt(float value) {
+        int result = static_cast<int>(value);
+        return (static_cast<float>(result) > value) ? result - 1 : result;
+    }
+
+    static inline float realOfConjProduct(const complex& a, const complex& b) {
+        return a.real() * b.real() + a.imag() * b.imag();
+    }
+
     static inline complex step(const complex& value) {
         return {(value.real() > 0.0f) ? 1.0f : -1.0f, (value.imag() > 0.0f) ? 1.0f : -1.0f};
     }
@@ -0,0 +1,67 @@
+#ifndef DSP_NCO_H
+#define DSP_NCO_H
+
+#include <cmath>
+#include <algorithm>
+#include <complex>
+
+namespace DSP {
+namespace NCO {
+
+// Polynomial replacements of sinf/cosf/atan2f for the carrier loops.
+// sinCos is accurate to about 3e-7 for |phase| <= 2*pi, atan2 to about 1e-5 rad.
+
+inline void sinCos(float phase, float& sinValue, float& cosValue) {
+    // Reduce to [-pi/4, pi/4] around the nearest multiple of pi/2, truncating conversion avoids a libm rounding call
+    const float scaled = phase * static_cast<float>(2.0 / M_PI);
+    const int q = static_cast<int>(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+    const float quadrant = static_cast<float>(q);
+    // pi/2 split into a float and a correction part, keeps the reduction exact enough for the loop phase range
+    const float r = (phase - quadrant * 1.5707963705062866f) + quadrant * 4.3711388286737929e-08f;
+    const float r2 = r * r;
+
+    const float s = r + r * r2 * (-1.6666667163e-01f + r2 * (8.3333337680e-03f + r2 * (-1.9841270114e-04f + r2 * 2.7557314297e-06f)));
+    const float c = 1.0f + r2 * (-0.5f + r2 * (4.1666667908e-02f + r2 * (-1.3888889225e-03f + r2 * 2.4801587642e-05f)));
+
+    // Odd quadrants swap sin and cos, the sign follows the quadrant, written as selects so it compiles without branches
+    const bool swap = (q & 1) != 0;
+    const float sinAbs = swap ? c : s;
+    const float cosAbs = swap ? s : c;
+    sinValue = (q & 2) ? -sinAbs : sinAbs;
+    cosValue = ((q + 1) & 2) ? -cosAbs : cosAbs;
+}
+
+// Unit phasor, same as std::polar(1.0f, phase)
+inline std::complex<float> polar(float phase) {
+    float sinValue;
+    float cosValue;
+    sinCos(phase, sinValue, cosValue);
+    return {cosValue, sinValue};
+}
+
+inline float atan2(float y, float x) {
+    const float ax = std::fabs(x);
+    const float ay = std::fabs(y);
+    const float maxValue = std::max(ax, ay);
+    if(maxValue == 0.0f) {
+        return 0.0f;
+    }
+
+    // Minimax polynomial of atan on [0, 1], the other octants are mirrored
+    const float z = std::min(ax, ay) / maxValue;
+    const float z2 = z * z;
+    float angle = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+
+    if(ay > ax) {
+        angle = static_cast<float>(M_PI / 2.0) - angle;
+    }
+    if(x < 0.0f) {
+        angle = static_cast<float>(M_PI) - angle;
+    }
+    return y < 0.0f ? -angle : angle;
+}
+
+} // namespace NCO
+} // namespace DSP
+
+#endif // DSP_NCO_H
@@ -0,0 +1,140 @@
+#include "rawiqreader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(_MSC_VER)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+// Pipes deliver small pieces, a large stdio buffer turns them into few big reads
+constexpr size_t cStreamBufferSize = 4 * 1024 * 1024;
+
+constexpr uint32_t cReadBlockSamples = 64 * 1024;
+
+} // namespace
+
+RawIQReader::RawIQReader()
+    : mFile(nullptr)
+    , mIsStdin(false)
+    , mFormat(Format::CS16)
+    , mFrameSize(0)
+    , mConvertU8(DSP::IQ::selectConvertU8())
+    , mConvertS16(DSP::IQ::selectConvertS16()) {}
+
+RawIQReader::~RawIQReader() {
+    if(mFile != nullptr && !mIsStdin) {
+        fclose(mFile);
+    }
+}
+
+bool RawIQReader::parseFormat(const std::string& name, Format& format) {
+    if(name == "cu8") {
+        format = Format::CU8;
+    } else if(name == "cs16") {
+        format = Format::CS16;
+    } else if(name == "cf32") {
+        format = Format::CF32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool RawIQReader::openFile(const std::string& file, Format format, uint32_t sampleRate) {
+    if(sampleRate == 0) {
+        std::cout << "Sample rate is required for raw I/Q input" << std::endl;
+        return false;
+    }
+
+    if(file == "-") {
+#if defined(_MSC_VER)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        mFile = stdin;
+        mIsStdin = true;
+    } else {
+        mFile = fopen(file.c_str(), "rb");
+    }
+
+    if(mFile == nullptr) {
+        return false;
+    }
+
+    mStreamBuffer = std::make_unique<char[]>(cStreamBufferSize);
+    setvbuf(mFile, mStreamBuffer.get(), _IOFBF, cStreamBufferSize);
+
+    mFormat = format;
+    mSampleRate = sampleRate;
+    switch(mFormat) {
+        case Format::CU8:
+            mBitsPerSample = 8;
+            break;
+        case Format::CS16:
+            mBitsPerSample = 16;
+            break;
+        case Format::CF32:
+            mBitsPerSample = 32;
+            break;
+    }
+    mFrameSize = 2 * mBitsPerSample / 8;
+
+    // Regular files have a known length, pipes and FIFOs fail to seek
+    mTotalSamples = 0;
+    if(!mIsStdin) {
+#if defined(_MSC_VER)
+        bool seekable = _fseeki64(mFile, 0, SEEK_END) == 0;
+        int64_t size = seekable ? _ftelli64(mFile) : 0;
+        _fseeki64(mFile, 0, SEEK_SET);
+#else
+        bool seekable = fseeko(mFile, 0, SEEK_END) == 0;
+        int64_t size = seekable ? ftello(mFile) : 0;
+        fseeko(mFile, 0, SEEK_SET);
+#endif
+        if(seekable && size > 0) {
+            mTotalSamples = static_cast<uint64_t>(size) / mFrameSize;
+        }
+        clearerr(mFile);
+    }
+
+    return true;
+}
+
+uint32_t RawIQReader::read(complex* data, uint32_t len) {
+    uint32_t samplesCount = 0;
+
+    if(mFile == nullptr) {
+        return 0;
+    }
+
+    while(samplesCount < len) {
+        uint32_t count = std::min(len - samplesCount, cReadBlockSamples);
+
+        // Float samples are read straight into the output
+        void* destination = data + samplesCount;
+        if(mFormat != Format::CF32) {
+            mBuffer.resize(static_cast<size_t>(cReadBlockSamples) * mFrameSize);
+            destination = mBuffer.data();
+        }
+
+        // fread blocks until the whole block arrived, only the end of the stream gives less
+        count = static_cast<uint32_t>(fread(destination, mFrameSize, count, mFile));
+        if(count == 0) {
+            break;
+        }
+
+        if(mFormat == Format::CU8) {
+            mConvertU8(mBuffer.data(), data + samplesCount, count);
+        } else if(mFormat == Format::CS16) {
+            mConvertS16(reinterpret_cast<const int16_t*>(mBuffer.data()), data + samplesCount, count);
+        }
+
+        samplesCount += count;
+        mReadedSamples += count;
+    }
+
+    return samplesCount;
+}
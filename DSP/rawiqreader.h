@@ -0,0 +1,46 @@
+#ifndef RAWIQREADER_H
+#define RAWIQREADER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "iqconverter.h"
+#include "iqsource.h"
+
+// Headerless interleaved I/Q samples from a file, a named pipe or stdin ("-").
+// Streams have no known length, getTotalSamples() is 0 for them.
+class RawIQReader : public DSP::IQSoruce {
+  public:
+    enum class Format { CU8, CS16, CF32 };
+
+  public:
+    RawIQReader();
+    ~RawIQReader() override;
+
+    RawIQReader(const RawIQReader&) = delete;
+    RawIQReader& operator=(const RawIQReader&) = delete;
+
+    bool openFile(const std::string& file, Format format, uint32_t sampleRate);
+
+    uint32_t read(complex* data, uint32_t len) override;
+
+  public:
+    // Accepts cu8, cs16 and cf32, also as file extension
+    static bool parseFormat(const std::string& name, Format& format);
+
+  private:
+    FILE* mFile;
+    bool mIsStdin;
+    Format mFormat;
+    uint32_t mFrameSize;
+    std::unique_ptr<char[]> mStreamBuffer;
+    std::vector<uint8_t> mBuffer;
+    DSP::IQ::ConvertU8Func mConvertU8;
+    DSP::IQ::ConvertS16Func mConvertS16;
+};
+
+#endif // RAWIQREADER_H
@@ -0,0 +1,79 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "window.h"
+#include "windowedsinc.h"
+
+namespace DSP {
+
+Resampler::Resampler(int interpolation, int decimation, int tapsPerPhase)
+    : mInterpolation(interpolation)
+    , mDecimation(decimation)
+    , mTapsPerPhase(tapsPerPhase)
+    , mIndex(0)
+    , mPhase(0)
+    , mBank() {
+    int gcd = std::gcd(mInterpolation, mDecimation);
+    mInterpolation /= gcd;
+    mDecimation /= gcd;
+
+    // The prototype filter spans 16 output samples
+    if(mTapsPerPhase <= 0) {
+        mTapsPerPhase = 16 * ((mDecimation + mInterpolation - 1) / mInterpolation);
+    }
+
+    // Cutoff at the lower of the two Nyquist rates, the gain of L compensates the zero stuffing
+    double cutoff = 0.5 / std::max(mInterpolation, mDecimation);
+    std::vector<float> taps = TAPS::windowedSinc<float>(mInterpolation * mTapsPerPhase, TAPS::hzToRads(cutoff, 1.0), WINDOW::nuttall, mInterpolation);
+    mBank.buildPolyphaseBank(mInterpolation, taps.data(), taps.size());
+
+    mBuffer.assign(mTapsPerPhase - 1, 0);
+}
+
+int Resampler::process(const complex* inSamples, complex* outSamples, int count) {
+    const int history = mTapsPerPhase - 1;
+    mBuffer.insert(mBuffer.end(), inSamples, inSamples + count);
+
+    // mIndex is the newest input sample under the filter, the bank walks forward from the oldest one.
+    // The taps are symmetric, so the reversed order of the bank matches the convolution.
+    int outCount = 0;
+    while(mIndex < count) {
+        outSamples[outCount++] = mBank.process(&mBuffer[mIndex], mPhase);
+
+        mPhase += mDecimation;
+        mIndex += mPhase / mInterpolation;
+        mPhase %= mInterpolation;
+    }
+    mIndex -= count;
+
+    mBuffer.erase(mBuffer.begin(), mBuffer.end() - history);
+
+    return outCount;
+}
+
+void Resampler::rationalRatio(double inRate, double outRate, int maxInterpolation, int& interpolation, int& decimation) {
+    interpolation = 1;
+    decimation = 1;
+    double bestRatio = 0.0;
+
+    for(int l = 1; l <= maxInterpolation; l++) {
+        int m = static_cast<int>(l * inRate / outRate);
+        if(m < 1) {
+            continue;
+        }
+        double ratio = static_cast<double>(l) / m;
+        if(bestRatio == 0.0 || ratio < bestRatio - 1e-12) {
+            bestRatio = ratio;
+            interpolation = l;
+            decimation = m;
+        }
+    }
+
+    int gcd = std::gcd(interpolation, decimation);
+    interpolation /= gcd;
+    decimation /= gcd;
+}
+
+} // namespace DSP
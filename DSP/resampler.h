@@ -0,0 +1,49 @@
+#ifndef DSP_RESAMPLER_H
+#define DSP_RESAMPLER_H
+
+#include <complex>
+#include <vector>
+
+#include "polyphasebank.h"
+
+namespace DSP {
+
+// Rational L/M polyphase resampler, only the output samples are computed, the zero stuffed signal never exists
+class Resampler {
+  public:
+    typedef std::complex<float> complex;
+
+  public:
+    Resampler(int interpolation, int decimation, int tapsPerPhase = 0);
+
+    // Output buffer must hold outputSize(count) samples, in-place processing is allowed when decimating
+    int process(const complex* inSamples, complex* outSamples, int count);
+
+    int outputSize(int count) const {
+        return static_cast<int>((static_cast<int64_t>(count) * mInterpolation + mDecimation - 1) / mDecimation) + 1;
+    }
+
+    int getInterpolation() const {
+        return mInterpolation;
+    }
+    int getDecimation() const {
+        return mDecimation;
+    }
+
+  public:
+    // Finds the smallest ratio L/M >= outRate / inRate with L <= maxInterpolation
+    static void rationalRatio(double inRate, double outRate, int maxInterpolation, int& interpolation, int& decimation);
+
+  private:
+    int mInterpolation;
+    int mDecimation;
+    int mTapsPerPhase;
+    int mIndex;
+    int mPhase;
+    std::vector<complex> mBuffer;
+    PolyphaseBank<float> mBank;
+};
+
+} // namespace DSP
+
+#endif // DSP_RESAMPLER_H
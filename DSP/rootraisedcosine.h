@@ -0,0 +1,15 @@
+#ifndef DSP_TAPS_ROOTRAISEDCOSINE_H
+#define DSP_TAPS_ROOTRAISEDCOSINE_H
+
+#include <vector>
+
+namespace DSP {
+namespace TAPS {
+
+// Ts is the symbol period in samples (samplerate / symbolrate)
+std::vector<float> rootRaisedCosine(int count, float beta, float Ts);
+
+} // namespace TAPS
+} // namespace DSP
+
+#endif // DSP_TAPS_ROOTRAISEDCOSINE_H
@@ -0,0 +1,41 @@
+#ifndef DSP_STAGE_H
+#define DSP_STAGE_H
+
+#include <complex>
+
+namespace DSP {
+
+// Common block interface of the sample processing stages:
+//   int process(const complex* inSamples, complex* outSamples, int count)
+// consumes count samples and returns the number of samples written, so rate changing stages chain the same way.
+// One sample in, one sample out stages derive from Stage and only implement complex processSample(const complex&),
+// the block loop is resolved at compile time and the per sample function is inlined into it.
+template <typename Derived>
+class Stage {
+  public:
+    // In-place processing is allowed
+    inline int process(const std::complex<float>* inSamples, std::complex<float>* outSamples, int count) {
+        Derived& stage = static_cast<Derived&>(*this);
+        for(int i = 0; i < count; i++) {
+            outSamples[i] = stage.processSample(inSamples[i]);
+        }
+        return count;
+    }
+};
+
+// Runs the stages after each other, the first one reads inSamples, the others work in-place on outSamples.
+// Every stage in the chain must accept in-place processing and must not produce more samples than it consumes.
+template <typename First>
+inline int processStages(const std::complex<float>* inSamples, std::complex<float>* outSamples, int count, First& first) {
+    return first.process(inSamples, outSamples, count);
+}
+
+template <typename First, typename... Rest>
+inline int processStages(const std::complex<float>* inSamples, std::complex<float>* outSamples, int count, First& first, Rest&... rest) {
+    count = first.process(inSamples, outSamples, count);
+    return processStages(outSamples, outSamples, count, rest...);
+}
+
+} // namespace DSP
+
+#endif // DSP_STAGE_H
@@ -1,82 +1,240 @@
 #include "wavreader.h"
 
+#include <algorithm>
+#include <cstring>
 
-Wavreader::Wavreader() {}
+namespace {
+
+// Chunk identifiers, the Wave64 GUIDs start with the same four characters as the RIFF ids
+constexpr uint8_t cWave64Riff[16] = {0x72, 0x69, 0x66, 0x66, 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+constexpr uint8_t cWave64Wave[16] = {0x77, 0x61, 0x76, 0x65, 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+constexpr uint8_t cWave64Fmt[16] = {0x66, 0x6D, 0x74, 0x20, 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+constexpr uint8_t cWave64Data[16] = {0x64, 0x61, 0x74, 0x61, 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+
+constexpr uint16_t cFormatPcm = 0x0001;
+constexpr uint16_t cFormatFloat = 0x0003;
+constexpr uint16_t cFormatExtensible = 0xFFFE;
+
+// Samples converted per read call, reading from the file in large blocks
+constexpr uint32_t cReadBlockSamples = 64 * 1024;
+
+template <typename T>
+T readLE(const uint8_t* data) {
+    T value = 0;
+    for(size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<T>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+Wavreader::Wavreader()
+    : mSampleFormat(SampleFormat::S16)
+    , mNumChannels(0)
+    , mFrameSize(0)
+    , mConvertU8(DSP::IQ::selectConvertU8())
+    , mConvertS16(DSP::IQ::selectConvertS16()) {}
 
 bool Wavreader::openFile(std::string file) {
-    struct WavHeader wavHeader;
-    bool success = true;
+    uint8_t header[12];
+    bool success = false;
 
     mWavStream.open(file, std::ifstream::binary);
 
     do {
         if(!mWavStream.is_open()) {
-            success = false;
             break;
         }
 
-        mWavStream.read(reinterpret_cast<char*>(&wavHeader), sizeof(wavHeader));
-
-        if(wavHeader.riffHeader != 0x46464952) {
-            success = false;
+        mWavStream.read(reinterpret_cast<char*>(header), sizeof(header));
+        if(mWavStream.gcount() != sizeof(header)) {
             break;
         }
 
-        if(wavHeader.filetype != 0x45564157) {
-            success = false;
-            break;
+        if(std::memcmp(header, "RIFF", 4) == 0 && std::memcmp(header + 8, "WAVE", 4) == 0) {
+            success = parseRiff(false);
+        } else if(std::memcmp(header, "RF64", 4) == 0 && std::memcmp(header + 8, "WAVE", 4) == 0) {
+            success = parseRiff(true);
+        } else if(std::memcmp(header, cWave64Riff, sizeof(header)) == 0) {
+            success = parseWave64();
         }
+    } while(false);
 
-        if(wavHeader.dataHeader != 0x61746164) {
-            success = false;
-            break;
+    if(success && mNumChannels != 2) {
+        std::cout << "Only 2 channel I/Q wav files are supported" << std::endl;
+        success = false;
+    }
+
+    return success;
+}
+
+bool Wavreader::parseRiff(bool rf64) {
+    uint8_t chunkHeader[8];
+    uint64_t ds64DataSize = 0;
+    bool formatFound = false;
+
+    while(true) {
+        mWavStream.read(reinterpret_cast<char*>(chunkHeader), sizeof(chunkHeader));
+        if(mWavStream.gcount() != sizeof(chunkHeader)) {
+            return false;
         }
 
-        mSampleRate = wavHeader.sampleRate;
-        mBitsPerSample = wavHeader.bitsPerSample;
-        mTotalSamples = wavHeader.subChunk2Size / wavHeader.numChannels / (wavHeader.bitsPerSample / 8);
+        uint64_t chunkSize = readLE<uint32_t>(chunkHeader + 4);
 
-    } while(false);
+        if(std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            if(!parseFormat(chunkSize)) {
+                return false;
+            }
+            formatFound = true;
+        } else if(std::memcmp(chunkHeader, "ds64", 4) == 0) {
+            // RF64 keeps the real 64 bit sizes here, the 32 bit fields are 0xFFFFFFFF
+            uint8_t ds64[16];
+            if(chunkSize < sizeof(ds64)) {
+                return false;
+            }
+            mWavStream.read(reinterpret_cast<char*>(ds64), sizeof(ds64));
+            ds64DataSize = readLE<uint64_t>(ds64 + 8);
+            mWavStream.seekg(chunkSize - sizeof(ds64) + (chunkSize & 1), std::ios_base::cur);
+        } else if(std::memcmp(chunkHeader, "data", 4) == 0) {
+            if(!formatFound) {
+                return false;
+            }
+            if(rf64 && chunkSize == 0xFFFFFFFF) {
+                chunkSize = ds64DataSize;
+            }
 
-    return success;
+            // Recorders which could not finalize the header leave 0 or 0xFFFFFFFF here, use the rest of the file then
+            std::streampos dataStart = mWavStream.tellg();
+            mWavStream.seekg(0, std::ios_base::end);
+            uint64_t available = static_cast<uint64_t>(mWavStream.tellg() - dataStart);
+            mWavStream.seekg(dataStart);
+            if(chunkSize == 0 || chunkSize == 0xFFFFFFFF || chunkSize > available) {
+                chunkSize = available;
+            }
+
+            mTotalSamples = chunkSize / mFrameSize;
+            return true;
+        } else {
+            mWavStream.seekg(chunkSize + (chunkSize & 1), std::ios_base::cur);
+        }
+    }
+}
+
+bool Wavreader::parseWave64() {
+    uint8_t waveId[16];
+    uint8_t chunkHeader[24];
+    bool formatFound = false;
+
+    // The riff GUID is followed by the 64 bit file size and the wave GUID
+    mWavStream.seekg(16 + 8, std::ios_base::beg);
+    mWavStream.read(reinterpret_cast<char*>(waveId), sizeof(waveId));
+    if(mWavStream.gcount() != sizeof(waveId) || std::memcmp(waveId, cWave64Wave, sizeof(waveId)) != 0) {
+        return false;
+    }
+
+    while(true) {
+        mWavStream.read(reinterpret_cast<char*>(chunkHeader), sizeof(chunkHeader));
+        if(mWavStream.gcount() != sizeof(chunkHeader)) {
+            return false;
+        }
+
+        // Wave64 chunk sizes include the 24 byte header and chunks are aligned to 8 bytes
+        uint64_t chunkSize = readLE<uint64_t>(chunkHeader + 16);
+        if(chunkSize < sizeof(chunkHeader)) {
+            return false;
+        }
+        chunkSize -= sizeof(chunkHeader);
+        uint64_t padding = (8 - (chunkSize & 7)) & 7;
+
+        if(std::memcmp(chunkHeader, cWave64Fmt, 16) == 0) {
+            if(!parseFormat(chunkSize)) {
+                return false;
+            }
+            mWavStream.seekg(padding - (chunkSize & 1), std::ios_base::cur);
+            formatFound = true;
+        } else if(std::memcmp(chunkHeader, cWave64Data, 16) == 0) {
+            if(!formatFound) {
+                return false;
+            }
+            mTotalSamples = chunkSize / mFrameSize;
+            return true;
+        } else {
+            mWavStream.seekg(chunkSize + padding, std::ios_base::cur);
+        }
+    }
+}
+
+bool Wavreader::parseFormat(uint64_t chunkSize) {
+    uint8_t format[40] = {0};
+
+    if(chunkSize < 16) {
+        return false;
+    }
+
+    uint64_t length = std::min<uint64_t>(chunkSize, sizeof(format));
+    mWavStream.read(reinterpret_cast<char*>(format), length);
+    mWavStream.seekg(chunkSize - length + (chunkSize & 1), std::ios_base::cur);
+
+    uint16_t audioFormat = readLE<uint16_t>(format);
+    mNumChannels = readLE<uint16_t>(format + 2);
+    mSampleRate = readLE<uint32_t>(format + 4);
+    mBitsPerSample = readLE<uint16_t>(format + 14);
+
+    // WAVE_FORMAT_EXTENSIBLE stores the real format in the first two bytes of the sub format GUID
+    if(audioFormat == cFormatExtensible && chunkSize >= 26) {
+        audioFormat = readLE<uint16_t>(format + 24);
+    }
+
+    if(audioFormat == cFormatPcm && mBitsPerSample == 8) {
+        mSampleFormat = SampleFormat::U8;
+    } else if(audioFormat == cFormatPcm && mBitsPerSample == 16) {
+        mSampleFormat = SampleFormat::S16;
+    } else if(audioFormat == cFormatFloat && mBitsPerSample == 32) {
+        mSampleFormat = SampleFormat::F32;
+    } else {
+        std::cout << "Unsupported wav sample format: " << audioFormat << ", " << mBitsPerSample << " bits" << std::endl;
+        return false;
+    }
+
+    mFrameSize = mNumChannels * (mBitsPerSample / 8);
+    return mFrameSize > 0;
 }
 
 uint32_t Wavreader::read(complex* data, uint32_t len) {
-    uint8_t buffer8bit[2];
-    int16_t buffer16bit[2];
     uint32_t samplesCount = 0;
 
-    if(!mWavStream.is_open()) {
+    if(!mWavStream.is_open() || mFrameSize == 0) {
         return 0;
     }
 
-    do {
-        if(mBitsPerSample == 8) {
-            mWavStream.read(reinterpret_cast<char*>(buffer8bit), sizeof(buffer8bit));
-            if(mWavStream.gcount() != sizeof(buffer8bit)) {
-                break;
-            }
+    len = static_cast<uint32_t>(std::min<uint64_t>(len, mTotalSamples - mReadedSamples));
 
-            data[samplesCount] = complex(static_cast<float>(buffer8bit[0]), static_cast<float>(buffer8bit[1]));
-        } else if(mBitsPerSample == 16) {
-            mWavStream.read(reinterpret_cast<char*>(buffer16bit), sizeof(buffer16bit));
-            if(mWavStream.gcount() != sizeof(buffer16bit)) {
-                break;
-            }
+    while(samplesCount < len) {
+        uint32_t count = std::min(len - samplesCount, cReadBlockSamples);
 
-            data[samplesCount] = complex(static_cast<float>(buffer16bit[0]), static_cast<float>(buffer16bit[1]));
-        } else {
-            break;
+        // Float samples are read straight into the output
+        char* destination = reinterpret_cast<char*>(data + samplesCount);
+        if(mSampleFormat != SampleFormat::F32) {
+            mBuffer.resize(static_cast<size_t>(cReadBlockSamples) * mFrameSize);
+            destination = reinterpret_cast<char*>(mBuffer.data());
         }
 
-        samplesCount++;
-        mReadedSamples++;
-
-        if(samplesCount == len) {
+        mWavStream.read(destination, static_cast<std::streamsize>(count) * mFrameSize);
+        count = static_cast<uint32_t>(mWavStream.gcount() / mFrameSize);
+        if(count == 0) {
             break;
         }
 
-    } while(true);
+        if(mSampleFormat == SampleFormat::U8) {
+            mConvertU8(mBuffer.data(), data + samplesCount, count);
+        } else if(mSampleFormat == SampleFormat::S16) {
+            mConvertS16(reinterpret_cast<const int16_t*>(mBuffer.data()), data + samplesCount, count);
+        }
+
+        samplesCount += count;
+        mReadedSamples += count;
+    }
 
     return samplesCount;
 }
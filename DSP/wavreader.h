@@ -5,35 +5,16 @@
 
 #include <fstream>
 #include <iostream>
+#include <vector>
 
+#include "iqconverter.h"
 #include "iqsource.h"
 
-#ifdef __GNUC__
-#define PACK(__Declaration__) __Declaration__ __attribute__((__packed__))
-#endif
-
-#ifdef _MSC_VER
-#define PACK(__Declaration__) __pragma(pack(push, 1)) __Declaration__ __pragma(pack(pop))
-#endif
-
-
+// Reads 2 channel I/Q recordings from RIFF WAVE, RF64 and Sony Wave64 files.
+// Supported sample formats are unsigned 8 bit, signed 16 bit PCM and 32 bit float.
 class Wavreader : public DSP::IQSoruce {
   private:
-    PACK(struct WavHeader {
-        uint32_t riffHeader;
-        uint32_t chunkSize;
-        uint32_t filetype;
-        char fmtHeader[4];
-        uint32_t subchunkSize;
-        uint16_t audioFormat;
-        uint16_t numChannels;
-        uint32_t sampleRate;
-        uint32_t byteRate;
-        uint16_t blockAlign;
-        uint16_t bitsPerSample;
-        uint32_t dataHeader;
-        uint32_t subChunk2Size;
-    });
+    enum class SampleFormat { U8, S16, F32 };
 
   public:
     Wavreader();
@@ -42,8 +23,19 @@ class Wavreader : public DSP::IQSoruce {
 
     uint32_t read(complex* data, uint32_t len) override;
 
+  private:
+    bool parseRiff(bool rf64);
+    bool parseWave64();
+    bool parseFormat(uint64_t chunkSize);
+
   private:
     std::ifstream mWavStream;
+    SampleFormat mSampleFormat;
+    uint16_t mNumChannels;
+    uint32_t mFrameSize;
+    std::vector<uint8_t> mBuffer;
+    DSP::IQ::ConvertU8Func mConvertU8;
+    DSP::IQ::ConvertS16Func mConvertS16;
 };
 
 #endif // WAVREADER_H
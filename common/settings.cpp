@@ -1,9 +1,11 @@
 #include "settings.h"
 
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include "version.h"
 
@@ -24,17 +26,22 @@ Settings& Settings::getInstance() {
 Settings::Settings() {
     mSettingsList.push_back(SettingsData("--help", "-h", "Print help"));
     mSettingsList.push_back(SettingsData("--tle", "-t", "TLE file required for pass calculation"));
-    mSettingsList.push_back(SettingsData("--input", "-i", "Input S file containing softbits"));
+    mSettingsList.push_back(SettingsData("--input", "-i", "Input S file containing softbits, wav or raw I/Q (.cu8, .cs16, .cf32, .raw, .iq) file, - reads raw I/Q from stdin"));
+    mSettingsList.push_back(SettingsData("--samplerate", "-sr", "Sample rate of raw I/Q input"));
+    mSettingsList.push_back(SettingsData("--iqformat", "-iqf", "Sample format of raw I/Q input (cu8, cs16, cf32), default is the file extension"));
     mSettingsList.push_back(SettingsData("--output", "-o", "Output folder where generated files will be placed"));
     mSettingsList.push_back(SettingsData("--date", "-d", "Specify pass date, format should be dd-mm-yyyy"));
     mSettingsList.push_back(SettingsData("--format", "-f", "Output image format (bmp, jpg)"));
     mSettingsList.push_back(SettingsData("--symbolrate", "-s", "Set symbol rate for demodulator"));
-    mSettingsList.push_back(SettingsData("--mode", "-m", "Set demodulator mode to qpsk or oqpsk"));
+    mSettingsList.push_back(SettingsData("--mode", "-m", "Set demodulator mode to qpsk or oqpsk, auto detects mode, --diff and --int from .S soft bit input"));
     mSettingsList.push_back(SettingsData("--diff", "-diff", "Use differential decoding (Maybe required for newer satellites)"));
     mSettingsList.push_back(SettingsData("--int", "-int", "Deinterleave (Maybe required for newer satellites)"));
     mSettingsList.push_back(SettingsData("--brokenM2", "-b", "Broken M2 modulation"));
     mSettingsList.push_back(SettingsData("--compmaxage", "-c", "Maximum image age in hours for creating composite image"));
     mSettingsList.push_back(SettingsData("--satellite", "-sat", "Name of the satellite settings in settings.ini file"));
+    mSettingsList.push_back(SettingsData("--batch", "-batch", "Folder or list file of recordings (wav, raw I/Q, .s, .cadu), every file is processed as a separate pass"));
+    mSettingsList.push_back(SettingsData("--jobs", "-j", "Number of passes processed concurrently in batch mode, default is the number of CPU cores"));
+    mSettingsList.push_back(SettingsData("--quiet", "-q", "No per-frame status lines on the console, the statistics are still written to the .json report"));
 }
 
 void Settings::parseArgs(int argc, char** argv) {
@@ -43,7 +50,8 @@ void Settings::parseArgs(int argc, char** argv) {
     } else {
         for(int i = 1; i < argc; i++) {
             if(i + 1 < argc) {
-                if(*argv[i + 1] == '-') {
+                // A lone "-" is a value (stdin), not an option
+                if(*argv[i + 1] == '-' && argv[i + 1][1] != '\0') {
                     mArgs.insert(std::make_pair(argv[i], "true"));
                 } else {
                     mArgs.insert(std::make_pair(argv[i], argv[i + 1]));
@@ -89,7 +97,16 @@ void Settings::parseIni(const std::string& path) {
 
     ini::extract(mIniParser.sections["Demodulator"]["CostasBandwidth"], mCostasBw, 50);
     ini::extract(mIniParser.sections["Demodulator"]["RRCFilterOrder"], mRRCFilterOrder, 64);
+    ini::extract(mIniParser.sections["Demodulator"]["SamplesPerSymbol"], mSamplesPerSymbol, 0.0f);
+    // Below 2 samples per symbol the clock recovery outputs more symbols than it gets samples, which overflows the in-place stage buffers
+    if(mSamplesPerSymbol > 0.0f && mSamplesPerSymbol < cMinSamplesPerSymbol) {
+        std::cout << "SamplesPerSymbol " << mSamplesPerSymbol << " is too low, using " << cMinSamplesPerSymbol << std::endl;
+        mSamplesPerSymbol = cMinSamplesPerSymbol;
+    }
     ini::extract(mIniParser.sections["Demodulator"]["WaitForLock"], mWaitForLock, true);
+    ini::extract(mIniParser.sections["Demodulator"]["Pipelined"], mPipelinedDemodulator, false);
+    ini::extract(mIniParser.sections["Demodulator"]["AgcMode"], mAgcMode, std::string("sample"));
+    ini::extract(mIniParser.sections["Demodulator"]["SaveSymbols"], mSaveSymbols, true);
 
     ini::extract(mIniParser.sections["Treatment"]["FillBlackLines"], mFillBackLines, true);
 
@@ -272,6 +289,61 @@ DateTime Settings::getPassDate() const {
     return dateTime;
 }
 
+uint32_t Settings::getSampleRate() const {
+    uint32_t sampleRate = 0;
+
+    if(mArgs.count("-sr")) {
+        sampleRate = atoi(mArgs.at("-sr").c_str());
+    }
+    if(mArgs.count("--samplerate")) {
+        sampleRate = atoi(mArgs.at("--samplerate").c_str());
+    }
+
+    return sampleRate;
+}
+
+std::string Settings::getBatchPath() const {
+    std::string path;
+
+    if(mArgs.count("-batch")) {
+        path = mArgs.at("-batch");
+    }
+    if(mArgs.count("--batch")) {
+        path = mArgs.at("--batch");
+    }
+
+    return path;
+}
+
+int Settings::getBatchJobs() const {
+    int jobs = 0;
+
+    if(mArgs.count("-j")) {
+        jobs = atoi(mArgs.at("-j").c_str());
+    }
+    if(mArgs.count("--jobs")) {
+        jobs = atoi(mArgs.at("--jobs").c_str());
+    }
+
+    if(jobs <= 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return jobs;
+}
+
+std::string Settings::getIQFormat() const {
+    std::string format;
+
+    if(mArgs.count("-iqf")) {
+        format = mArgs.at("-iqf");
+    }
+    if(mArgs.count("--iqformat")) {
+        format = mArgs.at("--iqformat");
+    }
+
+    return format;
+}
+
 float Settings::getSymbolRate() const {
     float symbolRate = 72000.0f;
 
@@ -324,6 +396,19 @@ bool Settings::deInterleave() const {
     return result;
 }
 
+bool Settings::quiet() const {
+    bool result = false;
+
+    if(mArgs.count("-q")) {
+        result = mArgs.at("-q") == "true" || atoi(mArgs.at("-q").c_str()) > 0;
+    }
+    if(mArgs.count("--quiet")) {
+        result = mArgs.at("--quiet") == "true" || atoi(mArgs.at("--quiet").c_str()) > 0;
+    }
+
+    return result;
+}
+
 bool Settings::getBrokenModulation() const {
     bool result = false;
 
@@ -100,16 +100,25 @@ class Settings {
     std::string getOutputPath() const;
     std::string getOutputFormat() const;
     DateTime getPassDate() const;
+    uint32_t getSampleRate() const;
+    std::string getIQFormat() const;
+    std::string getBatchPath() const;
+    int getBatchJobs() const;
     float getSymbolRate() const;
     std::string getDemodulatorMode() const;
     bool differentialDecode() const;
     bool deInterleave() const;
     bool getBrokenModulation() const;
+    bool quiet() const;
 
     bool showHelp() const {
         return mArgs.count("-h") > 0 || mArgs.count("--help") > 0;
     }
 
+    bool passDateGiven() const {
+        return mArgs.count("-d") > 0 || mArgs.count("--date") > 0;
+    }
+
     int getJpegQuality() const {
         return mJpegQuality;
     }
@@ -181,9 +190,21 @@ class Settings {
     int getRRCFilterOrder() const {
         return mRRCFilterOrder;
     }
+    float getSamplesPerSymbol() const {
+        return mSamplesPerSymbol;
+    }
     bool waitForlock() const {
         return mWaitForLock;
     }
+    bool pipelinedDemodulator() const {
+        return mPipelinedDemodulator;
+    }
+    const std::string& getAgcMode() const {
+        return mAgcMode;
+    }
+    bool saveSymbols() const {
+        return mSaveSymbols;
+    }
 
     bool fillBackLines() const {
         return mFillBackLines;
@@ -285,6 +306,10 @@ class Settings {
         mArgs.clear();
     }
 
+  private:
+    // Lowest SamplesPerSymbol the demodulator accepts, 0 still disables resampling
+    static constexpr float cMinSamplesPerSymbol = 2.0f;
+
   private:
     std::map<std::string, std::string> mArgs;
     std::list<SettingsData> mSettingsList;
@@ -313,7 +338,11 @@ class Settings {
     // ini section: Demodulator
     int mCostasBw;
     int mRRCFilterOrder;
+    float mSamplesPerSymbol;
     bool mWaitForLock;
+    bool mPipelinedDemodulator;
+    std::string mAgcMode;
+    bool mSaveSymbols;
 
     // ini section: Treatment
     bool mFillBackLines;
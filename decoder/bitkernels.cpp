@@ -0,0 +1,279 @@
+#include "bitkernels.h"
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace BitKernels {
+
+struct Rotation {
+    bool swapIQ;
+    uint8_t xorI;
+    uint8_t xorQ;
+};
+
+// The switch cases of Correlation::rotateSoftIqInPlace: 0x7F moves a signed soft bit to offset binary, 0x80 does that and flips it
+static constexpr Rotation cRotations[8] = {{false, 0x7F, 0x7F}, {false, 0x7F, 0x80}, {false, 0x80, 0x80}, {false, 0x80, 0x7F}, {true, 0x7F, 0x7F}, {true, 0x80, 0x7F}, {true, 0x80, 0x80}, {true, 0x7F, 0x80}};
+
+// Even bytes are I, odd bytes Q
+static constexpr uint8_t cQMask[32] = {0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF, 0, 0xFF};
+
+static inline bool delayed(uint16_t phaseShift) {
+    return phaseShift > 7;
+}
+
+// Scalar rotation of the pairs in [start, length). With the OQPSK delay every pair gets the Q of the next one, the last pair a zero Q.
+static void rotatePairs(const uint8_t* src, uint8_t* dst, uint32_t start, uint32_t length, uint16_t phaseShift) {
+    const Rotation& rotation = cRotations[phaseShift & 7];
+    const bool delay = delayed(phaseShift);
+
+    for(uint32_t i = start; i < length; i += 2) {
+        uint8_t a = src[i];
+        uint8_t b = src[i + 1];
+        if(rotation.swapIQ) {
+            uint8_t swap = a;
+            a = b;
+            b = swap;
+        }
+        dst[i] = a ^ rotation.xorI;
+        if(!delay) {
+            dst[i + 1] = b ^ rotation.xorQ;
+        } else if(i > start) {
+            dst[i - 1] = b ^ rotation.xorQ;
+        }
+    }
+
+    if(delay && length > start) {
+        dst[length - 1] = 0;
+    }
+}
+
+RotateFunc selectRotate() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return rotateAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return rotateSSE2;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return rotateNEON;
+    }
+#endif
+
+    (void)cpu;
+    return rotateGeneric;
+}
+
+XorFunc selectXor() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return xorAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return xorSSE2;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return xorNEON;
+    }
+#endif
+
+    (void)cpu;
+    return xorGeneric;
+}
+
+void rotateGeneric(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    rotatePairs(src, dst, 0, length, phaseShift);
+}
+
+void xorGeneric(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    for(uint32_t i = 0; i < length; i++) {
+        data[i] ^= pattern[i] ^ invert;
+    }
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 static inline __m128i rotateBlock(__m128i pairs, const Rotation& rotation, __m128i xorMask) {
+    if(rotation.swapIQ) {
+        pairs = _mm_or_si128(_mm_slli_epi16(pairs, 8), _mm_srli_epi16(pairs, 8));
+    }
+    return _mm_xor_si128(pairs, xorMask);
+}
+
+TARGET_AVX2 static inline __m256i rotateBlock(__m256i pairs, const Rotation& rotation, __m256i xorMask) {
+    if(rotation.swapIQ) {
+        pairs = _mm256_or_si256(_mm256_slli_epi16(pairs, 8), _mm256_srli_epi16(pairs, 8));
+    }
+    return _mm256_xor_si256(pairs, xorMask);
+}
+
+TARGET_SSE2 void rotateSSE2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    const Rotation& rotation = cRotations[phaseShift & 7];
+    const __m128i xorMask = _mm_set1_epi16(static_cast<int16_t>(rotation.xorI | (rotation.xorQ << 8)));
+    const __m128i qMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cQMask));
+    uint32_t i = 0;
+
+    if(!delayed(phaseShift)) {
+        for(; i + 16 <= length; i += 16) {
+            __m128i pairs = rotateBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), rotation, xorMask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), pairs);
+        }
+    } else if(length >= 32) {
+        // Q of every pair comes from the pair after it, the last one of a block from the next block. That one is loaded before
+        // the store, so src and dst may be the same.
+        __m128i pairs = rotateBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), rotation, xorMask);
+        for(; i + 32 <= length; i += 16) {
+            __m128i next = rotateBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16)), rotation, xorMask);
+            __m128i shifted = _mm_or_si128(_mm_srli_si128(pairs, 2), _mm_slli_si128(next, 14));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_andnot_si128(qMask, pairs), _mm_and_si128(qMask, shifted)));
+            pairs = next;
+        }
+    }
+
+    rotatePairs(src, dst, i, length, phaseShift);
+}
+
+TARGET_AVX2 void rotateAVX2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    const Rotation& rotation = cRotations[phaseShift & 7];
+    const __m256i xorMask = _mm256_set1_epi16(static_cast<int16_t>(rotation.xorI | (rotation.xorQ << 8)));
+    const __m256i qMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cQMask));
+    uint32_t i = 0;
+
+    if(!delayed(phaseShift)) {
+        for(; i + 32 <= length; i += 32) {
+            __m256i pairs = rotateBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), rotation, xorMask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), pairs);
+        }
+    } else if(length >= 64) {
+        __m256i pairs = rotateBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), rotation, xorMask);
+        for(; i + 64 <= length; i += 32) {
+            __m256i next = rotateBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)), rotation, xorMask);
+            // Byte shift across the 128 bit lanes: the alignr takes the high lane of this block and the low lane of the next one
+            __m256i shifted = _mm256_alignr_epi8(_mm256_permute2x128_si256(pairs, next, 0x21), pairs, 2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(pairs, shifted, qMask));
+            pairs = next;
+        }
+    }
+
+    rotatePairs(src, dst, i, length, phaseShift);
+}
+
+TARGET_SSE2 void xorSSE2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    const __m128i invertMask = _mm_set1_epi8(static_cast<char>(invert));
+    uint32_t i = 0;
+
+    for(; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i mask = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + i)), invertMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(bytes, mask));
+    }
+
+    xorGeneric(data + i, pattern + i, invert, length - i);
+}
+
+TARGET_AVX2 void xorAVX2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    const __m256i invertMask = _mm256_set1_epi8(static_cast<char>(invert));
+    uint32_t i = 0;
+
+    for(; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i mask = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern + i)), invertMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(bytes, mask));
+    }
+
+    xorGeneric(data + i, pattern + i, invert, length - i);
+}
+
+#else
+
+void rotateSSE2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    rotateGeneric(src, dst, length, phaseShift);
+}
+
+void rotateAVX2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    rotateGeneric(src, dst, length, phaseShift);
+}
+
+void xorSSE2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    xorGeneric(data, pattern, invert, length);
+}
+
+void xorAVX2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    xorGeneric(data, pattern, invert, length);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+static inline uint8x16_t rotateBlock(uint8x16_t pairs, const Rotation& rotation, uint8x16_t xorMask) {
+    if(rotation.swapIQ) {
+        pairs = vrev16q_u8(pairs);
+    }
+    return veorq_u8(pairs, xorMask);
+}
+
+void rotateNEON(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    const Rotation& rotation = cRotations[phaseShift & 7];
+    const uint8x16_t qMask = vld1q_u8(cQMask);
+    const uint8x16_t xorMask = vbslq_u8(qMask, vdupq_n_u8(rotation.xorQ), vdupq_n_u8(rotation.xorI));
+    uint32_t i = 0;
+
+    if(!delayed(phaseShift)) {
+        for(; i + 16 <= length; i += 16) {
+            vst1q_u8(dst + i, rotateBlock(vld1q_u8(src + i), rotation, xorMask));
+        }
+    } else if(length >= 32) {
+        uint8x16_t pairs = rotateBlock(vld1q_u8(src), rotation, xorMask);
+        for(; i + 32 <= length; i += 16) {
+            uint8x16_t next = rotateBlock(vld1q_u8(src + i + 16), rotation, xorMask);
+            vst1q_u8(dst + i, vbslq_u8(qMask, vextq_u8(pairs, next, 2), pairs));
+            pairs = next;
+        }
+    }
+
+    rotatePairs(src, dst, i, length, phaseShift);
+}
+
+void xorNEON(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    const uint8x16_t invertMask = vdupq_n_u8(invert);
+    uint32_t i = 0;
+
+    for(; i + 16 <= length; i += 16) {
+        uint8x16_t mask = veorq_u8(vld1q_u8(pattern + i), invertMask);
+        vst1q_u8(data + i, veorq_u8(vld1q_u8(data + i), mask));
+    }
+
+    xorGeneric(data + i, pattern + i, invert, length - i);
+}
+
+#else
+
+void rotateNEON(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift) {
+    rotateGeneric(src, dst, length, phaseShift);
+}
+
+void xorNEON(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length) {
+    xorGeneric(data, pattern, invert, length);
+}
+
+#endif
+
+} // namespace BitKernels
@@ -0,0 +1,31 @@
+#ifndef BITKERNELS_H
+#define BITKERNELS_H
+
+#include <stdint.h>
+
+// Byte kernels of the frame decoder between the correlator and the Viterbi decoder, and after it
+namespace BitKernels {
+
+// Copies length soft bits (multiple of 2) from src to dst rotated like Correlation::rotateSoftIqInPlace, src and dst may be the same.
+// Phase shifts 0-7 swap and flip the I/Q pairs and move them from signed to offset binary, 8-15 do the same and undo the OQPSK delay of Q.
+typedef void (*RotateFunc)(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift);
+
+// data[i] ^= pattern[i] ^ invert
+typedef void (*XorFunc)(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length);
+
+RotateFunc selectRotate();
+XorFunc selectXor();
+
+void rotateGeneric(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift);
+void rotateSSE2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift);
+void rotateAVX2(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift);
+void rotateNEON(const uint8_t* src, uint8_t* dst, uint32_t length, uint16_t phaseShift);
+
+void xorGeneric(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length);
+void xorSSE2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length);
+void xorAVX2(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length);
+void xorNEON(uint8_t* data, const uint8_t* pattern, uint8_t invert, uint32_t length);
+
+} // namespace BitKernels
+
+#endif // BITKERNELS_H
@@ -1,49 +1,209 @@
 #include "correlation.h"
 
+#include <algorithm>
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
 Correlation::Correlation(uint64_t syncWord, bool oqpsk)
     : mSyncWord(syncWord)
-    , mOqpskMode(oqpsk) {
+    , mOqpskMode(oqpsk)
+    , mPackBits(selectPackBits())
+    , mFindSync(selectFindSync()) {
     initKernels();
 }
 
 void Correlation::correlate(const uint8_t* softBits, int64_t size, CorrelationCallback callback) {
     CorellationResult result{};
+    PhaseShift phaseShift = 0;
+    int64_t position = 0;
 
-    for(uint32_t i = 0; i < size - 64; i++) {
-        for(int n = 0; n < mKernels.size(); n++) {
-            int score = 0;
-            for(int k = 0; k < mKernels[n].size(); k++) {
-                score += hardCorrelate(softBits[i + k], mKernels[n][k]);
-            }
-            result.pos = score > result.corr ? i : result.pos;
-            result.corr = score > result.corr ? score : result.corr;
-
-            if(result.corr >= CORRELATION_LIMIT) {
-                i += callback(result, n);
-                result.pos = 0;
-                result.corr = 0;
-                break;
-            }
+    while((position = findSync(softBits, size, position, result, phaseShift)) < size - 64) {
+        position += callback(result, phaseShift);
+        position++;
+    }
+}
+
+int64_t Correlation::findSync(const uint8_t* softBits, int64_t size, int64_t position, CorellationResult& result, PhaseShift& phaseShift) {
+    const int64_t end = size - 64;
+    const int maxErrors = 64 - CORRELATION_LIMIT;
+
+    // Slice the soft bits block by block, after that a position costs one XOR and popcount per kernel instead of 64 byte compares
+    while(position < end) {
+        const int64_t positions = std::min<int64_t>(end - position, cSearchBlockSize);
+        const int64_t bytes = std::min<int64_t>(size - position, positions + 63);
+        mPackedBits.resize(bytes / 64 + 2);
+        mPackBits(softBits + position, bytes, mPackedBits.data());
+
+        int kernel = 0;
+        int errors = 0;
+        int64_t found = mFindSync(mPackedBits.data(), 0, positions, mKernels.data(), static_cast<int>(mKernels.size()), maxErrors, kernel, errors);
+        if(found < positions) {
+            result.pos = static_cast<uint32_t>(position + found);
+            result.corr = 64 - errors;
+            phaseShift = static_cast<PhaseShift>(kernel);
+            return position + found;
         }
+        position += positions;
     }
+
+    return end;
 }
 
 void Correlation::initKernels() {
-    mKernels.resize(8);
+    std::vector<std::vector<uint8_t>> softKernels(8);
 
-    for(int i = 0; i < mKernels.size(); i++) {
-        mKernels[i].resize(64);
-        hardToSoft(rotate64(mSyncWord, i), mKernels[i].data());
+    for(int i = 0; i < softKernels.size(); i++) {
+        softKernels[i].resize(64);
+        hardToSoft(rotate64(mSyncWord, i), softKernels[i].data());
     }
 
     if(mOqpskMode) {
         for(int i = 0; i < 8; i++) {
-            mKernels.push_back(mKernels[i]);
-            delayOQPSK(mKernels[i + 8].data(), mKernels[i + 8].size());
+            softKernels.push_back(softKernels[i]);
+            delayOQPSK(softKernels[i + 8].data(), softKernels[i + 8].size());
+        }
+    }
+
+    mKernels.resize(softKernels.size());
+    for(int i = 0; i < softKernels.size(); i++) {
+        packBitsGeneric(softKernels[i].data(), 64, &mKernels[i]);
+    }
+}
+
+Correlation::PackBitsFunc Correlation::selectPackBits() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return packBitsAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return packBitsSSE2;
+    }
+#endif
+
+    (void)cpu;
+    return packBitsGeneric;
+}
+
+Correlation::FindSyncFunc Correlation::selectFindSync() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasPOPCNT()) {
+        return findSyncPOPCNT;
+    }
+#endif
+
+    (void)cpu;
+    return findSyncGeneric;
+}
+
+void Correlation::packBitsGeneric(const uint8_t* softBits, int64_t size, uint64_t* packedBits) {
+    for(int64_t i = 0; i < size; i += 64) {
+        int bits = size - i < 64 ? static_cast<int>(size - i) : 64;
+        uint64_t word = 0;
+        for(int n = 0; n < bits; n++) {
+            word |= static_cast<uint64_t>(softBits[i + n] >= 127) << n;
+        }
+        packedBits[i / 64] = word;
+    }
+}
+
+int64_t Correlation::findSyncGeneric(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors) {
+    for(; position < end; position++) {
+        const uint64_t window = packedWindow(packedBits, position);
+        for(int n = 0; n < kernelCount; n++) {
+            int difference = countBits64(window ^ kernels[n]);
+            if(difference <= maxErrors) {
+                kernel = n;
+                errors = difference;
+                return position;
+            }
+        }
+    }
+    return end;
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 void Correlation::packBitsSSE2(const uint8_t* softBits, int64_t size, uint64_t* packedBits) {
+    const __m128i threshold = _mm_set1_epi8(127);
+    int64_t i = 0;
+
+    // soft >= 127 exactly where max(soft, 127) == soft, movemask collects the first byte into bit 0
+    for(; i + 64 <= size; i += 64) {
+        uint64_t word = 0;
+        for(int n = 0; n < 4; n++) {
+            __m128i soft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(softBits + i + n * 16));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(soft, threshold), soft)));
+            word |= static_cast<uint64_t>(mask) << (n * 16);
+        }
+        packedBits[i / 64] = word;
+    }
+
+    if(i < size) {
+        packBitsGeneric(softBits + i, size - i, packedBits + i / 64);
+    }
+}
+
+TARGET_AVX2 void Correlation::packBitsAVX2(const uint8_t* softBits, int64_t size, uint64_t* packedBits) {
+    const __m256i threshold = _mm256_set1_epi8(127);
+    int64_t i = 0;
+
+    for(; i + 64 <= size; i += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(softBits + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(softBits + i + 32));
+        uint32_t lowMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(low, threshold), low)));
+        uint32_t highMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(high, threshold), high)));
+        packedBits[i / 64] = (static_cast<uint64_t>(highMask) << 32) | lowMask;
+    }
+
+    if(i < size) {
+        packBitsGeneric(softBits + i, size - i, packedBits + i / 64);
+    }
+}
+
+TARGET_POPCNT int64_t Correlation::findSyncPOPCNT(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors) {
+    for(; position < end; position++) {
+        const uint64_t window = packedWindow(packedBits, position);
+        for(int n = 0; n < kernelCount; n++) {
+            const uint64_t difference = window ^ kernels[n];
+#if defined(__x86_64__) || defined(_M_X64)
+            int count = static_cast<int>(_mm_popcnt_u64(difference));
+#else
+            int count = _mm_popcnt_u32(static_cast<uint32_t>(difference)) + _mm_popcnt_u32(static_cast<uint32_t>(difference >> 32));
+#endif
+            if(count <= maxErrors) {
+                kernel = n;
+                errors = count;
+                return position;
+            }
         }
     }
+    return end;
 }
 
+#else
+
+void Correlation::packBitsSSE2(const uint8_t* softBits, int64_t size, uint64_t* packedBits) {
+    packBitsGeneric(softBits, size, packedBits);
+}
+
+void Correlation::packBitsAVX2(const uint8_t* softBits, int64_t size, uint64_t* packedBits) {
+    packBitsGeneric(softBits, size, packedBits);
+}
+
+int64_t Correlation::findSyncPOPCNT(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors) {
+    return findSyncGeneric(packedBits, position, end, kernels, kernelCount, maxErrors, kernel, errors);
+}
+
+#endif
+
 uint64_t Correlation::rotate64(uint64_t word, PhaseShift phaseShift) {
 
     switch(phaseShift) {
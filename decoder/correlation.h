@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #include <functional>
+#include <vector>
 
 class Correlation {
   public:
@@ -17,17 +18,21 @@ class Correlation {
   public:
     typedef std::function<uint32_t(CorellationResult&, PhaseShift)> CorrelationCallback;
 
+    // Hard decisions of the soft bits, bit n of the stream is bit (n % 64) of word n / 64
+    typedef void (*PackBitsFunc)(const uint8_t* softBits, int64_t size, uint64_t* packedBits);
+    // Returns the first position in [position, end) where a kernel has at most maxErrors different bits, or end if there is none
+    typedef int64_t (*FindSyncFunc)(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors);
+
   public:
     Correlation(uint64_t syncWord, bool oqpsk);
 
     void correlate(const uint8_t* softBits, int64_t size, CorrelationCallback callback);
+    // Searches the positions [position, size - 64), returns the first one where the sync word correlates or size - 64 if there is none
+    int64_t findSync(const uint8_t* softBits, int64_t size, int64_t position, CorellationResult& result, PhaseShift& phaseShift);
     uint64_t rotate64(uint64_t word, PhaseShift phaseShift);
 
   private:
     void initKernels();
-    inline uint32_t hardCorrelate(uint8_t dataByte, uint8_t wordByte) const {
-        return (dataByte >= 127 & wordByte == 255) | (dataByte < 127 & wordByte == 0);
-    }
 
     inline void hardToSoft(uint64_t UW, uint8_t* const result) {
         for(int i = 0; i < 64; i++) {
@@ -50,13 +55,36 @@ class Correlation {
         return (i >> 1) | (q << 1);
     }
 
+    // The 64 bits starting at position, the packed buffer needs one word of padding at the end
+    inline static uint64_t packedWindow(const uint64_t* packedBits, int64_t position) {
+        const uint64_t* word = packedBits + (position >> 6);
+        int shift = static_cast<int>(position & 63);
+        return (word[0] >> shift) | ((word[1] << 1) << (63 - shift));
+    }
+
+    static PackBitsFunc selectPackBits();
+    static FindSyncFunc selectFindSync();
+
+    static void packBitsGeneric(const uint8_t* softBits, int64_t size, uint64_t* packedBits);
+    static void packBitsSSE2(const uint8_t* softBits, int64_t size, uint64_t* packedBits);
+    static void packBitsAVX2(const uint8_t* softBits, int64_t size, uint64_t* packedBits);
+
+    static int64_t findSyncGeneric(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors);
+    static int64_t findSyncPOPCNT(const uint64_t* packedBits, int64_t position, int64_t end, const uint64_t* kernels, int kernelCount, int maxErrors, int& kernel, int& errors);
+
   private:
     uint64_t mSyncWord;
     bool mOqpskMode;
-    std::vector<std::vector<uint8_t>> mKernels;
+    // Packed like the soft bits, one word per rotation (and OQPSK delay)
+    std::vector<uint64_t> mKernels;
+    std::vector<uint64_t> mPackedBits;
+    PackBitsFunc mPackBits;
+    FindSyncFunc mFindSync;
 
   private:
     static constexpr uint8_t CORRELATION_LIMIT = 54;
+    // Positions searched per packed block, keeps the packed bits in the cache
+    static constexpr int64_t cSearchBlockSize = 64 * 1024;
 
   public:
     static void rotateSoftIqInPlace(uint8_t* data, uint32_t length, PhaseShift phaseShift);
@@ -66,6 +94,12 @@ class Correlation {
         i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
         return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
     }
+
+    static int countBits64(uint64_t i) {
+        i = i - ((i >> 1) & 0x5555555555555555);
+        i = (i & 0x3333333333333333) + ((i >> 2) & 0x3333333333333333);
+        return static_cast<int>((((i + (i >> 4)) & 0x0F0F0F0F0F0F0F0F) * 0x0101010101010101) >> 56);
+    }
 };
 
 #endif // CORRELATION_H
@@ -2,115 +2,266 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
-#include <vector>
+
+#include "correlation.h"
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
 
 static const int INTER_BRANCHES = 36;
 static const int INTER_DELAY = 2048;
 static const int INTER_BASE_LEN = INTER_BRANCHES * INTER_DELAY;
 
-DeInterleaver::DeInterleaver() {}
+// Output position of input i is i + (INTER_BRANCHES - 1) * INTER_DELAY - (i % INTER_BRANCHES) * INTER_BASE_LEN + (INTER_BRANCHES / 2) * INTER_BASE_LEN,
+// so an output position is final once the input is this far ahead of it
+static const int64_t MAX_LOOK_BACK = (INTER_BRANCHES / 2 - 1) * INTER_BASE_LEN - (INTER_BRANCHES - 1) * INTER_DELAY;
+static const int64_t MAX_LOOK_AHEAD = (INTER_BRANCHES - 1) * INTER_DELAY + (INTER_BRANCHES / 2) * INTER_BASE_LEN;
+// Final output is passed on in blocks of this size
+static const uint64_t EMIT_SIZE = 1 << 16;
+static const uint64_t OUTPUT_RING_SIZE = 1 << 22;
+static_assert(OUTPUT_RING_SIZE > MAX_LOOK_BACK + MAX_LOOK_AHEAD + EMIT_SIZE, "The output ring must hold every pending output position");
 
+// Input needed after the current position to decide as if the whole stream was available
+static const uint64_t FIND_SYNC_MARGIN = 80 * 5 + 8;
+static const uint64_t LOOK_AHEAD_MARGIN = 127 * 80 + 80 + 8;
+// Consumed input is dropped in blocks of this size
+static const uint64_t COMPACT_SIZE = 1 << 20;
 
-bool DeInterleaver::findSync(uint8_t* data, uint64_t len, uint32_t step, uint32_t depth, uint64_t* off, uint8_t* sync) {
-    bool result = false;
-    *off = 0;
-    for(uint64_t i = 0; i < len - step * depth; i++) {
-        *sync = byteAt(&data[i]);
-        result = true;
+// 80k stream: a sync byte every 80 soft bits, it is found where the same 8 bits repeat at the next SYNC_DEPTH steps
+static const uint64_t SYNC_STEP = 80;
+static const uint64_t SYNC_DEPTH = 4;
+// Zero words after the packed input, window reads of the sync search may go that far past the last input
+static const uint64_t PACK_PADDING_WORDS = 8;
 
-        for(uint64_t j = 1; j <= depth; j++) {
-            if(*sync != byteAt(&data[i + j * step])) {
-                result = false;
-                break;
-            }
+DeInterleaver::DeInterleaver(bool verbose)
+    : mVerbose(verbose)
+    , mInputOffset(0)
+    , mPos(0)
+    , mLocked(false)
+    , mSync(0)
+    , mPackedLength(0)
+    , mPackBits(selectPackBits())
+    , mOutput(OUTPUT_RING_SIZE, 0)
+    , mResyncedLength(0)
+    , mEmitted(0) {}
+
+void DeInterleaver::push(const uint8_t* data, uint64_t len, OutputCallback output) {
+    mInput.insert(mInput.end(), data, data + len);
+
+    resync(false, output);
+}
+
+void DeInterleaver::flush(OutputCallback output) {
+    resync(true, output);
+    emit(mResyncedLength, output);
+
+    if(mVerbose) {
+        std::cout << std::endl;
+    }
+}
+
+// Tests the candidates 57 at a time: bit n of the differences is set where the hard bit n and one SYNC_STEP multiple later differ,
+// a candidate needs 8 clear bits from it on
+bool DeInterleaver::findSync(uint64_t pos, uint64_t count, uint64_t* off, uint8_t* sync) const {
+    for(uint64_t c = 0; c < count; c += 57) {
+        const uint64_t window = packedWindow(pos + c);
+        uint64_t differences = 0;
+        for(uint64_t k = 1; k <= SYNC_DEPTH; k++) {
+            differences |= window ^ packedWindow(pos + c + k * SYNC_STEP);
         }
 
-        if(result) {
-            *off = i;
-            break;
+        const uint64_t equal = ~differences;
+        uint64_t candidates = equal;
+        for(int n = 1; n < 8; n++) {
+            candidates &= equal >> n;
+        }
+        candidates &= (uint64_t(1) << std::min<uint64_t>(57, count - c)) - 1;
+
+        if(candidates != 0) {
+            *off = c + Correlation::countBits64((candidates & (~candidates + 1)) - 1);
+            *sync = byteAt(pos + *off);
+            return true;
         }
     }
 
-    return result;
+    return false;
 }
 
-void DeInterleaver::deInterleave(uint8_t* data, uint64_t len, uint64_t* outLen) {
-    std::vector<uint8_t> src(len);
+void DeInterleaver::deInterleaveBlock(const uint8_t* src, uint64_t len) {
+    // Offset it by half a message, to capture both leading and trailing fuzz
+    const int64_t base = static_cast<int64_t>(mResyncedLength) + (INTER_BRANCHES - 1) * INTER_DELAY + (INTER_BRANCHES / 2) * INTER_BASE_LEN;
+    int64_t branch = mResyncedLength % INTER_BRANCHES;
 
-    resyncStream(data, len, outLen);
+    for(uint64_t n = 0; n < len; n++) {
+        int64_t pos = base + static_cast<int64_t>(n) - branch * INTER_BASE_LEN;
+        if(pos >= 0) {
+            mOutput[static_cast<uint64_t>(pos) & (OUTPUT_RING_SIZE - 1)] = src[n];
+        }
+        if(++branch == INTER_BRANCHES) {
+            branch = 0;
+        }
+    }
+    mResyncedLength += len;
+}
 
-    memcpy(src.data(), data, *outLen);
-    memset(data, 0, *outLen);
+void DeInterleaver::emit(uint64_t end, OutputCallback& output) {
+    while(mEmitted < end) {
+        uint64_t index = mEmitted % OUTPUT_RING_SIZE;
+        uint64_t count = std::min(end - mEmitted, OUTPUT_RING_SIZE - index);
 
-    deInterleaveBlock(src.data(), data, *outLen);
-}
+        output(&mOutput[index], count);
 
-void DeInterleaver::deInterleaveBlock(uint8_t* src, uint8_t* dst, uint64_t len) {
-    uint64_t pos;
-    for(uint64_t i = 0; i < len; i++) {
-        pos = i + (INTER_BRANCHES - 1) * INTER_DELAY - (i % INTER_BRANCHES) * INTER_BASE_LEN;
-        // Offset it by half a message, to capture both leading and trailing fuzz
-        pos += (INTER_BRANCHES / 2) * INTER_BASE_LEN;
-        if(pos >= 0 && pos < len) {
-            dst[pos] = src[i];
-        }
+        // Positions without input stay zero, like in a zero initialized output buffer
+        memset(&mOutput[index], 0, count);
+        mEmitted += count;
     }
 }
 
 // 80k stream: 00100111 36 bits 36 bits 00100111 36 bits 36 bits 00100111 ...
-void DeInterleaver::resyncStream(uint8_t* data, uint64_t len, uint64_t* outLen) {
-    std::vector<uint8_t> src(data, data + len);
+void DeInterleaver::resync(bool final, OutputCallback& output) {
+    // At the end of the stream the sync search may look past the last soft bit
+    const uint64_t len = mInput.size();
+    if(final) {
+        mInput.resize(len + FIND_SYNC_MARGIN, 0);
+    }
+    pack(mInput.size());
+    const uint8_t* src = mInput.data();
     uint64_t off;
-    uint64_t pos = 0;
     bool ok;
-    uint8_t sync;
-    *outLen = 0;
 
-    while(pos < len - 80 * 4) {
-        if(!findSync(&src.data()[pos], 80 * 5, 80, 4, &off, &sync)) {
-            pos += 80 * 3;
-            continue;
-        }
+    while(true) {
+        if(!mLocked) {
+            if(final ? (mPos + 80 * 4 >= len) : (mPos + FIND_SYNC_MARGIN > len)) {
+                break;
+            }
 
-        std::cout << std::fixed << std::setprecision(2) << ((float)pos / len) * 100 << "% Found sync at " << pos << "\t\t\t\r" << std::flush;
+            if(!findSync(mPos, SYNC_STEP, &off, &mSync)) {
+                mPos += 80 * 3;
+                continue;
+            }
 
-        pos += off;
+            if(mVerbose) {
+                std::cout << "Found sync at " << mInputOffset + mPos << "\t\t\t\r" << std::flush;
+            }
+
+            mPos += off;
+            mLocked = true;
+        }
 
-        while(pos < len - 80) {
+        if(final ? (mPos + 80 >= len) : (mPos + LOOK_AHEAD_MARGIN > len)) {
+            if(!final) {
+                break;
+            }
+            ok = false;
+        } else {
             // Look ahead to prevent it losing sync on weak signal
             ok = false;
             for(int i = 0; i < 128; i++) {
-                if(pos + i * 80 < len - 80) {
-                    if(byteAt(&src.data()[pos + i * 80]) == sync) {
+                if(mPos + i * 80 < len - 80) {
+                    if(byteAt(mPos + i * 80) == mSync) {
                         ok = true;
                         break;
                     }
                 }
             }
+        }
 
-            if(!ok) {
-                break;
+        if(!ok) {
+            if(mVerbose) {
+                std::cout << "Sync lost at " << mInputOffset + mPos << "\t\t\t\r" << std::flush;
             }
+            mLocked = false;
+            continue;
+        }
+
+        deInterleaveBlock(&src[mPos + 8], 72);
+        mPos += 80;
 
-            memcpy(&data[*outLen], &src.data()[pos + 8], 72);
-            pos += 80;
-            *outLen += 72;
+        if(mResyncedLength >= mEmitted + MAX_LOOK_BACK + EMIT_SIZE) {
+            emit(mResyncedLength - MAX_LOOK_BACK, output);
         }
+    }
 
-        std::cout << std::fixed << std::setprecision(2) << ((float)pos / len) * 100 << "% Sync lost at " << pos << "\t\t\t\r" << std::flush;
+    if(final) {
+        mInput.resize(len);
+        mPackedLength = std::min(mPackedLength, len & ~uint64_t(63));
     }
 
-    std::cout << std::endl;
+    // Whole packed words are dropped with the input
+    if(mPos >= COMPACT_SIZE) {
+        uint64_t consumed = std::min<uint64_t>(mPos, mInput.size()) & ~uint64_t(63);
+        mInput.erase(mInput.begin(), mInput.begin() + consumed);
+        mPackedBits.erase(mPackedBits.begin(), mPackedBits.begin() + consumed / 64);
+        mPackedLength -= consumed;
+        mInputOffset += consumed;
+        mPos -= consumed;
+    }
 }
 
-uint8_t DeInterleaver::byteAt(uint8_t* data) {
-    uint8_t result = 0;
+// Packs the input up to len, the last partial word is packed again with the next input
+void DeInterleaver::pack(uint64_t len) {
+    const uint64_t fullWords = len / 64;
+    const uint64_t packedWords = mPackedLength / 64;
 
-    for(int i = 0; i < 8; i++) {
-        result = result | (data[i] < 128 ? 0 : 1) << i;
+    mPackedBits.resize(fullWords + 1 + PACK_PADDING_WORDS, 0);
+    if(fullWords > packedWords) {
+        mPackBits(&mInput[packedWords * 64], fullWords - packedWords, &mPackedBits[packedWords]);
     }
 
-    return result;
+    uint64_t partial = 0;
+    for(uint64_t i = fullWords * 64; i < len; i++) {
+        partial |= static_cast<uint64_t>(mInput[i] >= 128) << (i & 63);
+    }
+    mPackedBits[fullWords] = partial;
+    mPackedLength = fullWords * 64;
 }
+
+DeInterleaver::PackBitsFunc DeInterleaver::selectPackBits() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        return packBitsSSE2;
+    }
+#endif
+
+    (void)cpu;
+    return packBitsGeneric;
+}
+
+void DeInterleaver::packBitsGeneric(const uint8_t* softBits, uint64_t words, uint64_t* packedBits) {
+    for(uint64_t w = 0; w < words; w++) {
+        uint64_t word = 0;
+        for(int n = 0; n < 64; n++) {
+            word |= static_cast<uint64_t>(softBits[w * 64 + n] >= 128) << n;
+        }
+        packedBits[w] = word;
+    }
+}
+
+#if defined(CPU_X86)
+
+// soft >= 128 is the sign bit of the byte, movemask collects it directly
+TARGET_SSE2 void DeInterleaver::packBitsSSE2(const uint8_t* softBits, uint64_t words, uint64_t* packedBits) {
+    for(uint64_t w = 0; w < words; w++) {
+        uint64_t word = 0;
+        for(int n = 0; n < 4; n++) {
+            __m128i soft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(softBits + w * 64 + n * 16));
+            word |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(soft))) << (n * 16);
+        }
+        packedBits[w] = word;
+    }
+}
+
+#else
+
+void DeInterleaver::packBitsSSE2(const uint8_t* softBits, uint64_t words, uint64_t* packedBits) {
+    packBitsGeneric(softBits, words, packedBits);
+}
+
+#endif
@@ -3,18 +3,67 @@
 
 #include <stdint.h>
 
+#include <functional>
+#include <vector>
+
+// Resynchronizes and deinterleaves the 80k stream incrementally, the memory use does not depend on the length of the stream
 class DeInterleaver {
-  private:
-    DeInterleaver();
+  public:
+    typedef std::function<void(const uint8_t* softBits, uint64_t length)> OutputCallback;
 
   public:
-    static void deInterleave(uint8_t* data, uint64_t len, uint64_t* outLen);
+    // verbose: prints the sync state
+    explicit DeInterleaver(bool verbose = true);
+
+    // Consumes len soft bits, the deinterleaved soft bits are passed to output as soon as they are final
+    void push(const uint8_t* data, uint64_t len, OutputCallback output);
+    // End of the stream, outputs the rest
+    void flush(OutputCallback output);
 
   private:
-    static bool findSync(uint8_t* data, uint64_t len, uint32_t step, uint32_t depth, uint64_t* off, uint8_t* sync);
-    static void deInterleaveBlock(uint8_t* src, uint8_t* dst, uint64_t len);
-    static void resyncStream(uint8_t* data, uint64_t len, uint64_t* outLen);
-    static uint8_t byteAt(uint8_t* data);
+    // Hard decisions of words * 64 soft bits, bit n of the stream is bit (n % 64) of word n / 64
+    typedef void (*PackBitsFunc)(const uint8_t* softBits, uint64_t words, uint64_t* packedBits);
+
+  private:
+    void resync(bool final, OutputCallback& output);
+    void pack(uint64_t len);
+    void deInterleaveBlock(const uint8_t* src, uint64_t len);
+    void emit(uint64_t end, OutputCallback& output);
+    bool findSync(uint64_t pos, uint64_t count, uint64_t* off, uint8_t* sync) const;
+
+    // The 64 hard bits from input position pos on
+    inline uint64_t packedWindow(uint64_t pos) const {
+        const uint64_t* word = &mPackedBits[pos >> 6];
+        int shift = static_cast<int>(pos & 63);
+        return (word[0] >> shift) | ((word[1] << 1) << (63 - shift));
+    }
+
+    inline uint8_t byteAt(uint64_t pos) const {
+        return static_cast<uint8_t>(packedWindow(pos));
+    }
+
+    static PackBitsFunc selectPackBits();
+    static void packBitsGeneric(const uint8_t* softBits, uint64_t words, uint64_t* packedBits);
+    static void packBitsSSE2(const uint8_t* softBits, uint64_t words, uint64_t* packedBits);
+
+  private:
+    bool mVerbose;
+
+    // Not yet resynchronized input, mInput[0] is at mInputOffset in the stream
+    std::vector<uint8_t> mInput;
+    uint64_t mInputOffset;
+    uint64_t mPos;
+    bool mLocked;
+    uint8_t mSync;
+    // Hard decisions of mInput, the words up to mPackedLength are final
+    std::vector<uint64_t> mPackedBits;
+    uint64_t mPackedLength;
+    PackBitsFunc mPackBits;
+
+    // Deinterleaved output waiting for its last input, indexed by output position modulo the size
+    std::vector<uint8_t> mOutput;
+    uint64_t mResyncedLength;
+    uint64_t mEmitted;
 };
 
 #endif // DEINTERLEAVER_H
@@ -1,82 +1,270 @@
 #include "meteordecoder.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 
-MeteorDecoder::MeteorDecoder(bool deInterleave, bool oqpsk, bool differentialDecode)
+MeteorDecoder::MeteorDecoder(bool deInterleave, bool oqpsk, bool differentialDecode, int threads)
     : mDeInterleave(deInterleave)
     , mDifferentialDecode(differentialDecode)
-    , mCorrelation(differentialDecode ? sSynchWordOQPSK : sSynchWordQPSK, oqpsk) {}
+    , mVerbose(true)
+    , mStatistics(nullptr)
+    , mCorrelation(differentialDecode ? sSynchWordOQPSK : sSynchWordQPSK, oqpsk)
+    , mRotate(BitKernels::selectRotate())
+    , mXor(BitKernels::selectXor())
+    , mWindowOffset(0)
+    , mSearchPosition(0)
+    , mInChain(false)
+    , mChainPosition(0)
+    , mProcessedBits(0)
+    , mChainPhaseShift(0)
+    , mBatchSize(1)
+    , mDecodedPackets(0)
+    , mSyncWordFound(0) {
 
-size_t MeteorDecoder::decode(uint8_t* softBits, size_t length, std::function<void(const uint8_t* cadu, std::size_t size)> callback) {
-    size_t decodedPacketCounter = 0;
-    size_t syncWordFound = 0;
+    for(size_t i = 0; i < sizeof(mDerandomizePattern); i++) {
+        mDerandomizePattern[i] = PRAND[i % sizeof(PRAND)];
+    }
+
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(int i = 0; i < threads; i++) {
+        mFrameDecoders.push_back(std::make_unique<FrameDecoder>());
+    }
+    mFrames.resize(threads * cFramesPerThread);
+
+    if(threads > 1) {
+        mThreadPool = std::make_unique<ThreadPool>(threads);
+        mThreadPool->start();
+    }
+}
 
+size_t MeteorDecoder::decode(uint8_t* softBits, size_t length, CaduCallback callback) {
+    start(callback);
+    decode(softBits, length);
+    return finish();
+}
+
+void MeteorDecoder::start(CaduCallback callback) {
+    mCallback = callback;
+    mWindow.clear();
+    mWindowOffset = 0;
+    mSearchPosition = 0;
+    mInChain = false;
+    mDecodedPackets = 0;
+    mSyncWordFound = 0;
+
+    mDeInterleaver.reset();
     if(mDeInterleave) {
-        std::cout << "Deinterleaving..." << std::endl;
-        uint64_t outLen = 0;
-        DeInterleaver::deInterleave(softBits, length, &outLen);
-        length = outLen;
+        if(mVerbose) {
+            std::cout << "Deinterleaving..." << std::endl;
+        }
+        mDeInterleaver = std::make_unique<DeInterleaver>(mVerbose);
     }
+}
 
-    mCorrelation.correlate(softBits, length, [&softBits, length, &decodedPacketCounter, &syncWordFound, &callback, this](Correlation::CorellationResult correlationResult, Correlation::PhaseShift phaseShift) {
-        bool packetOk;
-        uint32_t processedBits = 0;
+void MeteorDecoder::decode(const uint8_t* softBits, size_t length) {
+    auto start = std::chrono::steady_clock::now();
 
-        do {
-            syncWordFound++;
+    if(mDeInterleaver) {
+        mDeInterleaver->push(softBits, length, [this](const uint8_t* deInterleaved, uint64_t deInterleavedLength) {
+            append(deInterleaved, deInterleavedLength);
+        });
+    } else {
+        append(softBits, length);
+    }
 
-            if(length - (correlationResult.pos + processedBits) < 16384) {
-                return processedBits;
-            }
+    if(mStatistics) {
+        mStatistics->decoder.add(length, start);
+    }
+}
 
-            std::copy(&softBits[correlationResult.pos + processedBits], &softBits[correlationResult.pos + processedBits] + 16384, mDataTodecode);
+size_t MeteorDecoder::finish() {
+    auto start = std::chrono::steady_clock::now();
 
-            mCorrelation.rotateSoftIqInPlace(mDataTodecode, 16384, phaseShift);
+    if(mDeInterleaver) {
+        mDeInterleaver->flush([this](const uint8_t* deInterleaved, uint64_t deInterleavedLength) {
+            append(deInterleaved, deInterleavedLength);
+        });
+    }
 
-            mViterbi.decodeSoft(mDataTodecode, mViterbiResult, 16384);
+    // Frames and sync words that were waiting for more soft bits are handled with the end of the stream
+    process(true);
 
-            if(mDifferentialDecode) {
-                differentialDecode(mViterbiResult, 1024);
-            }
+    if(mStatistics) {
+        mStatistics->decoder.add(0, start);
+    }
 
-            uint32_t last_sync_ = *reinterpret_cast<uint32_t*>(mViterbiResult);
+    if(mVerbose) {
+        std::cout << std::endl;
+    }
 
-            for(int j = 0; j < 1024 - 4; j++) {
-                mViterbiResult[j + 4] = mViterbiResult[j + 4] ^ PRAND[j % 255];
-            }
+    return mDecodedPackets;
+}
 
-            if(mViterbiResult[9] == 0xFF) {
-                for(int i = 0; i < 1024; i++) {
-                    mViterbiResult[i] ^= 0xFF;
-                }
-            }
+void MeteorDecoder::append(const uint8_t* softBits, size_t length) {
+    mWindow.insert(mWindow.end(), softBits, softBits + length);
+    process(false);
+}
 
-            for(int i = 0; i < 4; i++) {
-                mReedSolomon.deinterleave(mViterbiResult + 4, i, 4);
-                rsResult[i] = mReedSolomon.decode();
-                mReedSolomon.interleave(mDecodedPacket + 4, i, 4);
+void MeteorDecoder::process(bool final) {
+    while(true) {
+        if(mInChain) {
+            if(!continueChain(final)) {
+                break;
             }
+            continue;
+        }
+
+        // The correlator needs 64 soft bits after a position
+        if(mSearchPosition + 64 >= mWindowOffset + mWindow.size()) {
+            break;
+        }
 
-            std::cout << "SyncWordFound:" << syncWordFound << " | Decoded Packets:" << decodedPacketCounter << " | Current Pos:" << (correlationResult.pos + processedBits) << " | Phase:" << phaseShift << " | synch:" << std::hex
-                      << last_sync_ << " | BER: " << mViterbi.getLastBER() << " | RS: (" << std::dec << rsResult[0] << ", " << rsResult[1] << ", " << rsResult[2] << ", " << rsResult[3] << ")"
+        Correlation::CorellationResult correlationResult;
+        int64_t end = static_cast<int64_t>(mWindow.size()) - 64;
+        int64_t found = mCorrelation.findSync(mWindow.data(), mWindow.size(), mSearchPosition - mWindowOffset, correlationResult, mChainPhaseShift);
+        if(found >= end) {
+            mSearchPosition = mWindowOffset + end;
+            break;
+        }
+
+        mInChain = true;
+        mChainPosition = mWindowOffset + found;
+        if(mStatistics) {
+            mStatistics->syncWords++;
+        }
+        mProcessedBits = 0;
+        mBatchSize = 1;
+    }
+
+    // Drop the consumed soft bits once they are at least half of the window, keeps the copying linear
+    uint64_t consumed = (mInChain ? mChainPosition + mProcessedBits : mSearchPosition) - mWindowOffset;
+    if(consumed >= cCompactSize && consumed * 2 >= mWindow.size()) {
+        mWindow.erase(mWindow.begin(), mWindow.begin() + consumed);
+        mWindowOffset += consumed;
+    }
+}
+
+bool MeteorDecoder::continueChain(bool final) {
+    uint64_t position = mChainPosition + mProcessedBits;
+    int count = static_cast<int>(std::min<uint64_t>(mBatchSize, (mWindowOffset + mWindow.size() - position) / cFrameBits));
+
+    if(count == 0) {
+        if(!final) {
+            return false;
+        }
+        mSyncWordFound++;
+        endChain(mProcessedBits);
+        return true;
+    }
+
+    // Frames following a sync word are decoded in parallel batches before their results are known,
+    // the results are consumed in stream order and everything after the first failed frame is dropped
+    decodeFrames(&mWindow[position - mWindowOffset], mChainPhaseShift, count);
+
+    for(int i = 0; i < count; i++) {
+        const Frame& frame = mFrames[i];
+        mSyncWordFound++;
+        addStatistics(frame);
+
+        if(mVerbose) {
+            std::cout << "SyncWordFound:" << mSyncWordFound << " | Decoded Packets:" << mDecodedPackets << " | Current Pos:" << (mChainPosition + mProcessedBits) << " | Phase:" << mChainPhaseShift << " | synch:" << std::hex << frame.syncWord
+                      << " | BER: " << frame.ber << " | RS: (" << std::dec << frame.rsResult[0] << ", " << frame.rsResult[1] << ", " << frame.rsResult[2] << ", " << frame.rsResult[3] << ")"
                       << "\t\t\r";
+        }
 
-            packetOk = (rsResult[0] != -1) && (rsResult[1] != -1) && (rsResult[2] != -1) && (rsResult[3] != -1);
+        if(!frame.ok) {
+            endChain((mProcessedBits > 0) ? mProcessedBits - 1 : 0);
+            return true;
+        }
+
+        mCallback(frame.packet, sizeof(frame.packet));
+        mDecodedPackets++;
+        mProcessedBits += cFrameBits;
+    }
+
+    // Start with a single frame, a sync word without a decodable frame after it wastes no work
+    mBatchSize = std::min<int>(mBatchSize * 2, mFrames.size());
+    return true;
+}
+
+void MeteorDecoder::addStatistics(const Frame& frame) {
+    if(!mStatistics) {
+        return;
+    }
+
+    mStatistics->frames++;
+    mStatistics->packets += frame.ok ? 1 : 0;
+    mStatistics->ber.add(frame.ber);
+    for(int result : frame.rsResult) {
+        if(result < 0) {
+            mStatistics->rsFailures++;
+        } else {
+            mStatistics->rsCorrections.add(result);
+        }
+    }
+}
 
-            if(packetOk) {
-                std::copy(mViterbiResult, mViterbiResult + 4, mDecodedPacket);
-                callback(mDecodedPacket, sizeof(mDecodedPacket));
-                decodedPacketCounter++;
-                processedBits += 16384;
+// The sync search continues skip + 1 soft bits after the sync word of the chain
+void MeteorDecoder::endChain(uint32_t skip) {
+    mSearchPosition = mChainPosition + skip + 1;
+    mInChain = false;
+}
+
+void MeteorDecoder::decodeFrames(const uint8_t* softBits, Correlation::PhaseShift phaseShift, int count) {
+    if(!mThreadPool || count == 1) {
+        for(int i = 0; i < count; i++) {
+            decodeFrame(*mFrameDecoders[0], softBits + i * cFrameBits, phaseShift, mFrames[i]);
+        }
+        return;
+    }
+
+    // Every worker owns a decoder and takes the next undecoded frame until none is left
+    std::atomic<int> nextFrame(0);
+    int workers = std::min<int>(count, mFrameDecoders.size());
+    for(int worker = 0; worker < workers; worker++) {
+        mThreadPool->addJob([this, worker, softBits, phaseShift, count, &nextFrame]() {
+            FrameDecoder& frameDecoder = *mFrameDecoders[worker];
+            int i;
+            while((i = nextFrame++) < count) {
+                decodeFrame(frameDecoder, softBits + i * cFrameBits, phaseShift, mFrames[i]);
             }
-        } while(packetOk);
+        });
+    }
+    mThreadPool->waitForAllJobsDone();
+}
+
+void MeteorDecoder::decodeFrame(FrameDecoder& frameDecoder, const uint8_t* softBits, Correlation::PhaseShift phaseShift, Frame& frame) const {
+    uint8_t* viterbiResult = frameDecoder.viterbiResult;
 
-        return (processedBits > 0) ? processedBits - 1 : 0;
-    });
+    mRotate(softBits, frameDecoder.dataTodecode, cFrameBits, phaseShift);
 
-    std::cout << std::endl;
+    frameDecoder.viterbi.decodeSoft(frameDecoder.dataTodecode, viterbiResult, cFrameBits);
+    frame.ber = frameDecoder.viterbi.getLastBER();
 
-    return decodedPacketCounter;
+    if(mDifferentialDecode) {
+        differentialDecode(viterbiResult, 1024);
+    }
+
+    frame.syncWord = *reinterpret_cast<uint32_t*>(viterbiResult);
+
+    // The whole CADU is inverted when the derandomized byte 9 is 0xFF, done in the same pass
+    uint8_t invert = ((viterbiResult[9] ^ mDerandomizePattern[5]) == 0xFF) ? 0xFF : 0x00;
+    mXor(viterbiResult + 4, mDerandomizePattern, invert, sizeof(mDerandomizePattern));
+    for(int i = 0; i < 4; i++) {
+        viterbiResult[i] ^= invert;
+    }
+
+    frameDecoder.reedSolomon.decodeInterleaved(viterbiResult + 4, frame.packet + 4, frame.rsResult);
+
+    frame.ok = (frame.rsResult[0] != -1) && (frame.rsResult[1] != -1) && (frame.rsResult[2] != -1) && (frame.rsResult[3] != -1);
+    if(frame.ok) {
+        std::copy(viterbiResult, viterbiResult + 4, frame.packet);
+    }
 }
 
 void MeteorDecoder::differentialDecode(uint8_t* data, int64_t len) {
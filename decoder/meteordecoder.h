@@ -5,10 +5,15 @@
 
 #include <cmath>
 #include <functional>
+#include <memory>
+#include <vector>
 
+#include "bitkernels.h"
 #include "correlation.h"
 #include "deinterleaver.h"
+#include "passstatistics.h"
 #include "reedsolomon.h"
+#include "threadpool.h"
 #include "viterbi.h"
 
 class MeteorDecoder {
@@ -23,26 +28,97 @@ class MeteorDecoder {
            0xac, 0x7f, 0xa4, 0x07, 0x60, 0x4d, 0x06, 0xb8, 0x5e, 0x47, 0x16, 0x49, 0xd6, 0xd3, 0xdb, 0xa3, 0x67, 0x2d, 0x4b, 0xbe, 0xe6, 0x19, 0x51, 0x5f, 0x9f, 0x05, 0x08, 0x78, 0xc4, 0x4a, 0x66, 0xf5, 0x58};
 
 
+  public:
+    typedef std::function<void(const uint8_t* cadu, std::size_t size)> CaduCallback;
+
   public:
     MeteorDecoder() = delete;
-    MeteorDecoder(bool deInterleave, bool oqpsk, bool differentialDecode);
+    // threads: number of frames decoded in parallel, 0 uses all cores
+    MeteorDecoder(bool deInterleave, bool oqpsk, bool differentialDecode, int threads = 0);
+
+    // Decodes a whole soft bit buffer, returns the number of decoded packets
+    size_t decode(uint8_t* softBits, size_t length, CaduCallback callback);
+
+    // Streaming interface: start(), decode() with chunks of any size as they arrive, finish() at the end of the stream.
+    // Only the soft bits from the current frame or sync search position on are kept.
+    void start(CaduCallback callback);
+    void decode(const uint8_t* softBits, size_t length);
+    size_t finish();
 
-    size_t decode(uint8_t* softBits, size_t length, std::function<void(const uint8_t* cadu, std::size_t size)> callback);
+    // Progress of the sync search and the frames on the console, on by default
+    void setVerbose(bool verbose) {
+        mVerbose = verbose;
+    }
+
+    // Frame counters, BER and RS histograms and the decoding time are added to statistics, nullptr turns it off
+    void setStatistics(PassStatistics* statistics) {
+        mStatistics = statistics;
+    }
+
+  private:
+    // Viterbi and Reed-Solomon state of one worker thread
+    struct FrameDecoder {
+        uint8_t dataTodecode[16384];
+        uint8_t viterbiResult[1024];
+        Viterbi viterbi;
+        ReedSolomon reedSolomon;
+    };
+
+    struct Frame {
+        uint8_t packet[1024];
+        uint32_t syncWord;
+        float ber;
+        int rsResult[4];
+        bool ok;
+    };
+
+  private:
+    void append(const uint8_t* softBits, size_t length);
+    void process(bool final);
+    bool continueChain(bool final);
+    void endChain(uint32_t skip);
+    void addStatistics(const Frame& frame);
+    void decodeFrame(FrameDecoder& frameDecoder, const uint8_t* softBits, Correlation::PhaseShift phaseShift, Frame& frame) const;
+    void decodeFrames(const uint8_t* softBits, Correlation::PhaseShift phaseShift, int count);
+    static void differentialDecode(uint8_t* data, int64_t len);
 
   private:
     bool mDeInterleave;
     bool mDifferentialDecode;
-    uint8_t mDataTodecode[16384];
-    uint8_t mViterbiResult[1024];
-    uint8_t mDecodedPacket[1024];
-    uint16_t mIntSqrtTable[32768];
-    int rsResult[4];
+    bool mVerbose;
+    PassStatistics* mStatistics;
     Correlation mCorrelation;
-    Viterbi mViterbi;
-    ReedSolomon mReedSolomon;
+    BitKernels::RotateFunc mRotate;
+    BitKernels::XorFunc mXor;
+    // PRAND repeated over the 1020 bytes after the sync word
+    uint8_t mDerandomizePattern[1020];
+    std::vector<std::unique_ptr<FrameDecoder>> mFrameDecoders;
+    std::vector<Frame> mFrames;
+    std::unique_ptr<ThreadPool> mThreadPool;
+    std::unique_ptr<DeInterleaver> mDeInterleaver;
+    CaduCallback mCallback;
+
+    // Soft bits not consumed yet, mWindow[0] is at mWindowOffset in the stream
+    std::vector<uint8_t> mWindow;
+    uint64_t mWindowOffset;
+    uint64_t mSearchPosition;
+
+    // Consecutive frames after a sync word
+    bool mInChain;
+    uint64_t mChainPosition;
+    uint32_t mProcessedBits;
+    Correlation::PhaseShift mChainPhaseShift;
+    int mBatchSize;
+
+    size_t mDecodedPackets;
+    size_t mSyncWordFound;
 
   private:
-    void differentialDecode(uint8_t* data, int64_t len);
+    static constexpr uint32_t cFrameBits = 16384;
+    // Consecutive frames decoded speculatively per worker after a sync word, the chain usually continues for thousands of frames
+    static constexpr int cFramesPerThread = 4;
+    // Consumed soft bits are dropped from the window in blocks of at least this size
+    static constexpr uint64_t cCompactSize = 1024 * 1024;
 
   private:
     static constexpr uint64_t sSynchWordQPSK = 0xFCA2B63DB00D9794U;
@@ -0,0 +1,71 @@
+#include "modedetector.h"
+
+#include <algorithm>
+#include <thread>
+
+ModeDetector::ModeDetector(int threads)
+    : mThreadPool(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    , mProbedLength(0) {
+
+    for(int i = 0; i < 8; i++) {
+        Candidate candidate;
+        candidate.mode.oqpsk = (i & 4) != 0;
+        candidate.mode.differentialDecode = (i & 2) != 0;
+        candidate.mode.deInterleave = (i & 1) != 0;
+        candidate.decodedPackets = 0;
+        mCandidates.push_back(candidate);
+    }
+
+    // A candidate is decoded by one worker, they run side by side
+    for(size_t i = 0; i < mCandidates.size(); i++) {
+        const Mode& mode = mCandidates[i].mode;
+        auto decoder = std::make_unique<MeteorDecoder>(mode.deInterleave, mode.oqpsk, mode.differentialDecode, 1);
+        decoder->setVerbose(false);
+        decoder->start([this, i](const uint8_t*, std::size_t) {
+            mCandidates[i].decodedPackets++;
+        });
+        mDecoders.push_back(std::move(decoder));
+    }
+
+    mThreadPool.start();
+}
+
+bool ModeDetector::push(const uint8_t* softBits, size_t length) {
+    runAll([softBits, length](MeteorDecoder& decoder) {
+        decoder.decode(softBits, length);
+    });
+    mProbedLength += length;
+
+    if(mProbedLength >= cMaxProbeLength) {
+        return true;
+    }
+    return mProbedLength >= cProbeLength && best().decodedPackets >= cMinPackets;
+}
+
+bool ModeDetector::finish(Mode& mode) {
+    runAll([](MeteorDecoder& decoder) {
+        decoder.finish();
+    });
+    mThreadPool.stop();
+
+    const Candidate& candidate = best();
+    mode = candidate.mode;
+    return candidate.decodedPackets > 0;
+}
+
+void ModeDetector::runAll(const std::function<void(MeteorDecoder& decoder)>& job) {
+    for(auto& decoder : mDecoders) {
+        MeteorDecoder* candidateDecoder = decoder.get();
+        mThreadPool.addJob([&job, candidateDecoder]() {
+            job(*candidateDecoder);
+        });
+    }
+    mThreadPool.waitForAllJobsDone();
+}
+
+// On a tie the simpler configuration wins, the candidates are ordered that way
+const ModeDetector::Candidate& ModeDetector::best() const {
+    return *std::max_element(mCandidates.begin(), mCandidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.decodedPackets < b.decodedPackets;
+    });
+}
@@ -0,0 +1,64 @@
+#ifndef MODEDETECTOR_H
+#define MODEDETECTOR_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "meteordecoder.h"
+#include "threadpool.h"
+
+// Finds the decoder configuration of a soft bit stream: the first seconds are decoded with every combination of
+// QPSK / OQPSK, differential decoding and deinterleaving in parallel, the one with the most Reed-Solomon corrected packets wins
+class ModeDetector {
+  public:
+    struct Mode {
+        bool oqpsk;
+        bool differentialDecode;
+        bool deInterleave;
+    };
+
+    struct Candidate {
+        Mode mode;
+        size_t decodedPackets;
+    };
+
+  public:
+    // threads: number of candidates decoded in parallel, 0 uses all cores
+    explicit ModeDetector(int threads = 0);
+
+    // Feeds the next soft bits to every candidate, returns true once enough soft bits were probed
+    bool push(const uint8_t* softBits, size_t length);
+    // Ends the probe, mode is the best candidate. Returns false if no candidate decoded a packet.
+    bool finish(Mode& mode);
+
+    const std::vector<Candidate>& getCandidates() const {
+        return mCandidates;
+    }
+
+    uint64_t getProbedLength() const {
+        return mProbedLength;
+    }
+
+  private:
+    void runAll(const std::function<void(MeteorDecoder& decoder)>& job);
+    const Candidate& best() const;
+
+  private:
+    std::vector<Candidate> mCandidates;
+    std::vector<std::unique_ptr<MeteorDecoder>> mDecoders;
+    ThreadPool mThreadPool;
+    uint64_t mProbedLength;
+
+  private:
+    // 72000 symbols per second, 2 soft bits per symbol
+    static constexpr uint64_t cSoftBitsPerSecond = 144000;
+    // A deinterleaved stream only gives complete frames after about 18 seconds, the interleaver spreads the bits of a frame that far
+    static constexpr uint64_t cProbeLength = 30 * cSoftBitsPerSecond;
+    // The pass may start with noise, the probe is extended until a candidate decodes this many packets or up to the maximum
+    static constexpr size_t cMinPackets = 16;
+    static constexpr uint64_t cMaxProbeLength = 180 * cSoftBitsPerSecond;
+};
+
+#endif // MODEDETECTOR_H
@@ -19,6 +19,10 @@ class Decoder : public msumr::Image {
     static std::string serialNumberToSatName(uint8_t serialNumber);
 
   public:
+    // threads: MSU-MR segments decoded in parallel, see msumr::Image
+    explicit Decoder(int threads = 1)
+        : msumr::Image(threads) {}
+
     void process(const uint8_t* cadu);
 
   public:
@@ -8,34 +8,33 @@ namespace msumr {
 BitIOConst::BitIOConst(const uint8_t* bytes, uint32_t size)
     : mpBytes(bytes)
     , mSize(size)
-    , mPos(0) {}
+    , mPos(0)
+    , mBuffer(0)
+    , mBitCount(0) {}
 
-uint32_t BitIOConst::peekBits(int n) {
-    uint32_t result = 0;
-    int bit = 0;
-    for(int i = 0; i < n; i++) {
-        int p = mPos + i;
-        if((p >> 3) < mSize) {
-            bit = (mpBytes[p >> 3] >> (7 - (p & 7))) & 1;
-        } else {
-            bit = 0;
-        }
-        result = (result << 1) | bit;
-    }
-    return result;
-}
+void BitIOConst::refill() {
+    if(mPos + 8 <= mSize) {
+        // Compilers turn this into a single big-endian load
+        const uint8_t* p = mpBytes + mPos;
+        uint64_t word = static_cast<uint64_t>(p[0]) << 56 | static_cast<uint64_t>(p[1]) << 48 | static_cast<uint64_t>(p[2]) << 40 | static_cast<uint64_t>(p[3]) << 32 |
+                        static_cast<uint64_t>(p[4]) << 24 | static_cast<uint64_t>(p[5]) << 16 | static_cast<uint64_t>(p[6]) << 8 | p[7];
 
-void BitIOConst::advanceBits(int n) {
-    mPos += n;
-}
+        // Whole bytes are taken below the valid bits, the rest of the word only repeats stream bits
+        mBuffer |= word >> mBitCount;
+        mPos += (63 - mBitCount) >> 3;
+        mBitCount |= 56;
+        return;
+    }
 
-uint32_t BitIOConst::fetchBits(int n) {
-    uint32_t result = peekBits(n);
-    advanceBits(n);
-    return result;
+    while(mBitCount <= 56) {
+        uint64_t byte = mPos < mSize ? mpBytes[mPos] : 0;
+        mBuffer |= byte << (56 - mBitCount);
+        mPos++;
+        mBitCount += 8;
+    }
 }
 
 } // namespace msumr
 } // namespace lrpt
 } // namespace protocol
-} // namespace decoder
\ No newline at end of file
+} // namespace decoder
@@ -9,18 +9,48 @@ namespace protocol {
 namespace lrpt {
 namespace msumr {
 
+// MSB first bit reader, reading past the end gives zero bits
 class BitIOConst {
   public:
     BitIOConst(const uint8_t* bytes, uint32_t size);
 
-    uint32_t peekBits(int n);
-    void advanceBits(int n);
-    uint32_t fetchBits(int n);
+    // n: 0-32
+    uint32_t peekBits(int n) {
+        if(mBitCount < n) {
+            refill();
+        }
+        // Shifted in two steps, n = 0 would shift by 64
+        return static_cast<uint32_t>((mBuffer >> 1) >> (63 - n));
+    }
+
+    // n: 0-32
+    void advanceBits(int n) {
+        if(mBitCount < n) {
+            refill();
+        }
+        mBuffer <<= n;
+        mBitCount -= n;
+    }
+
+    // n: 0-32
+    uint32_t fetchBits(int n) {
+        uint32_t result = peekBits(n);
+        mBuffer <<= n;
+        mBitCount -= n;
+        return result;
+    }
+
+  private:
+    // Tops mBuffer up to at least 57 bits
+    void refill();
 
   private:
     const uint8_t* mpBytes;
     uint32_t mSize;
     uint32_t mPos;
+    // The next mBitCount bits of the stream from the MSB, the bits below them are zero or the stream bits that follow
+    uint64_t mBuffer;
+    int mBitCount;
 };
 
 
@@ -0,0 +1,439 @@
+#include "idct.h"
+
+#include <cmath>
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace decoder {
+namespace protocol {
+namespace lrpt {
+namespace msumr {
+namespace IdctKernels {
+
+// Rotation constants of the AAN odd part: sqrt(2), 2*cos(pi/8), 2*(cos(pi/8) - cos(3pi/8)), 2*(cos(pi/8) + cos(3pi/8))
+static constexpr float cSqrt2 = 1.414213562f;
+static constexpr float cC2 = 1.847759065f;
+static constexpr float cC2MinusC6 = 1.082392200f;
+static constexpr float cC2PlusC6 = 2.613125930f;
+
+// Tables of the direct transform, evaluated in the same order as the former Image::filtIdct8x8 to give the same pixels
+struct ReferenceTables {
+    float cosine[8][8];
+    float alpha[8];
+
+    ReferenceTables() {
+        for(int y = 0; y < 8; y++) {
+            for(int x = 0; x < 8; x++) {
+                cosine[y][x] = cos(M_PI / 16 * (2 * y + 1) * x);
+            }
+        }
+        for(int x = 0; x < 8; x++) {
+            alpha[x] = (x == 0) ? 1.0f / std::sqrt(2.0f) : 1.0f;
+        }
+    }
+};
+
+void fillQuantizationTable(const std::array<int, 64>& steps, QuantizationTable& table) {
+    // AAN scale factor k is cos(k * pi / 16) * sqrt(2), 1 for k = 0
+    double scales[8];
+    for(int k = 0; k < 8; k++) {
+        scales[k] = k == 0 ? 1.0 : std::cos(k * M_PI / 16) * std::sqrt(2.0);
+    }
+
+    for(int i = 0; i < 64; i++) {
+        table.steps[i] = static_cast<float>(steps[i]);
+        table.scaledSteps[i] = static_cast<float>(steps[i] * scales[i / 8] * scales[i % 8] / 8.0);
+    }
+}
+
+IdctFunc selectIdct() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return idctAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return idctSSE2;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return idctNEON;
+    }
+#endif
+
+    (void)cpu;
+    return idctGeneric;
+}
+
+static inline uint8_t toPixel(float value) {
+    int pixel = static_cast<int>(std::round(value + 128.0f));
+    return static_cast<uint8_t>(pixel < 0 ? 0 : (pixel > 255 ? 255 : pixel));
+}
+
+void idctReference(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    static const ReferenceTables tables;
+    const auto& alpha = tables.alpha;
+    const auto& cosine = tables.cosine;
+
+    float inp[64];
+    for(int i = 0; i < 64; i++) {
+        inp[i] = coefficients[i] * quantization.steps[i];
+    }
+
+    for(int y = 0; y < 8; y++) {
+        for(int x = 0; x < 8; x++) {
+            float s = 0;
+            for(int u = 0; u < 8; u++) {
+                float cxu = alpha[u] * cosine[x][u];
+                s += cxu
+                     * (inp[0 * 8 + u] * alpha[0] * cosine[y][0] + inp[1 * 8 + u] * alpha[1] * cosine[y][1] + inp[2 * 8 + u] * alpha[2] * cosine[y][2] + inp[3 * 8 + u] * alpha[3] * cosine[y][3]
+                        + inp[4 * 8 + u] * alpha[4] * cosine[y][4] + inp[5 * 8 + u] * alpha[5] * cosine[y][5] + inp[6 * 8 + u] * alpha[6] * cosine[y][6] + inp[7 * 8 + u] * alpha[7] * cosine[y][7]);
+            }
+            pixels[y * 8 + x] = toPixel(s / 4);
+        }
+    }
+}
+
+// 1-D AAN inverse transform of the 8 values at data[0], data[stride], ...
+static inline void aan(float* data, int stride) {
+    float tmp10 = data[0] + data[4 * stride];
+    float tmp11 = data[0] - data[4 * stride];
+    float tmp13 = data[2 * stride] + data[6 * stride];
+    float tmp12 = (data[2 * stride] - data[6 * stride]) * cSqrt2 - tmp13;
+
+    float even0 = tmp10 + tmp13;
+    float even3 = tmp10 - tmp13;
+    float even1 = tmp11 + tmp12;
+    float even2 = tmp11 - tmp12;
+
+    float z13 = data[5 * stride] + data[3 * stride];
+    float z10 = data[5 * stride] - data[3 * stride];
+    float z11 = data[1 * stride] + data[7 * stride];
+    float z12 = data[1 * stride] - data[7 * stride];
+
+    float odd7 = z11 + z13;
+    float odd11 = (z11 - z13) * cSqrt2;
+    float z5 = (z10 + z12) * cC2;
+    float odd10 = z12 * cC2MinusC6 - z5;
+    float odd12 = z5 - z10 * cC2PlusC6;
+    float odd6 = odd12 - odd7;
+    float odd5 = odd11 - odd6;
+    float odd4 = odd10 + odd5;
+
+    data[0] = even0 + odd7;
+    data[7 * stride] = even0 - odd7;
+    data[1 * stride] = even1 + odd6;
+    data[6 * stride] = even1 - odd6;
+    data[2 * stride] = even2 + odd5;
+    data[5 * stride] = even2 - odd5;
+    data[4 * stride] = even3 + odd4;
+    data[3 * stride] = even3 - odd4;
+}
+
+void idctGeneric(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    float block[64];
+    for(int i = 0; i < 64; i++) {
+        block[i] = coefficients[i] * quantization.scaledSteps[i];
+    }
+
+    for(int column = 0; column < 8; column++) {
+        aan(&block[column], 8);
+    }
+    for(int row = 0; row < 8; row++) {
+        aan(&block[row * 8], 1);
+    }
+
+    for(int i = 0; i < 64; i++) {
+        pixels[i] = toPixel(block[i]);
+    }
+}
+
+#if defined(CPU_X86)
+
+// The AAN transform of the vectors r[0..7], every lane is a separate column
+TARGET_SSE2 static inline void aanSSE2(__m128* r) {
+    const __m128 sqrt2 = _mm_set1_ps(cSqrt2);
+
+    __m128 tmp10 = _mm_add_ps(r[0], r[4]);
+    __m128 tmp11 = _mm_sub_ps(r[0], r[4]);
+    __m128 tmp13 = _mm_add_ps(r[2], r[6]);
+    __m128 tmp12 = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(r[2], r[6]), sqrt2), tmp13);
+
+    __m128 even0 = _mm_add_ps(tmp10, tmp13);
+    __m128 even3 = _mm_sub_ps(tmp10, tmp13);
+    __m128 even1 = _mm_add_ps(tmp11, tmp12);
+    __m128 even2 = _mm_sub_ps(tmp11, tmp12);
+
+    __m128 z13 = _mm_add_ps(r[5], r[3]);
+    __m128 z10 = _mm_sub_ps(r[5], r[3]);
+    __m128 z11 = _mm_add_ps(r[1], r[7]);
+    __m128 z12 = _mm_sub_ps(r[1], r[7]);
+
+    __m128 odd7 = _mm_add_ps(z11, z13);
+    __m128 odd11 = _mm_mul_ps(_mm_sub_ps(z11, z13), sqrt2);
+    __m128 z5 = _mm_mul_ps(_mm_add_ps(z10, z12), _mm_set1_ps(cC2));
+    __m128 odd10 = _mm_sub_ps(_mm_mul_ps(z12, _mm_set1_ps(cC2MinusC6)), z5);
+    __m128 odd12 = _mm_sub_ps(z5, _mm_mul_ps(z10, _mm_set1_ps(cC2PlusC6)));
+    __m128 odd6 = _mm_sub_ps(odd12, odd7);
+    __m128 odd5 = _mm_sub_ps(odd11, odd6);
+    __m128 odd4 = _mm_add_ps(odd10, odd5);
+
+    r[0] = _mm_add_ps(even0, odd7);
+    r[7] = _mm_sub_ps(even0, odd7);
+    r[1] = _mm_add_ps(even1, odd6);
+    r[6] = _mm_sub_ps(even1, odd6);
+    r[2] = _mm_add_ps(even2, odd5);
+    r[5] = _mm_sub_ps(even2, odd5);
+    r[4] = _mm_add_ps(even3, odd4);
+    r[3] = _mm_sub_ps(even3, odd4);
+}
+
+// left holds columns 0-3 of the rows, right columns 4-7. The 4x4 quarters are transposed, the two off diagonal ones swap places.
+TARGET_SSE2 static inline void transposeSSE2(__m128* left, __m128* right) {
+    _MM_TRANSPOSE4_PS(left[0], left[1], left[2], left[3]);
+    _MM_TRANSPOSE4_PS(left[4], left[5], left[6], left[7]);
+    _MM_TRANSPOSE4_PS(right[0], right[1], right[2], right[3]);
+    _MM_TRANSPOSE4_PS(right[4], right[5], right[6], right[7]);
+    for(int k = 0; k < 4; k++) {
+        __m128 swap = left[4 + k];
+        left[4 + k] = right[k];
+        right[k] = swap;
+    }
+}
+
+TARGET_SSE2 void idctSSE2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    __m128 left[8];
+    __m128 right[8];
+    for(int k = 0; k < 8; k++) {
+        __m128i leftCoefficients = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + k * 8));
+        __m128i rightCoefficients = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + k * 8 + 4));
+        left[k] = _mm_mul_ps(_mm_cvtepi32_ps(leftCoefficients), _mm_load_ps(quantization.scaledSteps + k * 8));
+        right[k] = _mm_mul_ps(_mm_cvtepi32_ps(rightCoefficients), _mm_load_ps(quantization.scaledSteps + k * 8 + 4));
+    }
+
+    aanSSE2(left);
+    aanSSE2(right);
+    transposeSSE2(left, right);
+    aanSSE2(left);
+    aanSSE2(right);
+    transposeSSE2(left, right);
+
+    // Round to nearest and saturate while packing
+    const __m128 levelShift = _mm_set1_ps(128.0f);
+    for(int k = 0; k < 8; k += 2) {
+        __m128i row0 = _mm_packs_epi32(_mm_cvtps_epi32(_mm_add_ps(left[k], levelShift)), _mm_cvtps_epi32(_mm_add_ps(right[k], levelShift)));
+        __m128i row1 = _mm_packs_epi32(_mm_cvtps_epi32(_mm_add_ps(left[k + 1], levelShift)), _mm_cvtps_epi32(_mm_add_ps(right[k + 1], levelShift)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + k * 8), _mm_packus_epi16(row0, row1));
+    }
+}
+
+TARGET_AVX2 static inline void aanAVX2(__m256* r) {
+    const __m256 sqrt2 = _mm256_set1_ps(cSqrt2);
+
+    __m256 tmp10 = _mm256_add_ps(r[0], r[4]);
+    __m256 tmp11 = _mm256_sub_ps(r[0], r[4]);
+    __m256 tmp13 = _mm256_add_ps(r[2], r[6]);
+    __m256 tmp12 = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(r[2], r[6]), sqrt2), tmp13);
+
+    __m256 even0 = _mm256_add_ps(tmp10, tmp13);
+    __m256 even3 = _mm256_sub_ps(tmp10, tmp13);
+    __m256 even1 = _mm256_add_ps(tmp11, tmp12);
+    __m256 even2 = _mm256_sub_ps(tmp11, tmp12);
+
+    __m256 z13 = _mm256_add_ps(r[5], r[3]);
+    __m256 z10 = _mm256_sub_ps(r[5], r[3]);
+    __m256 z11 = _mm256_add_ps(r[1], r[7]);
+    __m256 z12 = _mm256_sub_ps(r[1], r[7]);
+
+    __m256 odd7 = _mm256_add_ps(z11, z13);
+    __m256 odd11 = _mm256_mul_ps(_mm256_sub_ps(z11, z13), sqrt2);
+    __m256 z5 = _mm256_mul_ps(_mm256_add_ps(z10, z12), _mm256_set1_ps(cC2));
+    __m256 odd10 = _mm256_sub_ps(_mm256_mul_ps(z12, _mm256_set1_ps(cC2MinusC6)), z5);
+    __m256 odd12 = _mm256_sub_ps(z5, _mm256_mul_ps(z10, _mm256_set1_ps(cC2PlusC6)));
+    __m256 odd6 = _mm256_sub_ps(odd12, odd7);
+    __m256 odd5 = _mm256_sub_ps(odd11, odd6);
+    __m256 odd4 = _mm256_add_ps(odd10, odd5);
+
+    r[0] = _mm256_add_ps(even0, odd7);
+    r[7] = _mm256_sub_ps(even0, odd7);
+    r[1] = _mm256_add_ps(even1, odd6);
+    r[6] = _mm256_sub_ps(even1, odd6);
+    r[2] = _mm256_add_ps(even2, odd5);
+    r[5] = _mm256_sub_ps(even2, odd5);
+    r[4] = _mm256_add_ps(even3, odd4);
+    r[3] = _mm256_sub_ps(even3, odd4);
+}
+
+TARGET_AVX2 static inline void transposeAVX2(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+TARGET_AVX2 void idctAVX2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    __m256 r[8];
+    for(int k = 0; k < 8; k++) {
+        __m256i rowCoefficients = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coefficients + k * 8));
+        r[k] = _mm256_mul_ps(_mm256_cvtepi32_ps(rowCoefficients), _mm256_load_ps(quantization.scaledSteps + k * 8));
+    }
+
+    aanAVX2(r);
+    transposeAVX2(r);
+    aanAVX2(r);
+    transposeAVX2(r);
+
+    // The packs work within 128 bit lanes, the final permute puts the rows back in order
+    const __m256 levelShift = _mm256_set1_ps(128.0f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for(int k = 0; k < 8; k += 4) {
+        __m256i rows01 = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_add_ps(r[k], levelShift)), _mm256_cvtps_epi32(_mm256_add_ps(r[k + 1], levelShift)));
+        __m256i rows23 = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_add_ps(r[k + 2], levelShift)), _mm256_cvtps_epi32(_mm256_add_ps(r[k + 3], levelShift)));
+        __m256i rows = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(rows01, rows23), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + k * 8), rows);
+    }
+}
+
+#else
+
+void idctSSE2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    idctGeneric(coefficients, quantization, pixels);
+}
+
+void idctAVX2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    idctGeneric(coefficients, quantization, pixels);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+static inline void aanNEON(float32x4_t* r) {
+    float32x4_t tmp10 = vaddq_f32(r[0], r[4]);
+    float32x4_t tmp11 = vsubq_f32(r[0], r[4]);
+    float32x4_t tmp13 = vaddq_f32(r[2], r[6]);
+    float32x4_t tmp12 = vsubq_f32(vmulq_n_f32(vsubq_f32(r[2], r[6]), cSqrt2), tmp13);
+
+    float32x4_t even0 = vaddq_f32(tmp10, tmp13);
+    float32x4_t even3 = vsubq_f32(tmp10, tmp13);
+    float32x4_t even1 = vaddq_f32(tmp11, tmp12);
+    float32x4_t even2 = vsubq_f32(tmp11, tmp12);
+
+    float32x4_t z13 = vaddq_f32(r[5], r[3]);
+    float32x4_t z10 = vsubq_f32(r[5], r[3]);
+    float32x4_t z11 = vaddq_f32(r[1], r[7]);
+    float32x4_t z12 = vsubq_f32(r[1], r[7]);
+
+    float32x4_t odd7 = vaddq_f32(z11, z13);
+    float32x4_t odd11 = vmulq_n_f32(vsubq_f32(z11, z13), cSqrt2);
+    float32x4_t z5 = vmulq_n_f32(vaddq_f32(z10, z12), cC2);
+    float32x4_t odd10 = vsubq_f32(vmulq_n_f32(z12, cC2MinusC6), z5);
+    float32x4_t odd12 = vsubq_f32(z5, vmulq_n_f32(z10, cC2PlusC6));
+    float32x4_t odd6 = vsubq_f32(odd12, odd7);
+    float32x4_t odd5 = vsubq_f32(odd11, odd6);
+    float32x4_t odd4 = vaddq_f32(odd10, odd5);
+
+    r[0] = vaddq_f32(even0, odd7);
+    r[7] = vsubq_f32(even0, odd7);
+    r[1] = vaddq_f32(even1, odd6);
+    r[6] = vsubq_f32(even1, odd6);
+    r[2] = vaddq_f32(even2, odd5);
+    r[5] = vsubq_f32(even2, odd5);
+    r[4] = vaddq_f32(even3, odd4);
+    r[3] = vsubq_f32(even3, odd4);
+}
+
+static inline void transpose4NEON(float32x4_t* r) {
+    float32x4x2_t t01 = vtrnq_f32(r[0], r[1]);
+    float32x4x2_t t23 = vtrnq_f32(r[2], r[3]);
+    r[0] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r[1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+// Same layout as transposeSSE2
+static inline void transposeNEON(float32x4_t* left, float32x4_t* right) {
+    transpose4NEON(left);
+    transpose4NEON(left + 4);
+    transpose4NEON(right);
+    transpose4NEON(right + 4);
+    for(int k = 0; k < 4; k++) {
+        float32x4_t swap = left[4 + k];
+        left[4 + k] = right[k];
+        right[k] = swap;
+    }
+}
+
+void idctNEON(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    float32x4_t left[8];
+    float32x4_t right[8];
+    for(int k = 0; k < 8; k++) {
+        left[k] = vmulq_f32(vcvtq_f32_s32(vld1q_s32(coefficients + k * 8)), vld1q_f32(quantization.scaledSteps + k * 8));
+        right[k] = vmulq_f32(vcvtq_f32_s32(vld1q_s32(coefficients + k * 8 + 4)), vld1q_f32(quantization.scaledSteps + k * 8 + 4));
+    }
+
+    aanNEON(left);
+    aanNEON(right);
+    transposeNEON(left, right);
+    aanNEON(left);
+    aanNEON(right);
+    transposeNEON(left, right);
+
+    // Saturated before the conversion, which truncates: adding 0.5 makes it round half up
+    const float32x4_t levelShift = vdupq_n_f32(128.5f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t white = vdupq_n_f32(255.0f);
+    for(int k = 0; k < 8; k++) {
+        uint32x4_t low = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(left[k], levelShift), zero), white));
+        uint32x4_t high = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(right[k], levelShift), zero), white));
+        vst1_u8(pixels + k * 8, vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+    }
+}
+
+#else
+
+void idctNEON(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels) {
+    idctGeneric(coefficients, quantization, pixels);
+}
+
+#endif
+
+} // namespace IdctKernels
+} // namespace msumr
+} // namespace lrpt
+} // namespace protocol
+} // namespace decoder
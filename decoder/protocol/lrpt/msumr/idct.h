@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+
+namespace decoder {
+namespace protocol {
+namespace lrpt {
+namespace msumr {
+
+// Inverse DCT of the 8x8 MSU-MR blocks. The fast kernels are the separable AAN float transform, the dequantization is folded into its input scaling.
+namespace IdctKernels {
+
+struct QuantizationTable {
+    // Quantization steps in row major order
+    alignas(32) float steps[64];
+    // steps times the AAN scale factors of the row and the column and the 1/8 of the two passes, the fast kernels start with these
+    alignas(32) float scaledSteps[64];
+};
+
+// coefficients: quantized coefficients in row major order, pixels: the block level shifted by 128 and saturated to 0-255
+typedef void (*IdctFunc)(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+
+void fillQuantizationTable(const std::array<int, 64>& steps, QuantizationTable& table);
+
+IdctFunc selectIdct();
+
+// The direct O(n^4) transform, it is kept to check the others against
+void idctReference(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+void idctGeneric(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+void idctSSE2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+void idctAVX2(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+void idctNEON(const int32_t* coefficients, const QuantizationTable& quantization, uint8_t* pixels);
+
+} // namespace IdctKernels
+
+} // namespace msumr
+} // namespace lrpt
+} // namespace protocol
+} // namespace decoder
@@ -1,9 +1,12 @@
 #include "image.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <opencv2/imgcodecs.hpp>
 #include <sstream>
+#include <thread>
 
 #include "bitio.h"
 
@@ -15,8 +18,9 @@ namespace msumr {
 const std::array<uint8_t, 64> STANDARD_QUANTIZATION_TABLE{16, 11, 10, 16, 24, 40,  51,  61, 12, 12, 14, 19, 26, 58,  60,  55, 14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
                                                           18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
 
-const std::array<uint8_t, 64> ZIGZAG{0,  1,  5,  6,  14, 15, 27, 28, 2,  4,  7,  13, 16, 26, 29, 42, 3,  8,  12, 17, 25, 30, 41, 43, 9,  11, 18, 24, 31, 40, 44, 53,
-                                     10, 19, 23, 32, 39, 45, 52, 54, 20, 22, 33, 38, 46, 51, 55, 60, 21, 34, 37, 47, 50, 56, 59, 61, 35, 36, 48, 49, 57, 58, 62, 63};
+// Row major index of the coefficients in zigzag order
+const std::array<uint8_t, 64> NATURAL_ORDER{0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+                                            35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
 
 const std::array<uint8_t, 178> T_AC_0{0,   2,   1,   3,   3,   2,   4,   3,   5,   5,   4,   4,   0,   0,   1,   125, 1,   2,   3,   0,   4,   17,  5,   18,  33,  49,  65,  6,   19,  81,  97,  7,   34,  113, 20,  50,
                                       129, 145, 161, 8,   35,  66,  177, 193, 21,  82,  209, 240, 36,  51,  98,  114, 130, 9,   10,  22,  23,  24,  25,  26,  37,  38,  39,  40,  41,  42,  52,  53,  54,  55,  56,  57,
@@ -26,29 +30,33 @@ const std::array<uint8_t, 178> T_AC_0{0,   2,   1,   3,   3,   2,   4,   3,   5,
 
 const std::array<int, 12> DC_CAT_OFF{2, 3, 3, 3, 3, 3, 4, 5, 6, 7, 8, 9};
 
+// Length of the longest DC category code, the index width of mDcLookup
+const int DC_CODE_BITS = 9;
 
-Image::Image()
+
+Image::Image(int threads)
     : mIsChannel64Available(false)
     , mIsChannel65Available(false)
     , mIsChannel66Available(false)
+    , mIsChannel67Available(false)
     , mIsChannel68Available(false)
+    , mIsChannel69Available(false)
+    , mHeight(0)
     , mLastMCU(-1)
     , mCurY(0)
     , mLastY(-1)
     , mFirstPacket(0)
-    , mPrevPacket(0) {
+    , mPrevPacket(0)
+    , mIdct(IdctKernels::selectIdct()) {
     initHuffmanTable();
-    initCos();
-}
 
-void Image::initCos() {
-    for(int y = 0; y < 8; y++) {
-        for(int x = 0; x < 8; x++) {
-            mCosine[y][x] = cos(M_PI / 16 * (2 * y + 1) * x);
-        }
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
     }
-    for(int x = 0; x < 8; x++) {
-        mAlpha[x] = (x == 0) ? 1.0f / std::sqrt(2.0f) : 1.0f;
+    if(threads > 1) {
+        mBatch = std::make_shared<Batch>();
+        mThreadPool = std::make_unique<ThreadPool>(threads);
+        mThreadPool->start();
     }
 }
 
@@ -96,10 +104,16 @@ void Image::initHuffmanTable() {
     }
 
     for(int i = 0; i < 65536; i++) {
-        mAcLookup[i] = getAcReal(i);
+        int ac = getAcReal(i);
+        if(ac != -1) {
+            mAcLookup[i] = mAcTable[ac].run << 12 | mAcTable[ac].size << 8 | mAcTable[ac].len;
+        }
     }
-    for(int i = 0; i < 65536; i++) {
-        mDcLookup[i] = getDcReal(i);
+    for(int i = 0; i < (1 << DC_CODE_BITS); i++) {
+        int dc = getDcReal(i << (16 - DC_CODE_BITS));
+        if(dc != -1) {
+            mDcLookup[i] = dc << 8 | DC_CAT_OFF[dc];
+        }
     }
 }
 
@@ -146,32 +160,31 @@ int Image::getAcReal(uint16_t word) {
     return -1;
 }
 
-Image::~Image() {}
-
-cv::Mat Image::getChannelImage(APIDs channelID, bool fillBlackLines) {
-    if(mChannels.size() == 0) {
-        return cv::Mat();
+Image::~Image() {
+    // The jobs in flight write the planes
+    if(mThreadPool) {
+        mThreadPool->stop();
     }
+}
 
-    const int width = 8 * cMCUPerLine;
-    const int height = mCurY + 8;
-
-    cv::Mat image = cv::Mat(height, width, CV_8UC3);
-
-    for(int y = 0; y < image.rows; y++) {
-        for(int x = 0; x < image.cols; x++) {
-            uint off = x + y * cMCUPerLine * 8;
+void Image::waitForDecode() {
+    if(mThreadPool) {
+        dispatchBatch();
+        mThreadPool->waitForAllJobsDone();
+    }
+}
 
-            cv::Vec3b& color = image.at<cv::Vec3b>(y, x);
+cv::Mat Image::getChannelImage(APIDs channelID, bool fillBlackLines) {
+    waitForDecode();
 
-            color[0] = mChannels[off][channelID - 64];
-            color[1] = mChannels[off][channelID - 64];
-            color[2] = mChannels[off][channelID - 64];
-        }
+    if(mHeight == 0) {
+        return cv::Mat();
     }
 
+    cv::Mat image = getPlane(channelID, mCurY + 8);
 
     if(fillBlackLines) {
+        image = image.clone();
         ThreatImage::fillBlackLines(image, 8, 64);
     }
 
@@ -179,25 +192,26 @@ cv::Mat Image::getChannelImage(APIDs channelID, bool fillBlackLines) {
 }
 
 cv::Mat Image::getRGBImage(APIDs redAPID, APIDs greenAPID, APIDs blueAPID, bool fillBlackLines, bool invertR, bool invertG, bool invertB) {
-    if(mChannels.size() == 0) {
+    waitForDecode();
+
+    if(mHeight == 0) {
         return cv::Mat();
     }
 
-    int width = 8 * cMCUPerLine;
-    int height = mCurY + 8;
-    cv::Mat image = cv::Mat(height, width, CV_8UC3);
-
-    for(int y = 0; y < image.rows; y++) {
-        for(int x = 0; x < image.cols; x++) {
-            uint off = x + y * cMCUPerLine * 8;
-            cv::Vec3b& color = image.at<cv::Vec3b>(cv::Point(x, y));
-
-            color[0] = invertB ? ~mChannels[off][blueAPID - 64] : mChannels[off][blueAPID - 64];
-            color[1] = invertG ? ~mChannels[off][greenAPID - 64] : mChannels[off][greenAPID - 64];
-            color[2] = invertR ? ~mChannels[off][redAPID - 64] : mChannels[off][redAPID - 64];
+    const int height = mCurY + 8;
+    std::vector<cv::Mat> planes{getPlane(blueAPID, height), getPlane(greenAPID, height), getPlane(redAPID, height)};
+    const bool invert[3]{invertB, invertG, invertR};
+    for(int i = 0; i < 3; i++) {
+        if(invert[i]) {
+            // The planes are views of the channels, the inverted copy replaces the view
+            cv::Mat inverted;
+            cv::bitwise_not(planes[i], inverted);
+            planes[i] = inverted;
         }
     }
 
+    cv::Mat image;
+    cv::merge(planes, image);
 
     if(fillBlackLines) {
         ThreatImage::fillBlackLines(image, 8, 64);
@@ -206,6 +220,22 @@ cv::Mat Image::getRGBImage(APIDs redAPID, APIDs greenAPID, APIDs blueAPID, bool
     return image;
 }
 
+cv::Mat Image::getPlane(APIDs apid, int height) {
+    std::vector<uint8_t>& plane = mChannels[apid - 64];
+    if(plane.empty()) {
+        return cv::Mat::zeros(height, cWidth, CV_8UC1);
+    }
+    return cv::Mat(height, cWidth, CV_8UC1, plane.data());
+}
+
+void Image::addChannel(int apd) {
+    std::vector<uint8_t>& plane = mChannels[apd - 64];
+    if(plane.empty()) {
+        plane.reserve(static_cast<size_t>(cWidth) * std::max(cReservedRows, mHeight));
+        plane.resize(static_cast<size_t>(cWidth) * mHeight);
+    }
+}
+
 bool Image::progressImage(int apd, int mcu_id, int pck_cnt) {
     if(apd == 0 || apd == 70) {
         return false;
@@ -236,15 +266,28 @@ bool Image::progressImage(int apd, int mcu_id, int pck_cnt) {
     mPrevPacket = pck_cnt;
 
     mCurY = 8 * ((pck_cnt - mFirstPacket) / (14 + 14 + 14 + 1));
-    if(mCurY > mLastY) {
-        mChannels.resize(cMCUPerLine * 8 * (mCurY + 8));
+    if(mCurY + 8 > mHeight) {
+        // Planes only grow, capacity beyond cReservedRows is doubled by the vector
+        mHeight = mCurY + 8;
+        const size_t size = static_cast<size_t>(cWidth) * mHeight;
+        for(std::vector<uint8_t>& plane : mChannels) {
+            if(plane.empty()) {
+                continue;
+            }
+            // The jobs in flight write through pointers to the planes, they must not move under them.
+            // Growing within the capacity only clears rows below the ones being decoded.
+            if(mThreadPool && size > plane.capacity()) {
+                mThreadPool->waitForAllJobsDone();
+            }
+            plane.resize(size);
+        }
     }
     mLastY = mCurY;
 
     return true;
 }
 
-void Image::fillDqtByQ(std::array<int, 64>& dqt, int q) {
+void Image::fillDqtByQ(std::array<int, 64>& dqt, int q) const {
     float f;
     f = (q > 20 && q < 50) ? 5000.0 / q : 200.0 - 2.0 * q;
 
@@ -256,69 +299,19 @@ void Image::fillDqtByQ(std::array<int, 64>& dqt, int q) {
     }
 }
 
-int Image::mapRange(int cat, int vl) {
+int Image::mapRange(int cat, int vl) const {
+    // The top bit of the cat bits is the sign, cat = 0 gives 0
     int maxval = (1 << cat) - 1;
-    bool sig = (vl >> (cat - 1)) != 0;
-    return sig ? vl : vl - maxval;
+    return (vl << 1) > maxval ? vl : vl - maxval;
 }
 
-void Image::filtIdct8x8(std::array<float, 64>& res, std::array<float, 64>& inp) {
-    for(int y = 0; y < 8; y++) {
-        for(int x = 0; x < 8; x++) {
-            float s = 0;
-            for(int u = 0; u < 8; u++) {
-                float cxu = mAlpha[u] * mCosine[x][u];
-                s += cxu
-                     * (inp[0 * 8 + u] * mAlpha[0] * mCosine[y][0] + inp[1 * 8 + u] * mAlpha[1] * mCosine[y][1] + inp[2 * 8 + u] * mAlpha[2] * mCosine[y][2] + inp[3 * 8 + u] * mAlpha[3] * mCosine[y][3]
-                        + inp[4 * 8 + u] * mAlpha[4] * mCosine[y][4] + inp[5 * 8 + u] * mAlpha[5] * mCosine[y][5] + inp[6 * 8 + u] * mAlpha[6] * mCosine[y][6] + inp[7 * 8 + u] * mAlpha[7] * mCosine[y][7]);
-            }
-            res[y * 8 + x] = s / 4;
-        }
-    }
-}
-
-void Image::fillPix(std::array<float, 64>& img_dct, int apd, int mcu_id, int m) {
-    for(int i = 0; i < 64; i++) {
-        int t = std::round(img_dct[i] + 128.0f);
-        if(t < 0) {
-            t = 0;
-        }
-        if(t > 255) {
-            t = 255;
-        }
-        int x = (mcu_id + m) * 8 + i % 8;
-        int y = mCurY + i / 8;
-        uint off = x + y * cMCUPerLine * 8;
-
-        switch(apd) {
-            case 64:
-                mChannels[off][APIDs::APID64 - 64] = t;
-                break;
-            case 65:
-                mChannels[off][APIDs::APID65 - 64] = t;
-                break;
-            case 66:
-                mChannels[off][APIDs::APID66 - 64] = t;
-                break;
-            case 67:
-                mChannels[off][APIDs::APID67 - 64] = t;
-                break;
-            case 68:
-                mChannels[off][APIDs::APID68 - 64] = t;
-                break;
-            case 69:
-                mChannels[off][APIDs::APID69 - 64] = t;
-                break;
-
-            default:
-                break;
-        }
+void Image::fillPix(const uint8_t* pixels, uint8_t* block) const {
+    for(int row = 0; row < 8; row++) {
+        std::memcpy(block + row * cWidth, pixels + row * 8, 8);
     }
 }
 
 void Image::decode(uint16_t apid, uint16_t packetCount, const Segment& segment) {
-    BitIOConst bitIO(segment.getPayloadData(), segment.getPayloadSize());
-
     if(!progressImage(apid, segment.getID(), packetCount)) {
         return;
     }
@@ -342,64 +335,112 @@ void Image::decode(uint16_t apid, uint16_t packetCount, const Segment& segment)
         mIsChannel69Available = true;
     }
 
+    if(apid < APIDs::APID64 || apid > APIDs::APID69 || segment.getID() > cMCUPerLine - cMCUPerPacket || mCurY < 0) {
+        return;
+    }
+    addChannel(apid);
+
+    const uint8_t channel = apid - APIDs::APID64;
+    const uint32_t pixelOffset = static_cast<uint32_t>(mCurY) * cWidth + segment.getID() * 8;
+    if(!mThreadPool) {
+        decodeSegment(segment.getPayloadData(), segment.getPayloadSize(), segment.getQF(), mChannels[channel].data() + pixelOffset);
+        return;
+    }
+
+    // The segment only points into the packet buffer
+    SegmentJob job;
+    job.channel = channel;
+    job.pixelOffset = pixelOffset;
+    job.payloadOffset = static_cast<uint32_t>(mBatch->payload.size());
+    job.payloadSize = segment.getPayloadSize();
+    job.qf = segment.getQF();
+    mBatch->payload.insert(mBatch->payload.end(), segment.getPayloadData(), segment.getPayloadData() + segment.getPayloadSize());
+    mBatch->segments.push_back(job);
+
+    if(mBatch->segments.size() >= cBatchSegments) {
+        dispatchBatch();
+    }
+}
+
+void Image::dispatchBatch() {
+    if(mBatch->segments.empty()) {
+        return;
+    }
+
+    // Plane pointers are taken here, progressImage waits for the jobs before a plane is reallocated.
+    // Segments of different packets cover disjoint blocks, the jobs need no locking.
+    std::array<uint8_t*, 6> planes;
+    for(size_t i = 0; i < planes.size(); i++) {
+        planes[i] = mChannels[i].data();
+    }
+
+    std::shared_ptr<Batch> batch = std::move(mBatch);
+    mBatch = std::make_shared<Batch>();
+    mThreadPool->addJob([this, batch, planes]() {
+        for(const SegmentJob& job : batch->segments) {
+            decodeSegment(batch->payload.data() + job.payloadOffset, job.payloadSize, job.qf, planes[job.channel] + job.pixelOffset);
+        }
+    });
+}
+
+void Image::decodeSegment(const uint8_t* payload, uint16_t payloadSize, uint8_t qf, uint8_t* block) const {
+    BitIOConst bitIO(payload, payloadSize);
+
     std::array<int, 64> dqt{};
-    std::array<float, 64> zdct{}, dct{}, img_dct{};
-    fillDqtByQ(dqt, segment.getQF());
+    std::array<int32_t, 64> coefficients{};
+    std::array<uint8_t, 64> pixels{};
+    IdctKernels::QuantizationTable quantization;
+    fillDqtByQ(dqt, qf);
+    IdctKernels::fillQuantizationTable(dqt, quantization);
 
-    float prevDC = 0;
+    int32_t prevDC = 0;
     int m = 0;
     while(m < cMCUPerPacket) {
-        int dc_cat = mDcLookup[bitIO.peekBits(16)];
-        if(dc_cat == -1) {
+        uint16_t dc = mDcLookup[bitIO.peekBits(DC_CODE_BITS)];
+        if(dc == 0) {
             std::cerr << "Bad DC Huffman code!" << std::endl;
             return;
         }
-        bitIO.advanceBits(DC_CAT_OFF[dc_cat]);
-        uint32_t n = bitIO.fetchBits(dc_cat);
+        int dc_cat = dc >> 8;
+        bitIO.advanceBits(dc & 0xff);
 
-        zdct[0] = mapRange(dc_cat, n) + prevDC;
-        prevDC = zdct[0];
+        coefficients.fill(0);
+        coefficients[0] = mapRange(dc_cat, bitIO.fetchBits(dc_cat)) + prevDC;
+        prevDC = coefficients[0];
 
+        // Coefficients come in zigzag order, they are stored in row major order for the IDCT
         int k = 1;
         while(k < 64) {
-            int ac = mAcLookup[bitIO.peekBits(16)];
-            if(ac == -1) {
+            uint16_t ac = mAcLookup[bitIO.peekBits(16)];
+            if(ac == 0) {
                 std::cerr << "Bad AC Huffman code!" << std::endl;
                 return;
             }
-            int ac_len = mAcTable[ac].len;
-            int ac_size = mAcTable[ac].size;
-            int ac_run = mAcTable[ac].run;
-            bitIO.advanceBits(ac_len);
-
-            if(ac_run == 0 && ac_size == 0) {
-                for(int i = k; i < 64; i++) {
-                    zdct[i] = 0;
+            int ac_run = ac >> 12;
+            int ac_size = (ac >> 8) & 0xf;
+            bitIO.advanceBits(ac & 0xff);
+
+            if(ac_size == 0) {
+                if(ac_run == 0) {
+                    // End of block
+                    break;
                 }
-                break;
+                // 16 zeros, ac_run is 15
+                k += 16;
+                continue;
             }
 
-            for(int i = 0; i < ac_run; i++) {
-                zdct[k] = 0;
-                k++;
-            }
-
-            if(ac_size != 0) {
-                uint16_t n = bitIO.fetchBits(ac_size);
-                zdct[k] = mapRange(ac_size, n);
-                k++;
-            } else if(ac_run == 15) {
-                zdct[k] = 0;
-                k++;
+            k += ac_run;
+            if(k > 63) {
+                break;
             }
+            coefficients[NATURAL_ORDER[k]] = mapRange(ac_size, bitIO.fetchBits(ac_size));
+            k++;
         }
 
-        for(int i = 0; i < 64; i++) {
-            dct[i] = zdct[ZIGZAG[i]] * dqt[i];
-        }
-
-        filtIdct8x8(img_dct, dct);
-        fillPix(img_dct, apid, segment.getID(), m);
+        // Dequantization is part of the IDCT input scaling
+        mIdct(coefficients.data(), quantization, pixels.data());
+        fillPix(pixels.data(), block + m * 8);
 
         m++;
     }
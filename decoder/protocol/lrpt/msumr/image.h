@@ -1,11 +1,14 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <vector>
 
+#include "idct.h"
 #include "segment.h"
+#include "threadpool.h"
 #include "threatimage.h"
 
 namespace decoder {
@@ -22,15 +25,35 @@ class Image {
         uint32_t code;
     };
 
+    // A segment queued for a worker thread, its payload is copied to the batch
+    struct SegmentJob {
+        uint8_t channel;
+        uint32_t pixelOffset;
+        uint32_t payloadOffset;
+        uint16_t payloadSize;
+        uint8_t qf;
+    };
+
+    struct Batch {
+        std::vector<SegmentJob> segments;
+        std::vector<uint8_t> payload;
+    };
+
 
   public:
     enum APIDs { APID64 = 64, APID65, APID66, APID67, APID68, APID69 };
 
   public:
-    Image();
+    // threads: segments decoded in parallel, 1 decodes them on the calling thread, 0 uses all cores
+    explicit Image(int threads = 1);
     virtual ~Image();
 
+    // Waits for the segments queued to the worker threads, the image getters call it
+    void waitForDecode();
+
     cv::Mat getRGBImage(APIDs redAPID, APIDs greenAPID, APIDs blueAPID, bool fillBlackLines = true, bool invertR = false, bool invertG = false, bool invertB = false);
+    // CV_8UC1 view of the channel without copy, valid while the Image lives and decodes no more segments.
+    // With fillBlackLines it is a filled copy.
     cv::Mat getChannelImage(APIDs APID, bool fillBlackLines = true);
 
   public:
@@ -67,14 +90,20 @@ class Image {
 
   private:
     void initHuffmanTable();
-    void initCos();
     int getDcReal(uint16_t word);
     int getAcReal(uint16_t word);
     bool progressImage(int apd, int mcuID, int pckCnt);
-    void fillDqtByQ(std::array<int, 64>& dqt, int q);
-    int mapRange(int cat, int vl);
-    void filtIdct8x8(std::array<float, 64>& res, std::array<float, 64>& inp);
-    void fillPix(std::array<float, 64>& imgDct, int apd, int mcu_id, int m);
+    void fillDqtByQ(std::array<int, 64>& dqt, int q) const;
+    int mapRange(int cat, int vl) const;
+    // block: top left pixel of the MCU in its plane
+    void fillPix(const uint8_t* pixels, uint8_t* block) const;
+    // Huffman decoding, IDCT and fillPix of the 14 MCUs of a segment, block is the first MCU. Only reads members, worker threads run it in parallel.
+    void decodeSegment(const uint8_t* payload, uint16_t payloadSize, uint8_t qf, uint8_t* block) const;
+    void dispatchBatch();
+    // Allocates the plane of a newly seen APID
+    void addChannel(int apd);
+    // The first height rows of a plane without copy, zeros for a missing APID
+    cv::Mat getPlane(APIDs apid, int height);
 
   private:
     bool mIsChannel64Available;
@@ -84,16 +113,27 @@ class Image {
     bool mIsChannel68Available;
     bool mIsChannel69Available;
 
-    std::vector<std::array<uint8_t, 6>> mChannels;
+    // One plane per APID, cWidth pixels wide and mHeight rows high, empty until the APID is seen
+    std::array<std::vector<uint8_t>, 6> mChannels;
+    int mHeight;
     int mLastMCU, mCurY, mLastY, mFirstPacket, mPrevPacket;
-    std::array<int, 65536> mAcLookup{}, mDcLookup{};
+    // Indexed by the next 16 bits, run << 12 | size << 8 | code length, 0 for an invalid code
+    std::array<uint16_t, 65536> mAcLookup{};
+    // Indexed by the next 9 bits, the longest DC code, category << 8 | code length, 0 for an invalid code
+    std::array<uint16_t, 512> mDcLookup{};
     std::array<ac_table_rec, 162> mAcTable{};
-    std::array<std::array<float, 8>, 8> mCosine{};
-    std::array<float, 8> mAlpha;
+    IdctKernels::IdctFunc mIdct;
+    std::unique_ptr<ThreadPool> mThreadPool;
+    std::shared_ptr<Batch> mBatch;
 
   private:
     static constexpr uint16_t cMCUPerPacket = 14;
     static constexpr uint16_t cMCUPerLine = 196;
+    static constexpr int cWidth = cMCUPerLine * 8;
+    // Rows reserved for a plane when its APID is first seen, enough for a long pass without reallocation
+    static constexpr int cReservedRows = 8192;
+    // Segments per worker job, a job of a few has more queueing overhead than decoding
+    static constexpr size_t cBatchSegments = 64;
 };
 
 
@@ -1,9 +1,60 @@
 #include "reedsolomon.h"
 
+#include <algorithm>
 #include <array>
 
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// A zero byte in front of the 255 byte codewords makes 64 groups of 4 positions, the first group is built from the first 12 bytes
+static constexpr int cGroups = 63;
+
+struct ReedSolomon::GaloisField {
+    uint8_t exp[255 * 2];
+    uint8_t log[256];
+    uint8_t rootLog[cNRoots];
+    // Products with the fourth power of root j by the low and high nibble of the other factor, a table lookup multiplies 16 bytes at once
+    alignas(32) uint8_t mulLow[cNRoots][16];
+    alignas(32) uint8_t mulHigh[cNRoots][16];
+
+    GaloisField() {
+        int element = 1;
+        for(int i = 0; i < 255; i++) {
+            exp[i] = exp[i + 255] = static_cast<uint8_t>(element);
+            log[element] = static_cast<uint8_t>(i);
+            element <<= 1;
+            if(element & 0x100) {
+                element ^= cpolynomial;
+            }
+        }
+        log[0] = 0;
+
+        for(int j = 0; j < cNRoots; j++) {
+            rootLog[j] = static_cast<uint8_t>((cRootGap * (cFirstRoot + j)) % 255);
+            int powerLog = (rootLog[j] * 4) % 255;
+            for(int n = 0; n < 16; n++) {
+                mulLow[j][n] = mulLog(static_cast<uint8_t>(n), powerLog);
+                mulHigh[j][n] = mulLog(static_cast<uint8_t>(n << 4), powerLog);
+            }
+        }
+    }
+
+    // a * alpha^factorLog, factorLog < 255
+    uint8_t mulLog(uint8_t a, int factorLog) const {
+        return a == 0 ? 0 : exp[log[a] + factorLog];
+    }
+};
+
 ReedSolomon::ReedSolomon()
-    : mpReedSolomon(nullptr) {
+    : mpReedSolomon(nullptr)
+    , mSyndromes(selectSyndromes()) {
     mpReedSolomon = correct_reed_solomon_create(cpolynomial, cFirstRoot, cRootGap, cNRoots);
 }
 
@@ -36,3 +87,169 @@ int ReedSolomon::decode() {
 
     return result;
 }
+
+void ReedSolomon::decodeInterleaved(const uint8_t* data, uint8_t* output, int* results) {
+    const GaloisField& field = galoisField();
+    bool clean[cInterleave];
+    bool allClean = true;
+
+    mSyndromes(data, mAccumulators);
+
+    // Syndrome j is the sum of the accumulators of the 4 position groups times root j to the power of the positions after them
+    for(int c = 0; c < cInterleave; c++) {
+        clean[c] = true;
+        for(int j = 0; j < cNRoots && clean[c]; j++) {
+            const uint8_t* accumulator = &mAccumulators[j * 16 + c];
+            uint8_t syndrome = accumulator[12];
+            for(int p = 0; p < 3; p++) {
+                syndrome ^= field.mulLog(accumulator[p * 4], (field.rootLog[j] * (3 - p)) % 255);
+            }
+            clean[c] = syndrome == 0;
+        }
+        allClean = allClean && clean[c];
+    }
+
+    if(allClean) {
+        std::copy(data, data + 223 * cInterleave, output);
+        std::fill(results, results + cInterleave, 0);
+        return;
+    }
+
+    for(int c = 0; c < cInterleave; c++) {
+        if(clean[c]) {
+            for(int i = 0; i < 223; i++) {
+                output[i * cInterleave + c] = data[i * cInterleave + c];
+            }
+            results[c] = 0;
+        } else {
+            deinterleave(data, c, cInterleave);
+            results[c] = decode();
+            interleave(output, c, cInterleave);
+        }
+    }
+}
+
+const ReedSolomon::GaloisField& ReedSolomon::galoisField() {
+    static const GaloisField field;
+    return field;
+}
+
+ReedSolomon::SyndromesFunc ReedSolomon::selectSyndromes() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return syndromesAVX2;
+    }
+    if(cpu.hasSSSE3()) {
+        return syndromesSSSE3;
+    }
+#endif
+
+#if defined(CPU_NEON) && defined(__aarch64__)
+    if(cpu.hasNEON()) {
+        return syndromesNEON;
+    }
+#endif
+
+    (void)cpu;
+    return syndromesGeneric;
+}
+
+void ReedSolomon::syndromesGeneric(const uint8_t* data, uint8_t* accumulators) {
+    const GaloisField& field = galoisField();
+
+    for(int j = 0; j < cNRoots; j++) {
+        uint8_t* accumulator = &accumulators[j * 16];
+        for(int l = 0; l < 16; l++) {
+            accumulator[l] = l < 4 ? 0 : data[l - 4];
+        }
+
+        for(int k = 0; k < cGroups; k++) {
+            const uint8_t* group = &data[12 + k * 16];
+            for(int l = 0; l < 16; l++) {
+                accumulator[l] = field.mulLow[j][accumulator[l] & 0x0F] ^ field.mulHigh[j][accumulator[l] >> 4] ^ group[l];
+            }
+        }
+    }
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSSE3 void ReedSolomon::syndromesSSSE3(const uint8_t* data, uint8_t* accumulators) {
+    const GaloisField& field = galoisField();
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i first = _mm_slli_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), 4);
+
+    for(int j = 0; j < cNRoots; j++) {
+        const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(field.mulLow[j]));
+        const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(field.mulHigh[j]));
+        __m128i accumulator = first;
+
+        for(int k = 0; k < cGroups; k++) {
+            __m128i product = _mm_xor_si128(_mm_shuffle_epi8(low, _mm_and_si128(accumulator, nibble)), _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(accumulator, 4), nibble)));
+            accumulator = _mm_xor_si128(product, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 12 + k * 16)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators + j * 16), accumulator);
+    }
+}
+
+// The shuffle works within 128 bit lanes, the lanes hold two roots with their own tables
+TARGET_AVX2 void ReedSolomon::syndromesAVX2(const uint8_t* data, uint8_t* accumulators) {
+    const GaloisField& field = galoisField();
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i first = _mm256_slli_si256(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), 4);
+
+    for(int j = 0; j < cNRoots; j += 2) {
+        const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(field.mulLow[j]));
+        const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(field.mulHigh[j]));
+        __m256i accumulator = first;
+
+        for(int k = 0; k < cGroups; k++) {
+            __m256i product = _mm256_xor_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(accumulator, nibble)), _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(accumulator, 4), nibble)));
+            __m256i group = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 12 + k * 16)));
+            accumulator = _mm256_xor_si256(product, group);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + j * 16), accumulator);
+    }
+}
+
+#else
+
+void ReedSolomon::syndromesSSSE3(const uint8_t* data, uint8_t* accumulators) {
+    syndromesGeneric(data, accumulators);
+}
+
+void ReedSolomon::syndromesAVX2(const uint8_t* data, uint8_t* accumulators) {
+    syndromesGeneric(data, accumulators);
+}
+
+#endif
+
+#if defined(CPU_NEON) && defined(__aarch64__)
+
+void ReedSolomon::syndromesNEON(const uint8_t* data, uint8_t* accumulators) {
+    const GaloisField& field = galoisField();
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    const uint8x16_t first = vextq_u8(vdupq_n_u8(0), vld1q_u8(data), 12);
+
+    for(int j = 0; j < cNRoots; j++) {
+        const uint8x16_t low = vld1q_u8(field.mulLow[j]);
+        const uint8x16_t high = vld1q_u8(field.mulHigh[j]);
+        uint8x16_t accumulator = first;
+
+        for(int k = 0; k < cGroups; k++) {
+            uint8x16_t product = veorq_u8(vqtbl1q_u8(low, vandq_u8(accumulator, nibble)), vqtbl1q_u8(high, vshrq_n_u8(accumulator, 4)));
+            accumulator = veorq_u8(product, vld1q_u8(data + 12 + k * 16));
+        }
+        vst1q_u8(accumulators + j * 16, accumulator);
+    }
+}
+
+#else
+
+void ReedSolomon::syndromesNEON(const uint8_t* data, uint8_t* accumulators) {
+    syndromesGeneric(data, accumulators);
+}
+
+#endif
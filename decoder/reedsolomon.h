@@ -7,6 +7,11 @@ extern "C" {
 }
 
 class ReedSolomon {
+  public:
+    // Horner accumulators of the syndromes of the cInterleave codewords interleaved byte by byte in data.
+    // accumulators[j * 16 + p * 4 + c] belongs to root j, codeword c and the positions p modulo 4 (counted from a zero byte before the first one).
+    typedef void (*SyndromesFunc)(const uint8_t* data, uint8_t* accumulators);
+
   public:
     ReedSolomon();
     ~ReedSolomon();
@@ -15,9 +20,30 @@ class ReedSolomon {
     void interleave(uint8_t* output, int pos, int n);
     int decode();
 
+    // Decodes the cInterleave codewords interleaved in data (cInterleave * 255 bytes), the data bytes go to output in the same order.
+    // results[i] is the number of corrected bytes of codeword i or -1 if it is uncorrectable. Codewords without errors are only copied,
+    // the others go through the full decoder.
+    void decodeInterleaved(const uint8_t* data, uint8_t* output, int* results);
+
+    // Syndrome kernels, the SIMD ones fall back to the generic kernel when they are not compiled in
+    static SyndromesFunc selectSyndromes();
+
+    static void syndromesGeneric(const uint8_t* data, uint8_t* accumulators);
+    static void syndromesSSSE3(const uint8_t* data, uint8_t* accumulators);
+    static void syndromesAVX2(const uint8_t* data, uint8_t* accumulators);
+    static void syndromesNEON(const uint8_t* data, uint8_t* accumulators);
+
+  public:
+    static constexpr int cInterleave = 4;
+
+  private:
+    // GF(256) of the code, log/antilog tables and the nibble tables of the SIMD kernels
+    struct GaloisField;
+    static const GaloisField& galoisField();
 
   private:
     correct_reed_solomon* mpReedSolomon;
+    SyndromesFunc mSyndromes;
     uint8_t mWorkBuffer[255];
     uint8_t mResultBuffer[255];
 
@@ -25,6 +51,8 @@ class ReedSolomon {
     static constexpr uint8_t cFirstRoot = 112;
     static constexpr uint8_t cRootGap = 11;
     static constexpr uint8_t cNRoots = 32;
+
+    alignas(32) uint8_t mAccumulators[cNRoots * 16];
 };
 
 #endif // REEDSOLOMON_H
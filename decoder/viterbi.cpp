@@ -1,11 +1,33 @@
 #include "viterbi.h"
 
+#include <algorithm>
+#include <bitset>
+
 Viterbi::Viterbi(int k, uint8_t polynomA, uint8_t polynomB)
-    : mpConvolutional(nullptr) {
+    : mpConvolutional(nullptr)
+    , mForward(nullptr)
+    , mPackHardBits(nullptr) {
     mPolynomials[0] = polynomA;
     mPolynomials[1] = polynomB;
 
     mpConvolutional = correct_convolutional_create(2, k, mPolynomials);
+
+    // The butterfly kernels need complementary branches, both polynomials must tap the newest and the oldest bit
+    const uint8_t butterflyTaps = 0x41;
+    if(k == 7 && (polynomA & butterflyTaps) == butterflyTaps && (polynomB & butterflyTaps) == butterflyTaps) {
+        mForward = ViterbiKernels::selectForward();
+        mPackHardBits = ViterbiKernels::selectHardBits();
+    }
+
+    for(int reg = 0; reg < 128; reg++) {
+        mOutputs[reg] = parity(reg & polynomA) | (parity(reg & polynomB) << 1);
+    }
+
+    // Old state j with input 0 gives the shift register 2j
+    for(int j = 0; j < ViterbiKernels::cStates / 2; j++) {
+        mBranchMasks[j] = (mOutputs[j * 2] & 1) ? 255 : 0;
+        mBranchMasks[j + 32] = (mOutputs[j * 2] & 2) ? 255 : 0;
+    }
 }
 
 Viterbi::~Viterbi() {
@@ -15,11 +37,16 @@ Viterbi::~Viterbi() {
 }
 
 size_t Viterbi::decodeSoft(const uint8_t* data, uint8_t* result, size_t blockSize) {
+    if(mForward != nullptr && blockSize % 64 == 0) {
+        return decodeSoftK7(data, result, blockSize);
+    }
+
     if(mpConvolutional == nullptr) {
         return -1;
     }
 
-    size_t reencodedSize = blockSize / 8;
+    // The encoder appends the flush bits of the shift register
+    size_t reencodedSize = (correct_convolutional_encode_len(mpConvolutional, blockSize / 16) + 7) / 8;
     if(mReencodedBuffer.size() != reencodedSize) {
         mReencodedBuffer.resize(reencodedSize);
     }
@@ -32,6 +59,57 @@ size_t Viterbi::decodeSoft(const uint8_t* data, uint8_t* result, size_t blockSiz
     return decodedBytes;
 }
 
+size_t Viterbi::decodeSoftK7(const uint8_t* data, uint8_t* result, size_t blockSize) {
+    const int steps = static_cast<int>(blockSize / 2);
+    const int words = static_cast<int>(blockSize / 64);
+
+    if(mDecisions.size() != static_cast<size_t>(steps)) {
+        mDecisions.resize(steps);
+        mReencodedBits.resize(words);
+        mHardBits.resize(words);
+        mValidBits.resize(words);
+    }
+
+    // The frames are cut from a continuous stream, every start state is equally likely
+    int16_t metrics[ViterbiKernels::cStates] = {};
+    mForward(data, steps, mBranchMasks, metrics, mDecisions.data());
+
+    // Trace back from the best end state instead of forcing the zero tail of a flushed message
+    int state = static_cast<int>(std::min_element(metrics, metrics + ViterbiKernels::cStates) - metrics);
+    uint8_t byte = 0;
+    uint64_t reencoded = 0;
+    for(int t = steps - 1; t >= 0; t--) {
+        const int bit = state & 1;
+        const int high = static_cast<int>(mDecisions[t] >> (bit * 32 + (state >> 1))) & 1;
+
+        byte |= bit << (7 - (t & 7));
+        if((t & 7) == 0) {
+            result[t >> 3] = byte;
+            byte = 0;
+        }
+
+        reencoded |= static_cast<uint64_t>(mOutputs[(high << 6) | state]) << ((t * 2) & 63);
+        if((t & 31) == 0) {
+            mReencodedBits[t >> 5] = reencoded;
+            reencoded = 0;
+        }
+
+        state = (state >> 1) | (high << 5);
+    }
+
+    // BER of the received hard decisions against the re-encoded path, erased soft bits are not counted
+    mPackHardBits(data, static_cast<int>(blockSize), mHardBits.data(), mValidBits.data());
+    size_t errors = 0;
+    size_t total = 0;
+    for(int i = 0; i < words; i++) {
+        errors += std::bitset<64>((mHardBits[i] ^ mReencodedBits[i]) & mValidBits[i]).count();
+        total += std::bitset<64>(mValidBits[i]).count();
+    }
+    mLastBER = total == 0 ? 0.0f : static_cast<float>(errors) / total;
+
+    return (steps + 7) / 8;
+}
+
 void Viterbi::calculateBer(const uint8_t* original, const uint8_t* reEncoded, ssize_t blockSize) {
     float errors = 0, total = 0;
     for(int i = 0; i < blockSize / 8; i++) {
@@ -8,6 +8,8 @@ extern "C" {
 #include "correct.h"
 }
 
+#include "viterbikernels.h"
+
 class Viterbi {
   public:
     Viterbi(int k = 7, uint8_t polynomA = 0x4F, uint8_t polynomB = 0x6D);
@@ -20,13 +22,32 @@ class Viterbi {
     }
 
   private:
+    size_t decodeSoftK7(const uint8_t* data, uint8_t* result, size_t blockSize);
     void calculateBer(const uint8_t* original, const uint8_t* reEncoded, ssize_t blockSize);
 
+    static int parity(uint32_t value) {
+        value ^= value >> 4;
+        value ^= value >> 2;
+        value ^= value >> 1;
+        return value & 1;
+    }
+
   private:
     correct_convolutional_polynomial_t mPolynomials[2];
     correct_convolutional* mpConvolutional;
     std::vector<uint8_t> mReencodedBuffer;
     float mLastBER = 0.0f;
+
+    // In-tree decoder, used instead of libcorrect for k = 7 codes that fit the butterfly kernels
+    ViterbiKernels::ForwardFunc mForward;
+    ViterbiKernels::HardBitsFunc mPackHardBits;
+    int16_t mBranchMasks[ViterbiKernels::cStates];
+    // Encoder output for every 7 bit shift register, polynomial A in bit 0
+    uint8_t mOutputs[128];
+    std::vector<uint64_t> mDecisions;
+    std::vector<uint64_t> mReencodedBits;
+    std::vector<uint64_t> mHardBits;
+    std::vector<uint64_t> mValidBits;
 };
 
 #endif // VITERBI_H
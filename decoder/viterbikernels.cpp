@@ -0,0 +1,377 @@
+#include "viterbikernels.h"
+
+#include <algorithm>
+
+#include "cpufeatures.h"
+
+#if defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ViterbiKernels {
+
+// A branch adds at most 2 * 255, the metrics are rebased to their minimum often enough to stay far from the int16 limit
+static constexpr int cRenormalizeInterval = 16;
+static constexpr int16_t cMaxBranchMetric = 2 * 255;
+
+ForwardFunc selectForward() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return forwardAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return forwardSSE2;
+    }
+#endif
+
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        return forwardNEON;
+    }
+#endif
+
+    (void)cpu;
+    return forwardGeneric;
+}
+
+HardBitsFunc selectHardBits() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+
+#if defined(CPU_X86)
+    if(cpu.hasAVX2()) {
+        return hardBitsAVX2;
+    }
+    if(cpu.hasSSE2()) {
+        return hardBitsSSE2;
+    }
+#endif
+
+    (void)cpu;
+    return hardBitsGeneric;
+}
+
+void forwardGeneric(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions) {
+    int16_t next[cStates];
+
+    for(int t = 0; t < steps; t++) {
+        uint64_t decision = 0;
+        for(int j = 0; j < cStates / 2; j++) {
+            const int16_t branch = static_cast<int16_t>((softBits[t * 2] ^ branchMasks[j]) + (softBits[t * 2 + 1] ^ branchMasks[j + 32]));
+            const int16_t inverse = cMaxBranchMetric - branch;
+
+            const int16_t evenLow = metrics[j] + branch;
+            const int16_t evenHigh = metrics[j + 32] + inverse;
+            const int16_t oddLow = metrics[j] + inverse;
+            const int16_t oddHigh = metrics[j + 32] + branch;
+
+            next[j * 2] = std::min(evenLow, evenHigh);
+            next[j * 2 + 1] = std::min(oddLow, oddHigh);
+            decision |= static_cast<uint64_t>(evenLow > evenHigh) << j;
+            decision |= static_cast<uint64_t>(oddLow > oddHigh) << (j + 32);
+        }
+        decisions[t] = decision;
+        std::copy(next, next + cStates, metrics);
+
+        if((t % cRenormalizeInterval) == cRenormalizeInterval - 1) {
+            const int16_t minimum = *std::min_element(metrics, metrics + cStates);
+            for(int s = 0; s < cStates; s++) {
+                metrics[s] -= minimum;
+            }
+        }
+    }
+}
+
+void hardBitsGeneric(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits) {
+    for(int i = 0; i < count; i += 64) {
+        uint64_t hard = 0;
+        uint64_t valid = 0;
+        for(int n = 0; n < 64; n++) {
+            hard |= static_cast<uint64_t>(softBits[i + n] > 128) << n;
+            valid |= static_cast<uint64_t>(softBits[i + n] != 128) << n;
+        }
+        hardBits[i / 64] = hard;
+        validBits[i / 64] = valid;
+    }
+}
+
+#if defined(CPU_X86)
+
+TARGET_SSE2 void forwardSSE2(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions) {
+    // Eight states per register, butterflies j and j + 32 are in registers g and g + 4
+    __m128i metric[8];
+    __m128i maskA[4];
+    __m128i maskB[4];
+    for(int g = 0; g < 8; g++) {
+        metric[g] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(metrics + g * 8));
+    }
+    for(int g = 0; g < 4; g++) {
+        maskA[g] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(branchMasks + g * 8));
+        maskB[g] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(branchMasks + 32 + g * 8));
+    }
+    const __m128i maxBranchMetric = _mm_set1_epi16(cMaxBranchMetric);
+
+    for(int t = 0; t < steps; t++) {
+        const __m128i softA = _mm_set1_epi16(softBits[t * 2]);
+        const __m128i softB = _mm_set1_epi16(softBits[t * 2 + 1]);
+        __m128i next[8];
+        __m128i evenDecision[4];
+        __m128i oddDecision[4];
+
+        for(int g = 0; g < 4; g++) {
+            // |soft - expected| is soft ^ 255 for an expected 1, the complementary branch costs the rest of the maximum
+            __m128i branch = _mm_add_epi16(_mm_xor_si128(softA, maskA[g]), _mm_xor_si128(softB, maskB[g]));
+            __m128i inverse = _mm_sub_epi16(maxBranchMetric, branch);
+
+            __m128i evenLow = _mm_add_epi16(metric[g], branch);
+            __m128i evenHigh = _mm_add_epi16(metric[g + 4], inverse);
+            __m128i oddLow = _mm_add_epi16(metric[g], inverse);
+            __m128i oddHigh = _mm_add_epi16(metric[g + 4], branch);
+
+            __m128i even = _mm_min_epi16(evenLow, evenHigh);
+            __m128i odd = _mm_min_epi16(oddLow, oddHigh);
+            evenDecision[g] = _mm_cmpgt_epi16(evenLow, evenHigh);
+            oddDecision[g] = _mm_cmpgt_epi16(oddLow, oddHigh);
+
+            // States 2j and 2j + 1 are neighbours
+            next[g * 2] = _mm_unpacklo_epi16(even, odd);
+            next[g * 2 + 1] = _mm_unpackhi_epi16(even, odd);
+        }
+
+        uint64_t even = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(evenDecision[0], evenDecision[1])))
+                        | (static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(evenDecision[2], evenDecision[3]))) << 16);
+        uint64_t odd = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(oddDecision[0], oddDecision[1])))
+                       | (static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(oddDecision[2], oddDecision[3]))) << 16);
+        decisions[t] = even | (odd << 32);
+
+        for(int g = 0; g < 8; g++) {
+            metric[g] = next[g];
+        }
+
+        if((t % cRenormalizeInterval) == cRenormalizeInterval - 1) {
+            __m128i minimum = metric[0];
+            for(int g = 1; g < 8; g++) {
+                minimum = _mm_min_epi16(minimum, metric[g]);
+            }
+            minimum = _mm_min_epi16(minimum, _mm_shuffle_epi32(minimum, 0x4E));
+            minimum = _mm_min_epi16(minimum, _mm_shuffle_epi32(minimum, 0xB1));
+            minimum = _mm_min_epi16(minimum, _mm_shufflehi_epi16(_mm_shufflelo_epi16(minimum, 0xB1), 0xB1));
+            for(int g = 0; g < 8; g++) {
+                metric[g] = _mm_sub_epi16(metric[g], minimum);
+            }
+        }
+    }
+
+    for(int g = 0; g < 8; g++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(metrics + g * 8), metric[g]);
+    }
+}
+
+TARGET_AVX2 void forwardAVX2(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions) {
+    // Sixteen states per register, butterflies j and j + 32 are in registers g and g + 2
+    __m256i metric[4];
+    __m256i maskA[2];
+    __m256i maskB[2];
+    for(int g = 0; g < 4; g++) {
+        metric[g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics + g * 16));
+    }
+    for(int g = 0; g < 2; g++) {
+        maskA[g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(branchMasks + g * 16));
+        maskB[g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(branchMasks + 32 + g * 16));
+    }
+    const __m256i maxBranchMetric = _mm256_set1_epi16(cMaxBranchMetric);
+
+    for(int t = 0; t < steps; t++) {
+        const __m256i softA = _mm256_set1_epi16(softBits[t * 2]);
+        const __m256i softB = _mm256_set1_epi16(softBits[t * 2 + 1]);
+        __m256i next[4];
+        __m256i evenDecision[2];
+        __m256i oddDecision[2];
+
+        for(int g = 0; g < 2; g++) {
+            __m256i branch = _mm256_add_epi16(_mm256_xor_si256(softA, maskA[g]), _mm256_xor_si256(softB, maskB[g]));
+            __m256i inverse = _mm256_sub_epi16(maxBranchMetric, branch);
+
+            __m256i evenLow = _mm256_add_epi16(metric[g], branch);
+            __m256i evenHigh = _mm256_add_epi16(metric[g + 2], inverse);
+            __m256i oddLow = _mm256_add_epi16(metric[g], inverse);
+            __m256i oddHigh = _mm256_add_epi16(metric[g + 2], branch);
+
+            __m256i even = _mm256_min_epi16(evenLow, evenHigh);
+            __m256i odd = _mm256_min_epi16(oddLow, oddHigh);
+            evenDecision[g] = _mm256_cmpgt_epi16(evenLow, evenHigh);
+            oddDecision[g] = _mm256_cmpgt_epi16(oddLow, oddHigh);
+
+            // The unpacks work within the 128 bit lanes, the permutes put the states back in order
+            __m256i low = _mm256_unpacklo_epi16(even, odd);
+            __m256i high = _mm256_unpackhi_epi16(even, odd);
+            next[g * 2] = _mm256_permute2x128_si256(low, high, 0x20);
+            next[g * 2 + 1] = _mm256_permute2x128_si256(low, high, 0x31);
+        }
+
+        __m256i even = _mm256_permute4x64_epi64(_mm256_packs_epi16(evenDecision[0], evenDecision[1]), 0xD8);
+        __m256i odd = _mm256_permute4x64_epi64(_mm256_packs_epi16(oddDecision[0], oddDecision[1]), 0xD8);
+        decisions[t] = static_cast<uint32_t>(_mm256_movemask_epi8(even)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(odd))) << 32);
+
+        for(int g = 0; g < 4; g++) {
+            metric[g] = next[g];
+        }
+
+        if((t % cRenormalizeInterval) == cRenormalizeInterval - 1) {
+            __m256i minimum256 = _mm256_min_epi16(_mm256_min_epi16(metric[0], metric[1]), _mm256_min_epi16(metric[2], metric[3]));
+            __m128i minimum = _mm_min_epi16(_mm256_castsi256_si128(minimum256), _mm256_extracti128_si256(minimum256, 1));
+            minimum = _mm_min_epi16(minimum, _mm_shuffle_epi32(minimum, 0x4E));
+            minimum = _mm_min_epi16(minimum, _mm_shuffle_epi32(minimum, 0xB1));
+            minimum = _mm_min_epi16(minimum, _mm_shufflehi_epi16(_mm_shufflelo_epi16(minimum, 0xB1), 0xB1));
+            minimum256 = _mm256_broadcastw_epi16(minimum);
+            for(int g = 0; g < 4; g++) {
+                metric[g] = _mm256_sub_epi16(metric[g], minimum256);
+            }
+        }
+    }
+
+    for(int g = 0; g < 4; g++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics + g * 16), metric[g]);
+    }
+}
+
+TARGET_SSE2 void hardBitsSSE2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits) {
+    const __m128i threshold = _mm_set1_epi8(static_cast<char>(129));
+    const __m128i erased = _mm_set1_epi8(static_cast<char>(128));
+
+    for(int i = 0; i < count; i += 64) {
+        uint64_t hard = 0;
+        uint64_t valid = 0;
+        for(int n = 0; n < 4; n++) {
+            __m128i soft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(softBits + i + n * 16));
+            // soft > 128 exactly where max(soft, 129) == soft
+            uint32_t hardMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(soft, threshold), soft)));
+            uint32_t erasedMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(soft, erased)));
+            hard |= static_cast<uint64_t>(hardMask) << (n * 16);
+            valid |= static_cast<uint64_t>(erasedMask ^ 0xFFFF) << (n * 16);
+        }
+        hardBits[i / 64] = hard;
+        validBits[i / 64] = valid;
+    }
+}
+
+TARGET_AVX2 void hardBitsAVX2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits) {
+    const __m256i threshold = _mm256_set1_epi8(static_cast<char>(129));
+    const __m256i erased = _mm256_set1_epi8(static_cast<char>(128));
+
+    for(int i = 0; i < count; i += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(softBits + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(softBits + i + 32));
+        uint32_t hardLow = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(low, threshold), low)));
+        uint32_t hardHigh = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(high, threshold), high)));
+        uint32_t erasedLow = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, erased)));
+        uint32_t erasedHigh = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, erased)));
+        hardBits[i / 64] = (static_cast<uint64_t>(hardHigh) << 32) | hardLow;
+        validBits[i / 64] = ~((static_cast<uint64_t>(erasedHigh) << 32) | erasedLow);
+    }
+}
+
+#else
+
+// Never selected, selectForward falls back to forwardGeneric
+void forwardSSE2(const uint8_t*, int, const int16_t*, int16_t*, uint64_t*) {}
+
+void forwardAVX2(const uint8_t*, int, const int16_t*, int16_t*, uint64_t*) {}
+
+void hardBitsSSE2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits) {
+    hardBitsGeneric(softBits, count, hardBits, validBits);
+}
+
+void hardBitsAVX2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits) {
+    hardBitsGeneric(softBits, count, hardBits, validBits);
+}
+
+#endif
+
+#if defined(CPU_NEON)
+
+// Bit i of the result is set when lane i of the 16 byte mask is set
+static inline uint16_t movemaskNEON(uint8x16_t mask) {
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(mask, vld1q_u8(weights)))));
+    return static_cast<uint16_t>(vgetq_lane_u64(sum, 0) | (vgetq_lane_u64(sum, 1) << 8));
+}
+
+void forwardNEON(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions) {
+    int16x8_t metric[8];
+    int16x8_t maskA[4];
+    int16x8_t maskB[4];
+    for(int g = 0; g < 8; g++) {
+        metric[g] = vld1q_s16(metrics + g * 8);
+    }
+    for(int g = 0; g < 4; g++) {
+        maskA[g] = vld1q_s16(branchMasks + g * 8);
+        maskB[g] = vld1q_s16(branchMasks + 32 + g * 8);
+    }
+    const int16x8_t maxBranchMetric = vdupq_n_s16(cMaxBranchMetric);
+
+    for(int t = 0; t < steps; t++) {
+        const int16x8_t softA = vdupq_n_s16(softBits[t * 2]);
+        const int16x8_t softB = vdupq_n_s16(softBits[t * 2 + 1]);
+        int16x8_t next[8];
+        uint8x8_t evenDecision[4];
+        uint8x8_t oddDecision[4];
+
+        for(int g = 0; g < 4; g++) {
+            int16x8_t branch = vaddq_s16(veorq_s16(softA, maskA[g]), veorq_s16(softB, maskB[g]));
+            int16x8_t inverse = vsubq_s16(maxBranchMetric, branch);
+
+            int16x8_t evenLow = vaddq_s16(metric[g], branch);
+            int16x8_t evenHigh = vaddq_s16(metric[g + 4], inverse);
+            int16x8_t oddLow = vaddq_s16(metric[g], inverse);
+            int16x8_t oddHigh = vaddq_s16(metric[g + 4], branch);
+
+            evenDecision[g] = vmovn_u16(vcgtq_s16(evenLow, evenHigh));
+            oddDecision[g] = vmovn_u16(vcgtq_s16(oddLow, oddHigh));
+
+            int16x8x2_t states = vzipq_s16(vminq_s16(evenLow, evenHigh), vminq_s16(oddLow, oddHigh));
+            next[g * 2] = states.val[0];
+            next[g * 2 + 1] = states.val[1];
+        }
+
+        uint64_t even = movemaskNEON(vcombine_u8(evenDecision[0], evenDecision[1])) | (static_cast<uint64_t>(movemaskNEON(vcombine_u8(evenDecision[2], evenDecision[3]))) << 16);
+        uint64_t odd = movemaskNEON(vcombine_u8(oddDecision[0], oddDecision[1])) | (static_cast<uint64_t>(movemaskNEON(vcombine_u8(oddDecision[2], oddDecision[3]))) << 16);
+        decisions[t] = even | (odd << 32);
+
+        for(int g = 0; g < 8; g++) {
+            metric[g] = next[g];
+        }
+
+        if((t % cRenormalizeInterval) == cRenormalizeInterval - 1) {
+            int16x8_t minimum8 = metric[0];
+            for(int g = 1; g < 8; g++) {
+                minimum8 = vminq_s16(minimum8, metric[g]);
+            }
+            int16x4_t minimum = vmin_s16(vget_low_s16(minimum8), vget_high_s16(minimum8));
+            minimum = vpmin_s16(minimum, minimum);
+            minimum = vpmin_s16(minimum, minimum);
+            minimum8 = vdupq_lane_s16(minimum, 0);
+            for(int g = 0; g < 8; g++) {
+                metric[g] = vsubq_s16(metric[g], minimum8);
+            }
+        }
+    }
+
+    for(int g = 0; g < 8; g++) {
+        vst1q_s16(metrics + g * 8, metric[g]);
+    }
+}
+
+#else
+
+// Never selected, selectForward falls back to forwardGeneric
+void forwardNEON(const uint8_t*, int, const int16_t*, int16_t*, uint64_t*) {}
+
+#endif
+
+} // namespace ViterbiKernels
@@ -0,0 +1,36 @@
+#ifndef VITERBIKERNELS_H
+#define VITERBIKERNELS_H
+
+#include <stdint.h>
+
+// Kernels of the in-tree Viterbi decoder for rate 1/2 codes with constraint length 7.
+// State s holds the last 6 input bits, the newest one in bit 0. New state 2j + b is reached from old state j or j + 32 with input bit b,
+// both generator polynomials must contain the oldest and the newest bit, so the two branches of a butterfly have complementary outputs.
+namespace ViterbiKernels {
+
+static constexpr int cStates = 64;
+
+// Add-compare-select over steps pairs of soft bits (0 is a confident 0, 255 a confident 1).
+// branchMasks: 0 or 255 per butterfly j, the expected output of polynomial A for old state j and input 0 in [0, 32), of polynomial B in [32, 64).
+// metrics: the 64 path metrics, updated in place. decisions[t] bit (b * 32 + j) is set when state 2j + b came from old state j + 32.
+typedef void (*ForwardFunc)(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions);
+
+// Packs count soft bits (multiple of 64) into hard decisions (soft > 128) and non erased flags (soft != 128), bit n in word n / 64, bit n % 64
+typedef void (*HardBitsFunc)(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits);
+
+// Return the generic kernels when the CPU has no supported SIMD extension
+ForwardFunc selectForward();
+HardBitsFunc selectHardBits();
+
+void forwardGeneric(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions);
+void forwardSSE2(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions);
+void forwardAVX2(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions);
+void forwardNEON(const uint8_t* softBits, int steps, const int16_t* branchMasks, int16_t* metrics, uint64_t* decisions);
+
+void hardBitsGeneric(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits);
+void hardBitsSSE2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits);
+void hardBitsAVX2(const uint8_t* softBits, int count, uint64_t* hardBits, uint64_t* validBits);
+
+} // namespace ViterbiKernels
+
+#endif // VITERBIKERNELS_H
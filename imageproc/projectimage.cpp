@@ -171,6 +171,11 @@ cv::Mat ProjectImage::project(const cv::Mat& image) {
     cv::Mat newImage;
     cv::remap(image, newImage, mMapX, mMapY, cv::INTER_LINEAR);
 
+    // Single channel images are remapped as they are, the map overlay is drawn in colour
+    if(newImage.channels() == 1) {
+        cv::cvtColor(newImage, newImage, cv::COLOR_GRAY2BGR);
+    }
+
     drawMapOverlay(newImage);
 
     return newImage;
@@ -19,19 +19,23 @@ void ThreatImage::fillBlackLines(cv::Mat& bitmap, int minimumHeight, int maximum
     int start = 0;
     int end;
     bool found = false;
+    const int channels = bitmap.channels();
 
     for(int x = 0; x < bitmap.size().width; x += SCAN_WIDTH) {
         for(int y = 0; y < bitmap.size().height; y++) {
-            const cv::Vec3b& pixel = bitmap.at<cv::Vec3b>(y, x + 4);
+            // Check 4th one, first column on image is black
+            const uint8_t* pixel = bitmap.ptr<uint8_t>(y) + (x + 4) * channels;
+            bool black = false;
+            for(int c = 0; c < channels; c++) {
+                black |= pixel[c] == 0;
+            }
 
-            if(!found && (pixel[0] == 0 || pixel[1] == 0 || pixel[2] == 0)) // Check 4th one, first column on image is black
-            {
+            if(!found && black) {
                 found = true;
                 start = y;
             }
 
-            if(found && pixel[0] != 0 && pixel[1] != 0 && pixel[2] != 0) // Check 4th one, first column on image is black
-            {
+            if(found && !black) {
                 found = false;
                 end = y;
                 if((end - start) >= minimumHeight && (end - start) <= maximumHeight) {
@@ -50,11 +54,13 @@ cv::Mat ThreatImage::irToTemperature(const cv::Mat& irImage, const cv::Mat& ref)
         return cv::Mat();
     }
 
-    cv::Mat thermalImage = cv::Mat::zeros(irImage.size(), irImage.type());
+    cv::Mat thermalImage = cv::Mat::zeros(irImage.size(), CV_8UC3);
+    const int channels = irImage.channels();
 
-    for(int x = 0; x < irImage.cols; x++) {
-        for(int y = 0; y < irImage.rows; y++) {
-            uint8_t temp = irImage.at<cv::Vec3b>(y, x)[0];
+    for(int y = 0; y < irImage.rows; y++) {
+        const uint8_t* ir = irImage.ptr<uint8_t>(y);
+        for(int x = 0; x < irImage.cols; x++) {
+            uint8_t temp = ir[x * channels];
             thermalImage.at<cv::Vec3b>(y, x) = ref.at<cv::Vec3b>(0, temp);
         }
     }
@@ -66,20 +72,21 @@ cv::Mat ThreatImage::irToRain(const cv::Mat& irImage, const cv::Mat& ref) {
         return cv::Mat();
     }
 
-    cv::Mat rainImage = cv::Mat::zeros(irImage.size(), irImage.type());
+    cv::Mat rainImage = cv::Mat::zeros(irImage.size(), CV_8UC3);
+    const int channels = irImage.channels();
 
-    for(int x = 0; x < irImage.cols; x++) {
-        for(int y = 0; y < irImage.rows; y++) {
-            uint8_t temp = irImage.at<cv::Vec3b>(y, x)[0];
+    for(int y = 0; y < irImage.rows; y++) {
+        const uint8_t* ir = irImage.ptr<uint8_t>(y);
+        for(int x = 0; x < irImage.cols; x++) {
+            uint8_t temp = ir[x * channels];
             rainImage.at<cv::Vec3b>(y, x) = ref.at<cv::Vec3b>(0, temp);
         }
     }
 
-    cv::Mat result = cv::Mat::zeros(irImage.size(), irImage.type());
-    cv::Mat grayScale;
+    cv::Mat result = cv::Mat::zeros(irImage.size(), CV_8UC3);
+    cv::Mat grayScale = toGray(irImage);
     cv::Mat alpha;
 
-    cv::cvtColor(irImage, grayScale, cv::COLOR_BGR2GRAY);
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(grayScale, contours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
     for(std::size_t i = 0; i < contours.size(); i++) {
@@ -98,10 +105,10 @@ cv::Mat ThreatImage::irToRain(const cv::Mat& irImage, const cv::Mat& ref) {
 
 cv::Mat ThreatImage::invertIR(const cv::Mat& image) {
     cv::Mat result = cv::Mat::zeros(image.size(), image.type());
-    cv::Mat grayScale;
+    cv::Mat grayScale = toGray(image);
     cv::Mat alpha;
+    cv::Mat inverted;
 
-    cv::cvtColor(image, grayScale, cv::COLOR_BGR2GRAY);
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(grayScale, contours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
     for(std::size_t i = 0; i < contours.size(); i++) {
@@ -111,17 +118,22 @@ cv::Mat ThreatImage::invertIR(const cv::Mat& image) {
     // create mask
     cv::threshold(grayScale, alpha, 0, 255, cv::THRESH_BINARY);
 
-    // invert colors
-    cv::bitwise_not(image, image);
+    // invert colors, image may be a view of the decoder's channel, it is not touched
+    cv::bitwise_not(image, inverted);
 
     // apply mask
-    cv::bitwise_and(image, image, result, alpha);
+    cv::bitwise_and(inverted, inverted, result, alpha);
 
     return result;
 }
 
 cv::Mat ThreatImage::addRainOverlay(const cv::Mat& image, const cv::Mat& rain) {
-    cv::Mat rainImage = cv::Mat::zeros(image.size(), image.type());
+    cv::Mat colorImage = image;
+    if(image.channels() == 1) {
+        cv::cvtColor(image, colorImage, cv::COLOR_GRAY2BGR);
+    }
+
+    cv::Mat rainImage = cv::Mat::zeros(colorImage.size(), colorImage.type());
     cv::Mat grayScale;
     cv::Mat alpha;
 
@@ -130,7 +142,7 @@ cv::Mat ThreatImage::addRainOverlay(const cv::Mat& image, const cv::Mat& rain) {
     cv::threshold(grayScale, alpha, 0, 255, cv::THRESH_BINARY);
 
     // create masked image
-    cv::bitwise_and(image, image, rainImage, cv::Scalar::all(1.0) - alpha);
+    cv::bitwise_and(colorImage, colorImage, rainImage, cv::Scalar::all(1.0) - alpha);
 
     // add rain overlay
     cv::bitwise_and(rain, rain, rainImage, alpha);
@@ -162,6 +174,13 @@ cv::Mat ThreatImage::sharpen(const cv::Mat& image) {
 cv::Mat ThreatImage::equalize(const cv::Mat& image) {
     cv::Mat ycrcb;
 
+    // Same as the luma of a gray BGR image
+    if(image.channels() == 1) {
+        cv::Mat result;
+        cv::equalizeHist(image, result);
+        return result;
+    }
+
     cv::cvtColor(image, ycrcb, cv::COLOR_BGR2YCrCb);
 
     std::vector<cv::Mat> channels;
@@ -253,7 +272,12 @@ bool ThreatImage::isNightPass(const cv::Mat& image, float treshold) {
     if(image.size().width > 0 && image.size().height > 0) {
         cv::Scalar result = cv::mean(image);
 
-        if(result[0] < treshold && result[1] < treshold && result[2] < treshold) {
+        bool dark = true;
+        for(int c = 0; c < image.channels(); c++) {
+            dark &= result[c] < treshold;
+        }
+
+        if(dark) {
             std::cout << "Night pass mean calculation, CH1:" << result[0] << " CH2:" << result[1] << " CH3:" << result[2] << std::endl;
             return true;
         }
@@ -263,24 +287,36 @@ bool ThreatImage::isNightPass(const cv::Mat& image, float treshold) {
 
 void ThreatImage::fill(cv::Mat& image, int x, int start, int end) {
     int blankHeight = end - start;
+    const int channels = image.channels();
 
     for(int i = 0; i < SCAN_WIDTH; i++) {
         for(int y = start, z = 0; z < (blankHeight / 2) + 1; y++, z++) {
-            const cv::Vec3b& color1 = image.at<cv::Vec3b>(start - z - 1, x + i);
-            const cv::Vec3b& color2 = image.at<cv::Vec3b>(end + z + 1, x + i);
+            const uint8_t* color1 = image.ptr<uint8_t>(start - z - 1) + (x + i) * channels;
+            const uint8_t* color2 = image.ptr<uint8_t>(end + z + 1) + (x + i) * channels;
+            uint8_t* top = image.ptr<uint8_t>(y) + (x + i) * channels;
+            uint8_t* bottom = image.ptr<uint8_t>(end - z) + (x + i) * channels;
 
             float alpha = static_cast<float>(z) / blankHeight;
-            image.at<cv::Vec3b>(y, x + i) = blend(color2, color1, alpha);
-            image.at<cv::Vec3b>(end - z, x + i) = blend(color1, color2, alpha);
+            for(int c = 0; c < channels; c++) {
+                top[c] = blend(color2[c], color1[c], alpha);
+                bottom[c] = blend(color1[c], color2[c], alpha);
+            }
         }
     }
 }
 
-cv::Vec3b ThreatImage::blend(const cv::Vec3b& color, const cv::Vec3b& backColor, float amount) {
-    uint8_t r = static_cast<uint8_t>((color[2] * amount) + backColor[2] * (1 - amount));
-    uint8_t g = static_cast<uint8_t>((color[1] * amount) + backColor[1] * (1 - amount));
-    uint8_t b = static_cast<uint8_t>((color[0] * amount) + backColor[0] * (1 - amount));
-    return cv::Vec3b(b, g, r);
+uint8_t ThreatImage::blend(uint8_t color, uint8_t backColor, float amount) {
+    return static_cast<uint8_t>((color * amount) + backColor * (1 - amount));
+}
+
+cv::Mat ThreatImage::toGray(const cv::Mat& image) {
+    cv::Mat grayScale;
+    if(image.channels() == 1) {
+        grayScale = image.clone();
+    } else {
+        cv::cvtColor(image, grayScale, cv::COLOR_BGR2GRAY);
+    }
+    return grayScale;
 }
 
 void ThreatImage::replaceAll(std::string& str, const std::string& from, const std::string& to) {
@@ -26,7 +26,9 @@ class ThreatImage {
 
   private:
     static void fill(cv::Mat& image, int x, int start, int end);
-    static cv::Vec3b blend(const cv::Vec3b& color, const cv::Vec3b& backColor, float amount);
+    static uint8_t blend(uint8_t color, uint8_t backColor, float amount);
+    // A grayscale copy of a CV_8UC1 or CV_8UC3 image
+    static cv::Mat toGray(const cv::Mat& image);
     static void replaceAll(std::string& str, const std::string& from, const std::string& to);
 
   private:
@@ -10,11 +10,15 @@
 #include <tuple>
 
 #include "DSP/meteordemodulator.h"
+#include "DSP/rawiqreader.h"
 #include "DSP/wavreader.h"
 #include "GIS/shapereader.h"
 #include "GIS/shaperenderer.h"
 #include "blendimages.h"
+#include "blockingqueue.h"
 #include "meteordecoder.h"
+#include "modedetector.h"
+#include "passstatistics.h"
 #include "pixelgeolocationcalculator.h"
 #include "projectimage.h"
 #include "protocol/lrpt/decoder.h"
@@ -46,14 +50,49 @@ struct ImageSearchResult {
     std::list<cv::Mat> images68;
 };
 
+enum class PassResult { Done, NoData, NoChannelData, NoTLE, Failed };
+
+// Everything a pass needs from the settings, resolved before the pass is scheduled so concurrent passes share no state
+struct PassJob {
+    std::string inputPath;
+    std::string outputPath;
+    std::string satelliteName;
+    Settings::ProjectionSetting projectionSetting;
+    DateTime passDate;
+    int decoderThreads;
+};
+
+// Writes the statistics of a pass as a .json report when the pass ends, whichever way it ends
+struct PassReport {
+    ~PassReport() {
+        if(imagesStarted) {
+            statistics.images.add(0, imagesStart);
+        }
+
+        std::ofstream reportStream(path);
+        if(reportStream) {
+            statistics.writeJson(reportStream);
+        }
+    }
+
+    PassStatistics statistics;
+    std::string path;
+    std::chrono::steady_clock::time_point imagesStart;
+    bool imagesStarted = false;
+};
+
+PassJob createPassJob(const std::string& inputPath, bool batch = false);
+PassResult processPass(const PassJob& job);
+void processBatch(const std::string& batchPath);
+std::vector<std::string> collectBatchInputs(const std::string& batchPath);
 ImageSearchResult searchForImages();
 void saveImage(const std::string fileName, const cv::Mat& image);
-void writeSymbolToFile(std::ostream& stream, const Wavreader::complex& sample);
+void quantizeSymbols(const Wavreader::complex* symbols, int count, uint8_t* softBits);
+void demodulateAndDecode(DSP::MeteorDemodulator& demodulator, DSP::IQSoruce& source, MeteorDecoder& decoder, std::ostream* symbolStream);
+bool detectMode(std::istream& softBitsStream, int threads, ModeDetector::Mode& mode);
 
 static std::mutex saveImageMutex;
 static Settings& mSettings = Settings::getInstance();
-static ThreadPool mThreadPool(std::thread::hardware_concurrency());
-static decoder::protocol::lrpt::Decoder mLrptDecoder;
 
 using APID = decoder::protocol::lrpt::Decoder::APIDs;
 
@@ -71,396 +110,16 @@ int main(int argc, char* argv[]) {
         throw std::runtime_error("Satellite name is not given in command line arguments!");
     }
 
-    mThreadPool.start();
-
-    MeteorDecoder meteorDecoder(mSettings.deInterleave(), mSettings.getDemodulatorMode() == "oqpsk", mSettings.differentialDecode());
-
-    size_t decodedPacketCounter = 0;
-    std::string inputPath = mSettings.getInputFilePath();
-    try {
-        if(inputPath.substr(inputPath.find_last_of(".") + 1) == "wav") {
-            std::cout << "Input is a .wav file, processing it..." << std::endl;
-
-            const std::string outputPath = inputPath.substr(0, inputPath.find_last_of(".") + 1) + "s";
-            std::ofstream outputStream;
-            outputStream.open(outputPath, std::ios::binary);
-
-            if(!outputStream.is_open()) {
-                throw std::runtime_error("Creating output .S file failed, demodulating aborted");
-            }
-
-            Wavreader wavReader;
-            if(!wavReader.openFile(inputPath)) {
-                throw std::runtime_error("Opening .wav file failed, demodulating aborted");
-            }
-
-            DSP::MeteorCostas::Mode mode = DSP::MeteorCostas::QPSK;
-            if(mSettings.getDemodulatorMode() == "oqpsk") {
-                mode = DSP::MeteorCostas::OQPSK;
-            }
-
-
-            DSP::MeteorDemodulator demodulator(mode, mSettings.getSymbolRate(), mSettings.getCostasBandwidth(), mSettings.getRRCFilterOrder(), mSettings.waitForlock(), mSettings.getBrokenModulation());
-            demodulator.process(wavReader, [&outputStream](const Wavreader::complex& sample, float) {
-                writeSymbolToFile(outputStream, sample);
-            });
-
-            outputStream.flush();
-            outputStream.close();
-            inputPath = outputPath;
-        }
-
-        if(inputPath.substr(inputPath.find_last_of(".") + 1) == "cadu") {
-            std::cout << "Input is a .cadu file, processing it..." << std::endl;
-
-            std::ifstream caduBitsStream(inputPath, std::ifstream::binary);
-            if(!caduBitsStream) {
-                throw std::runtime_error("Opening input file failed");
-            }
-
-            uint8_t caduBuffer[1024];
-            while(!caduBitsStream.eof()) {
-                caduBitsStream.read(reinterpret_cast<char*>(caduBuffer), sizeof(caduBuffer));
-                if(caduBitsStream.gcount() == sizeof(caduBuffer)) {
-                    mLrptDecoder.process(caduBuffer);
-                    std::cout << "Number of readed cadu: " << (decodedPacketCounter++) + 1 << "\t\t\r" << std::endl;
-                }
-            }
-            std::cout << std::endl;
-
-            if(caduBitsStream && caduBitsStream.is_open()) {
-                caduBitsStream.close();
-            }
-        } else {
-            std::ifstream softbitsStream(inputPath, std::ifstream::binary);
-            if(!softbitsStream) {
-                throw std::runtime_error("Opening input file failed");
-            }
-
-            const std::string outputPath = inputPath.substr(0, inputPath.find_last_of(".") + 1) + "cadu";
-            std::ofstream caduFileStream;
-            caduFileStream.open(outputPath, std::ios::binary);
-
-            softbitsStream.seekg(0, softbitsStream.end);
-            int64_t fileLength = softbitsStream.tellg();
-            softbitsStream.seekg(0, softbitsStream.beg);
-
-            auto softBits = std::make_unique<uint8_t[]>(fileLength);
-
-            softbitsStream.read(reinterpret_cast<char*>(softBits.get()), fileLength);
-            decodedPacketCounter = meteorDecoder.decode(softBits.get(), fileLength, [&caduFileStream](const uint8_t* cadu, std::size_t size) {
-                if(size == 1024) {
-                    mLrptDecoder.process(cadu);
-                    caduFileStream.write(reinterpret_cast<const char*>(cadu), size);
-                }
-            });
-
-            if(softbitsStream && softbitsStream.is_open()) {
-                softbitsStream.close();
-            }
-            if(caduFileStream && caduFileStream.is_open()) {
-                caduFileStream.close();
-            }
-        }
-    } catch(const std::exception& ex) {
-        std::cout << ex.what() << std::endl;
-    }
-
-    if(decodedPacketCounter == 0) {
-        std::cout << "No data received, try to make composite images" << std::endl;
-    } else {
-        // std::cout << "Decoded packets:" << decodedPacketCounter << std::endl;
-
-        DateTime passStart;
-        DateTime passDate = mSettings.getPassDate();
-        TimeSpan passStartTime = mLrptDecoder.getFirstTimeStamp();
-        TimeSpan passLength = mLrptDecoder.getLastTimeStamp() - passStartTime;
-
-        float timeOffset = mSettings.getProjectionSetting(mSettings.getSateliteName()).timeOffsetMs;
-        passStartTime = passStartTime.Add(TimeSpan(0, 0, 0, 0, static_cast<int>(timeOffset * 1000)));
-        passLength = passLength.Add(TimeSpan(0, 0, 0, 0, static_cast<int>(timeOffset * 1000)));
-
-        passDate = passDate.AddHours(3); // Convert UTC 0 to Moscow time zone (UTC + 3)
-
-        // Satellite's date time
-        passStart.Initialise(passDate.Year(), passDate.Month(), passDate.Day(), passStartTime.Hours(), passStartTime.Minutes(), passStartTime.Seconds(), passStartTime.Microseconds());
-        // Convert satellite's Moscow time zone to UTC 0
-        passStart = passStart.AddHours(-3);
-
-        std::string fileNameDate = std::to_string(passStart.Year()) + "-" + std::to_string(passStart.Month()) + "-" + std::to_string(passStart.Day()) + "-" + std::to_string(passStart.Hour()) + "-" + std::to_string(passStart.Minute()) + "-"
-                                   + std::to_string(passStart.Second());
-
-        std::ofstream datFileStream(mSettings.getOutputPath() + fileNameDate + ".dat");
-        if(datFileStream) {
-            datFileStream << mSettings.getSateliteName() << std::endl;
-            datFileStream << std::to_string(passStart.Ticks()) << std::endl;
-            datFileStream << std::to_string(passLength.Ticks()) << std::endl;
-            datFileStream.close();
-        }
-
-        std::list<ImageForSpread> imagesToSpread;
-
-        if(mLrptDecoder.isChannel64Available() && mLrptDecoder.isChannel65Available() && mLrptDecoder.isChannel68Available()) {
-            cv::Mat threatedImage1 = mLrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
-            cv::Mat irImage = mLrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
-            cv::Mat threatedImage2 = mLrptDecoder.getRGBImage(APID::APID64, APID::APID65, APID::APID68, mSettings.fillBackLines());
-
-            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-            cv::Mat rainOverlay = ThreatImage::irToRain(irImage, rainRef);
-
-            if(!ThreatImage::isNightPass(threatedImage1, mSettings.getNightPassTreshold())) {
-                threatedImage1 = ThreatImage::sharpen(threatedImage1);
-                threatedImage2 = ThreatImage::sharpen(threatedImage2);
-
-                imagesToSpread.push_back(ImageForSpread(threatedImage1, "221_"));
-                imagesToSpread.push_back(ImageForSpread(threatedImage2, "125_"));
-
-                if(mSettings.addRainOverlay()) {
-                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(threatedImage1, rainOverlay), "rain_221_"));
-                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(threatedImage2, rainOverlay), "rain_125_"));
-                }
-
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_221.bmp", threatedImage1);
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_125.bmp", threatedImage2);
-            } else {
-                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
-            }
-
-            cv::Mat ch64 = mLrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
-            cv::Mat ch65 = mLrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
-            cv::Mat ch68 = mLrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
-
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_64.bmp", ch64);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_65.bmp", ch65);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_68.bmp", ch68);
-
-            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
-            cv::Mat thermalImage = ThreatImage::irToTemperature(irImage, thermalRef);
-            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
-
-            irImage = ThreatImage::invertIR(irImage);
-            irImage = ThreatImage::gamma(irImage, 1.4);
-            irImage = ThreatImage::contrast(irImage, 1.3, -40);
-            irImage = ThreatImage::sharpen(irImage);
-            imagesToSpread.push_back(ImageForSpread(irImage, "68_"));
-
-            if(mSettings.addRainOverlay()) {
-                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(irImage, rainOverlay), "rain_68_"));
-            }
-
-        } else if(mLrptDecoder.isChannel64Available() && mLrptDecoder.isChannel65Available() && mLrptDecoder.isChannel67Available()) {
-            cv::Mat ch64 = mLrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
-            cv::Mat ch65 = mLrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
-            cv::Mat ch67 = mLrptDecoder.getChannelImage(APID::APID67, mSettings.fillBackLines());
-            cv::Mat irImage = mLrptDecoder.getChannelImage(APID::APID67, mSettings.fillBackLines());
-
-            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-            cv::Mat rainOverlay = ThreatImage::irToRain(irImage, rainRef);
-
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_64.bmp", ch64);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_65.bmp", ch65);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_67.bmp", ch67);
-
-            irImage = ThreatImage::equalize(irImage);
-            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
-            cv::Mat thermalImage = ThreatImage::irToTemperature(irImage, thermalRef);
-            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
-
-            irImage = ThreatImage::invertIR(irImage);
-            imagesToSpread.push_back(ImageForSpread(irImage, "67_"));
-
-            if(mSettings.addRainOverlay()) {
-                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(irImage, rainOverlay), "rain_67_"));
-            }
-            cv::Mat image221 = mLrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
-            cv::Mat image224 = mLrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID67, mSettings.fillBackLines());
-
-            if(!ThreatImage::isNightPass(image221, mSettings.getNightPassTreshold())) {
-                image221 = ThreatImage::sharpen(image221);
-                image224 = ThreatImage::sharpen(image224);
-
-                imagesToSpread.push_back(ImageForSpread(image221, "221_"));
-                imagesToSpread.push_back(ImageForSpread(image224, "224_"));
-
-
-                if(mSettings.addRainOverlay()) {
-                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(image221, rainOverlay), "rain_221_"));
-                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(image224, rainOverlay), "rain_224_"));
-                }
-
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_221.bmp", image221);
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_224.bmp", image224);
-            } else {
-                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
-            }
-
-        } else if(mLrptDecoder.isChannel64Available() && mLrptDecoder.isChannel65Available() && mLrptDecoder.isChannel66Available()) {
-            cv::Mat threatedImage1 = mLrptDecoder.getRGBImage(APID::APID66, APID::APID65, APID::APID64, mSettings.fillBackLines());
-            cv::Mat threatedImage2 = mLrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
-
-            if(!ThreatImage::isNightPass(threatedImage1, mSettings.getNightPassTreshold())) {
-                threatedImage1 = ThreatImage::sharpen(threatedImage1);
-                threatedImage2 = ThreatImage::sharpen(threatedImage2);
-
-                imagesToSpread.push_back(ImageForSpread(threatedImage1, "321_"));
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_321.bmp", threatedImage1);
-
-                imagesToSpread.push_back(ImageForSpread(threatedImage2, "221_"));
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_221.bmp", threatedImage2);
-            } else {
-                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
-            }
-
-            mLrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
-            mLrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
-            mLrptDecoder.getChannelImage(APID::APID66, mSettings.fillBackLines());
-
-            cv::Mat ch64 = mLrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
-            cv::Mat ch65 = mLrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
-            cv::Mat ch66 = mLrptDecoder.getChannelImage(APID::APID66, mSettings.fillBackLines());
-
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_64.bmp", ch64);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_65.bmp", ch65);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_66.bmp", ch66);
-        } else if(mLrptDecoder.isChannel67Available() && mLrptDecoder.isChannel68Available() && mLrptDecoder.isChannel69Available()) {
-            cv::Mat ch67 = mLrptDecoder.getChannelImage(APID::APID67, mSettings.fillBackLines());
-            cv::Mat ch68 = mLrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
-            cv::Mat ch69 = mLrptDecoder.getChannelImage(APID::APID69, mSettings.fillBackLines());
-            cv::Mat ch654 = mLrptDecoder.getRGBImage(APID::APID67, APID::APID68, APID::APID69, mSettings.fillBackLines());
-
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_67.bmp", ch67);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_68.bmp", ch68);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_69.bmp", ch69);
-
-            imagesToSpread.push_back(ImageForSpread(ch654, "654_"));
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_654.bmp", ch654);
-
-            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
-            cv::Mat thermalImage = ThreatImage::irToTemperature(ch68, thermalRef);
-            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
-
-            ch68 = ThreatImage::invertIR(ch68);
-            ch68 = ThreatImage::gamma(ch68, 1.4);
-            ch68 = ThreatImage::contrast(ch68, 1.3, -40);
-            ch68 = ThreatImage::sharpen(ch68);
-            imagesToSpread.push_back(ImageForSpread(ch68, "68_"));
-
-            if(mSettings.addRainOverlay()) {
-                cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-                cv::Mat rainOverlay = ThreatImage::irToRain(ch68, rainRef);
-                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(ch68, rainOverlay), "rain_68_"));
-            }
-
-        } else if(mLrptDecoder.isChannel64Available() && mLrptDecoder.isChannel65Available()) {
-            cv::Mat threatedImage = mLrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
-
-            if(!ThreatImage::isNightPass(threatedImage, mSettings.getNightPassTreshold())) {
-                threatedImage = ThreatImage::sharpen(threatedImage);
-
-                imagesToSpread.push_back(ImageForSpread(threatedImage, "221_"));
-                saveImage(mSettings.getOutputPath() + fileNameDate + "_221.bmp", threatedImage);
-            } else {
-                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
-            }
-
-            cv::Mat ch64 = mLrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
-            cv::Mat ch65 = mLrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
-
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_64.bmp", ch64);
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_65.bmp", ch65);
-        } else if(mLrptDecoder.isChannel68Available()) {
-            cv::Mat ch68 = mLrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
-            saveImage(mSettings.getOutputPath() + fileNameDate + "_68.bmp", ch68);
-
-            if(mSettings.addRainOverlay()) {
-                cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-                cv::Mat rainOverlay = ThreatImage::irToRain(ch68, rainRef);
-                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(ch68, rainOverlay), "rain_68_"));
-            }
-
-            ch68 = ThreatImage::invertIR(ch68);
-            ch68 = ThreatImage::gamma(ch68, 1.4);
-            ch68 = ThreatImage::contrast(ch68, 1.3, -40);
-            ch68 = ThreatImage::sharpen(ch68);
-            imagesToSpread.push_back(ImageForSpread(ch68, "68_"));
-
-            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
-            cv::Mat thermalImage = ThreatImage::irToTemperature(ch68, thermalRef);
-            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
-        } else {
-            std::cout << "No usable channel data found!" << std::endl;
-
+    if(mSettings.getBatchPath().empty()) {
+        PassResult result = processPass(createPassJob(mSettings.getInputFilePath()));
+        if(result == PassResult::NoChannelData) {
             return 0;
         }
-
-        TleReader reader(mSettings.getTlePath());
-        TleReader::TLE tle;
-        reader.processFile();
-        auto projectionSetting = mSettings.getProjectionSetting(mSettings.getSateliteName());
-        if(!reader.getTLE(projectionSetting.satelliteNameInTLE, tle)) {
-            std::cout << "TLE data not found in TLE file, unable to create projected images..." << std::endl;
+        if(result == PassResult::NoTLE) {
             return -1;
         }
-
-        PixelGeolocationCalculator calc(
-            tle, passStart, passLength, projectionSetting.scanAngle, projectionSetting.roll, projectionSetting.pitch, projectionSetting.yaw, imagesToSpread.front().image.size().width, imagesToSpread.front().image.size().height);
-
-        std::ostringstream oss;
-        oss << std::setfill('0') << std::setw(2) << passStart.Day() << "/" << std::setw(2) << passStart.Month() << "/" << passStart.Year() << " " << std::setw(2) << passStart.Hour() << ":" << std::setw(2) << passStart.Minute() << ":"
-            << std::setw(2) << passStart.Second() << " UTC";
-        std::string dateStr = oss.str();
-        std::string satelliteName = decoder::protocol::lrpt::Decoder::serialNumberToSatName(mLrptDecoder.getSerialNumber());
-
-
-        ProjectImage rectifier(ProjectImage::Projection::Rectify, calc, mSettings.getProjectionScale());
-        ProjectImage mercatorProjector(ProjectImage::Projection::Mercator, calc, mSettings.getProjectionScale());
-        ProjectImage equdistantProjector(ProjectImage::Projection::Equidistant, calc, mSettings.getProjectionScale());
-
-        if(mSettings.spreadImage()) {
-            rectifier.calculateTransformation(imagesToSpread.front().image.size());
-        }
-
-        if(mSettings.mercatorProjection()) {
-            std::cout << "Calculate Mercator TPS" << std::endl;
-            mercatorProjector.calculateTransformation(imagesToSpread.front().image.size());
-            std::cout << "Calculate Mercator TPS Done" << std::endl;
-        }
-
-        if(mSettings.equadistantProjection()) {
-            std::cout << "Calculate Equidistant TPS" << std::endl;
-            equdistantProjector.calculateTransformation(imagesToSpread.front().image.size());
-            std::cout << "Calculate Equidistant Done" << std::endl;
-        }
-        std::list<ImageForSpread>::const_iterator it;
-        for(const auto& img : imagesToSpread) {
-            std::string fileName = img.fileNameBase + fileNameDate + "." + mSettings.getOutputFormat();
-
-            if(mSettings.spreadImage()) {
-                cv::Mat spreaded = rectifier.project(img.image);
-                ThreatImage::drawWatermark(spreaded, dateStr, satelliteName);
-                const std::string filePath = mSettings.getOutputPath() + std::string("spread_") + fileName;
-                std::cout << "Saving " << filePath << std::endl;
-                saveImage(filePath, spreaded);
-            }
-
-            if(mSettings.mercatorProjection()) {
-                cv::Mat mercator = mercatorProjector.project(img.image);
-                ThreatImage::drawWatermark(mercator, dateStr, satelliteName);
-                const std::string filePath = mSettings.getOutputPath() + std::string("mercator_") + fileName;
-                std::cout << "Saving " << filePath << std::endl;
-                saveImage(filePath, mercator);
-            }
-
-            if(mSettings.equadistantProjection()) {
-                cv::Mat equidistant = equdistantProjector.project(img.image);
-                ThreatImage::drawWatermark(equidistant, dateStr, satelliteName);
-                const std::string filePath = mSettings.getOutputPath() + std::string("equidistant_") + fileName;
-                std::cout << "Saving " << filePath << std::endl;
-                saveImage(filePath, equidistant);
-            }
-        }
-
-        std::cout << "Save images done" << std::endl;
+    } else {
+        processBatch(mSettings.getBatchPath());
     }
 
     std::cout << "Generate composite images" << std::endl;
@@ -597,20 +256,171 @@ int main(int argc, char* argv[]) {
     if(mSettings.generateComposite224()) {
         if(images.images224.size() > 1) {
             if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
-                for(auto& img : images.images224) {
-                    img = ThreatImage::sharpen(img);
+                for(auto& img : images.images224) {
+                    img = ThreatImage::sharpen(img);
+                }
+            }
+
+            if(mSettings.compositeEquadistantProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = equidistantTransform.begin();
+                for(const auto& img : images.images224) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_224_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+
+            if(mSettings.compositeMercatorProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = mercatorTransform.begin();
+                for(auto& img : images.images224) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_224_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+        }
+    }
+
+
+    if(mSettings.generateComposite68()) {
+        if(images.images68.size() > 1) {
+            std::list<cv::Mat> irImages;
+            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
+                for(const auto& img : images.images68) {
+                    auto ir = ThreatImage::invertIR(img);
+                    ir = ThreatImage::gamma(ir, 1.4);
+                    ir = ThreatImage::contrast(ir, 1.3, -40);
+                    ir = ThreatImage::sharpen(ir);
+                    irImages.emplace_back(ir);
+                }
+            }
+
+            if(mSettings.compositeEquadistantProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = equidistantTransform.begin();
+                for(const auto& img : irImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+
+            if(mSettings.compositeMercatorProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = mercatorTransform.begin();
+                for(const auto& img : irImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+        }
+
+        if(images.images67.size() > 1) {
+            std::list<cv::Mat> irImages;
+            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
+                for(const auto& img : images.images67) {
+                    auto irImage = ThreatImage::equalize(img);
+                    irImage = ThreatImage::invertIR(irImage);
+                    irImages.emplace_back(irImage);
+                }
+            }
+
+            if(mSettings.compositeEquadistantProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = equidistantTransform.begin();
+                for(const auto& img : irImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+
+            if(mSettings.compositeMercatorProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = mercatorTransform.begin();
+                for(const auto& img : irImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+        }
+    }
+
+    if(mSettings.generateCompositeThermal()) {
+        cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
+        if(images.images68.size() > 1) {
+            std::list<cv::Mat> thermalImages;
+            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
+                for(const auto& img : images.images68) {
+                    thermalImages.emplace_back(ThreatImage::irToTemperature(img, thermalRef));
+                }
+            }
+
+            if(mSettings.compositeEquadistantProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = equidistantTransform.begin();
+                for(const auto& img : thermalImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_thermal_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+
+            if(mSettings.compositeMercatorProjection()) {
+                std::list<cv::Mat> imagesToBlend;
+                auto transformIt = mercatorTransform.begin();
+                for(const auto& img : thermalImages) {
+                    imagesToBlend.emplace_back(transformIt->project(img));
+                    transformIt++;
+                }
+                cv::Mat composite = BlendImages::merge(imagesToBlend);
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_thermal_composite." + mSettings.getOutputFormat();
+                std::cout << "Saving composite: " << filePath << std::endl;
+                saveImage(filePath, composite);
+            }
+        }
+        if(images.images67.size() > 1) {
+            std::list<cv::Mat> thermalImages;
+            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
+                for(const auto& img : images.images67) {
+                    thermalImages.emplace_back(ThreatImage::irToTemperature(ThreatImage::equalize(img), thermalRef));
                 }
             }
 
             if(mSettings.compositeEquadistantProjection()) {
                 std::list<cv::Mat> imagesToBlend;
                 auto transformIt = equidistantTransform.begin();
-                for(const auto& img : images.images224) {
+                for(const auto& img : thermalImages) {
                     imagesToBlend.emplace_back(transformIt->project(img));
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_224_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_thermal_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
@@ -618,28 +428,30 @@ int main(int argc, char* argv[]) {
             if(mSettings.compositeMercatorProjection()) {
                 std::list<cv::Mat> imagesToBlend;
                 auto transformIt = mercatorTransform.begin();
-                for(auto& img : images.images224) {
+                for(const auto& img : thermalImages) {
                     imagesToBlend.emplace_back(transformIt->project(img));
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_224_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_thermal_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
         }
     }
 
-
-    if(mSettings.generateComposite68()) {
+    if(mSettings.generateComposite68Rain()) {
         if(images.images68.size() > 1) {
             std::list<cv::Mat> irImages;
+            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
             if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
                 for(const auto& img : images.images68) {
-                    auto ir = ThreatImage::invertIR(img);
+                    cv::Mat rainOverlay = ThreatImage::irToRain(img, rainRef);
+                    cv::Mat ir = ThreatImage::invertIR(img);
                     ir = ThreatImage::gamma(ir, 1.4);
                     ir = ThreatImage::contrast(ir, 1.3, -40);
                     ir = ThreatImage::sharpen(ir);
+                    ir = ThreatImage::addRainOverlay(ir, rainOverlay);
                     irImages.emplace_back(ir);
                 }
             }
@@ -652,7 +464,7 @@ int main(int argc, char* argv[]) {
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_rain_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
@@ -665,7 +477,7 @@ int main(int argc, char* argv[]) {
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_rain_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
@@ -673,11 +485,11 @@ int main(int argc, char* argv[]) {
 
         if(images.images67.size() > 1) {
             std::list<cv::Mat> irImages;
+            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
             if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
                 for(const auto& img : images.images67) {
-                    auto irImage = ThreatImage::equalize(img);
-                    irImage = ThreatImage::invertIR(irImage);
-                    irImages.emplace_back(irImage);
+                    cv::Mat rainOverlay = ThreatImage::irToRain(img, rainRef);
+                    irImages.emplace_back(ThreatImage::addRainOverlay(ThreatImage::invertIR(ThreatImage::equalize(img)), rainOverlay));
                 }
             }
 
@@ -689,7 +501,7 @@ int main(int argc, char* argv[]) {
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_rain_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
@@ -702,170 +514,610 @@ int main(int argc, char* argv[]) {
                     transformIt++;
                 }
                 cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_composite." + mSettings.getOutputFormat();
+                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_rain_composite." + mSettings.getOutputFormat();
                 std::cout << "Saving composite: " << filePath << std::endl;
                 saveImage(filePath, composite);
             }
         }
     }
 
-    if(mSettings.generateCompositeThermal()) {
-        cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
-        if(images.images68.size() > 1) {
-            std::list<cv::Mat> thermalImages;
-            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
-                for(const auto& img : images.images68) {
-                    thermalImages.emplace_back(ThreatImage::irToTemperature(img, thermalRef));
+    std::cout << "Generate composite images done" << std::endl;
+
+    return 0;
+}
+
+PassJob createPassJob(const std::string& inputPath, bool batch) {
+    PassJob job;
+    job.inputPath = inputPath;
+    job.outputPath = mSettings.getOutputPath();
+    job.satelliteName = mSettings.getSateliteName();
+    job.projectionSetting = mSettings.getProjectionSetting(job.satelliteName);
+    job.passDate = mSettings.getPassDate();
+    job.decoderThreads = 0;
+
+    // Recordings of a batch can be from different days, without --date the file time gives the pass date
+    std::error_code error;
+    auto fileTime = fs::last_write_time(inputPath, error);
+    if(batch && !mSettings.passDateGiven() && !error) {
+        std::time_t modified = std::chrono::system_clock::to_time_t(fileTime);
+        tm date;
+#if defined(_MSC_VER)
+        gmtime_s(&date, &modified);
+#else
+        gmtime_r(&modified, &date);
+#endif
+        job.passDate.Initialise(1900 + date.tm_year, date.tm_mon + 1, date.tm_mday, date.tm_hour, date.tm_min, date.tm_sec, 0);
+    }
+
+    return job;
+}
+
+void processBatch(const std::string& batchPath) {
+    std::vector<std::string> inputs = collectBatchInputs(batchPath);
+    if(inputs.empty()) {
+        throw std::runtime_error("No recordings found for batch processing in: " + batchPath);
+    }
+
+    int jobs = std::min<int>(mSettings.getBatchJobs(), inputs.size());
+    std::cout << "Batch processing " << inputs.size() << " passes, " << jobs << " at a time" << std::endl;
+
+    std::vector<PassResult> results(inputs.size(), PassResult::Failed);
+    ThreadPool threadPool(jobs);
+    threadPool.start();
+
+    // The passes share the cores for frame decoding
+    int decoderThreads = std::max<int>(1, std::thread::hardware_concurrency() / jobs);
+
+    for(size_t i = 0; i < inputs.size(); i++) {
+        PassJob job = createPassJob(inputs[i], true);
+        job.decoderThreads = decoderThreads;
+        threadPool.addJob([job, i, &results]() {
+            try {
+                results[i] = processPass(job);
+            } catch(const std::exception& ex) {
+                std::cout << job.inputPath << ": " << ex.what() << std::endl;
+            }
+        });
+    }
+
+    // Waits for all passes
+    threadPool.stop();
+
+    static const char* resultNames[] = {"done", "no data", "no usable channel data", "TLE not found", "failed"};
+    std::cout << "Batch processing done" << std::endl;
+    for(size_t i = 0; i < inputs.size(); i++) {
+        std::cout << " " << inputs[i] << ": " << resultNames[static_cast<int>(results[i])] << std::endl;
+    }
+}
+
+// A list file has one input per line. From a folder every recording is taken once,
+// if the same pass is there in several stages (wav, .s, .cadu) the earliest stage is processed.
+std::vector<std::string> collectBatchInputs(const std::string& batchPath) {
+    std::vector<std::string> inputs;
+
+    if(!fs::is_directory(batchPath)) {
+        std::ifstream listStream(batchPath);
+        if(!listStream) {
+            throw std::runtime_error("Opening batch list failed: " + batchPath);
+        }
+
+        std::string line;
+        while(std::getline(listStream, line)) {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if(!line.empty()) {
+                inputs.push_back(line);
+            }
+        }
+        return inputs;
+    }
+
+    static const std::map<std::string, int> stages{{".wav", 0}, {".cu8", 1}, {".cs16", 1}, {".cf32", 1}, {".s", 2}, {".S", 2}, {".cadu", 3}};
+    std::map<std::string, std::pair<int, std::string>> passes;
+
+    for(const auto& entry : fs::directory_iterator(batchPath)) {
+        if(!fs::is_regular_file(entry.path())) {
+            continue;
+        }
+
+        auto stage = stages.find(entry.path().extension().generic_string());
+        if(stage == stages.end()) {
+            continue;
+        }
+
+        fs::path base = entry.path();
+        base.replace_extension();
+        auto pass = passes.find(base.generic_string());
+        if(pass == passes.end() || stage->second < pass->second.first) {
+            passes[base.generic_string()] = std::make_pair(stage->second, entry.path().generic_string());
+        }
+    }
+
+    for(const auto& [base, pass] : passes) {
+        inputs.push_back(pass.second);
+    }
+    return inputs;
+}
+
+PassResult processPass(const PassJob& job) {
+    // CCSDS reassembly stays on the decoding thread, the image segments are decoded on the worker threads
+    decoder::protocol::lrpt::Decoder lrptDecoder(job.decoderThreads);
+    std::string inputPath = job.inputPath;
+    const bool quiet = mSettings.quiet();
+
+    // Named after the .dat file once the pass time is known
+    PassReport report;
+    report.statistics.inputPath = inputPath;
+    report.path = job.outputPath + (inputPath == "-" ? std::string("stdin") : fs::path(inputPath).stem().generic_string()) + ".json";
+
+    // With --mode auto it is detected from the soft bits
+    ModeDetector::Mode mode;
+    mode.oqpsk = mSettings.getDemodulatorMode() == "oqpsk";
+    mode.differentialDecode = mSettings.differentialDecode();
+    mode.deInterleave = mSettings.deInterleave();
+
+    std::unique_ptr<MeteorDecoder> meteorDecoder;
+    size_t decodedPacketCounter = 0;
+    std::ofstream caduFileStream;
+    auto startDecoding = [&caduFileStream, &lrptDecoder, &meteorDecoder, &mode, &job, &report, quiet](const std::string& softBitsPath) {
+        const std::string outputPath = softBitsPath.substr(0, softBitsPath.find_last_of(".") + 1) + "cadu";
+        caduFileStream.open(outputPath, std::ios::binary);
+
+        meteorDecoder = std::make_unique<MeteorDecoder>(mode.deInterleave, mode.oqpsk, mode.differentialDecode, job.decoderThreads);
+        meteorDecoder->setVerbose(!quiet);
+        meteorDecoder->setStatistics(&report.statistics);
+        meteorDecoder->start([&caduFileStream, &lrptDecoder, &report](const uint8_t* cadu, std::size_t size) {
+            if(size == 1024) {
+                auto start = std::chrono::steady_clock::now();
+                lrptDecoder.process(cadu);
+                report.statistics.lrpt.add(1, start);
+                caduFileStream.write(reinterpret_cast<const char*>(cadu), size);
+            }
+        });
+    };
+
+    try {
+        const std::string inputExtension = inputPath.substr(inputPath.find_last_of(".") + 1);
+        RawIQReader::Format rawIQFormat;
+        bool rawIQFormatKnown = RawIQReader::parseFormat(inputExtension, rawIQFormat);
+        bool isRawIQ = rawIQFormatKnown || inputPath == "-" || inputExtension == "raw" || inputExtension == "iq";
+
+        if(inputExtension == "wav" || isRawIQ) {
+            std::unique_ptr<DSP::IQSoruce> iqSource;
+            std::string outputPath = inputPath.substr(0, inputPath.find_last_of(".") + 1) + "s";
+
+            if(inputExtension == "wav") {
+                std::cout << "Input is a .wav file, processing it..." << std::endl;
+
+                auto wavReader = std::make_unique<Wavreader>();
+                if(!wavReader->openFile(inputPath)) {
+                    throw std::runtime_error("Opening .wav file failed, demodulating aborted");
+                }
+                iqSource = std::move(wavReader);
+            } else {
+                std::cout << "Input is a raw I/Q " << (inputPath == "-" ? "stream" : "file") << ", processing it..." << std::endl;
+
+                if(!mSettings.getIQFormat().empty()) {
+                    if(!RawIQReader::parseFormat(mSettings.getIQFormat(), rawIQFormat)) {
+                        throw std::runtime_error("Unknown raw I/Q format, it shall be cu8, cs16 or cf32");
+                    }
+                } else if(!rawIQFormatKnown) {
+                    throw std::runtime_error("Format of the raw I/Q input is not given, use --iqformat");
+                }
+
+                auto rawReader = std::make_unique<RawIQReader>();
+                if(!rawReader->openFile(inputPath, rawIQFormat, mSettings.getSampleRate())) {
+                    throw std::runtime_error("Opening raw I/Q input failed, demodulating aborted");
+                }
+                iqSource = std::move(rawReader);
+
+                if(inputPath == "-") {
+                    outputPath = job.outputPath + "stdin.s";
+                }
+            }
+
+            if(mSettings.getDemodulatorMode() == "auto") {
+                throw std::runtime_error("Mode auto works on .S soft bit input only, the demodulator needs --mode qpsk or oqpsk");
+            }
+
+            std::ofstream outputStream;
+            if(mSettings.saveSymbols()) {
+                outputStream.open(outputPath, std::ios::binary);
+
+                if(!outputStream.is_open()) {
+                    throw std::runtime_error("Creating output .S file failed, demodulating aborted");
+                }
+            }
+
+            DSP::MeteorCostas::Mode mode = DSP::MeteorCostas::QPSK;
+            if(mSettings.getDemodulatorMode() == "oqpsk") {
+                mode = DSP::MeteorCostas::OQPSK;
+            }
+
+            DSP::Agc::Mode agcMode = DSP::Agc::Mode::Sample;
+            if(mSettings.getAgcMode() == "block") {
+                agcMode = DSP::Agc::Mode::Block;
+            } else if(mSettings.getAgcMode() == "power") {
+                agcMode = DSP::Agc::Mode::BlockPower;
+            }
+
+            DSP::MeteorDemodulator demodulator(
+                mode, mSettings.getSymbolRate(), mSettings.getCostasBandwidth(), mSettings.getRRCFilterOrder(), mSettings.waitForlock(), mSettings.getBrokenModulation(), mSettings.getSamplesPerSymbol(), mSettings.pipelinedDemodulator(), agcMode);
+
+            demodulator.setVerbose(!quiet);
+            demodulator.setStatistics(&report.statistics);
+
+            startDecoding(outputPath);
+            demodulateAndDecode(demodulator, *iqSource, *meteorDecoder, outputStream.is_open() ? &outputStream : nullptr);
+            decodedPacketCounter = meteorDecoder->finish();
+
+            if(outputStream.is_open()) {
+                outputStream.close();
+            }
+            if(caduFileStream && caduFileStream.is_open()) {
+                caduFileStream.close();
+            }
+        } else if(inputExtension == "cadu") {
+            std::cout << "Input is a .cadu file, processing it..." << std::endl;
+
+            std::ifstream caduBitsStream(inputPath, std::ifstream::binary);
+            if(!caduBitsStream) {
+                throw std::runtime_error("Opening input file failed");
+            }
+
+            uint8_t caduBuffer[1024];
+            while(!caduBitsStream.eof()) {
+                caduBitsStream.read(reinterpret_cast<char*>(caduBuffer), sizeof(caduBuffer));
+                if(caduBitsStream.gcount() == sizeof(caduBuffer)) {
+                    auto start = std::chrono::steady_clock::now();
+                    lrptDecoder.process(caduBuffer);
+                    report.statistics.lrpt.add(1, start);
+                    decodedPacketCounter++;
+                    if(!quiet) {
+                        std::cout << "Number of readed cadu: " << decodedPacketCounter << "\t\t\r" << std::endl;
+                    }
+                }
+            }
+            std::cout << std::endl;
+
+            if(caduBitsStream && caduBitsStream.is_open()) {
+                caduBitsStream.close();
+            }
+        } else {
+            std::ifstream softbitsStream(inputPath, std::ifstream::binary);
+            if(!softbitsStream) {
+                throw std::runtime_error("Opening input file failed");
+            }
+
+            if(mSettings.getDemodulatorMode() == "auto") {
+                if(!detectMode(softbitsStream, job.decoderThreads, mode)) {
+                    throw std::runtime_error("Mode detection failed, no configuration decoded a packet");
+                }
+                softbitsStream.clear();
+                softbitsStream.seekg(0);
+            }
+
+            startDecoding(inputPath);
+
+            // The soft bits are streamed through the decoder, memory use does not depend on the pass length
+            std::vector<uint8_t> softBits(1024 * 1024);
+            while(softbitsStream) {
+                softbitsStream.read(reinterpret_cast<char*>(softBits.data()), softBits.size());
+                std::streamsize readed = softbitsStream.gcount();
+                if(readed > 0) {
+                    meteorDecoder->decode(softBits.data(), static_cast<size_t>(readed));
+                }
+            }
+            decodedPacketCounter = meteorDecoder->finish();
+
+            if(softbitsStream && softbitsStream.is_open()) {
+                softbitsStream.close();
+            }
+            if(caduFileStream && caduFileStream.is_open()) {
+                caduFileStream.close();
+            }
+        }
+    } catch(const std::exception& ex) {
+        std::cout << ex.what() << std::endl;
+    }
+
+    if(decodedPacketCounter == 0) {
+        std::cout << "No data received, try to make composite images" << std::endl;
+    } else {
+        // std::cout << "Decoded packets:" << decodedPacketCounter << std::endl;
+
+        DateTime passStart;
+        DateTime passDate = job.passDate;
+        TimeSpan passStartTime = lrptDecoder.getFirstTimeStamp();
+        TimeSpan passLength = lrptDecoder.getLastTimeStamp() - passStartTime;
+
+        float timeOffset = job.projectionSetting.timeOffsetMs;
+        passStartTime = passStartTime.Add(TimeSpan(0, 0, 0, 0, static_cast<int>(timeOffset * 1000)));
+        passLength = passLength.Add(TimeSpan(0, 0, 0, 0, static_cast<int>(timeOffset * 1000)));
+
+        passDate = passDate.AddHours(3); // Convert UTC 0 to Moscow time zone (UTC + 3)
+
+        // Satellite's date time
+        passStart.Initialise(passDate.Year(), passDate.Month(), passDate.Day(), passStartTime.Hours(), passStartTime.Minutes(), passStartTime.Seconds(), passStartTime.Microseconds());
+        // Convert satellite's Moscow time zone to UTC 0
+        passStart = passStart.AddHours(-3);
+
+        std::string fileNameDate = std::to_string(passStart.Year()) + "-" + std::to_string(passStart.Month()) + "-" + std::to_string(passStart.Day()) + "-" + std::to_string(passStart.Hour()) + "-" + std::to_string(passStart.Minute()) + "-"
+                                   + std::to_string(passStart.Second());
+
+        report.path = job.outputPath + fileNameDate + ".json";
+        report.imagesStart = std::chrono::steady_clock::now();
+        report.imagesStarted = true;
+
+        std::ofstream datFileStream(job.outputPath + fileNameDate + ".dat");
+        if(datFileStream) {
+            datFileStream << job.satelliteName << std::endl;
+            datFileStream << std::to_string(passStart.Ticks()) << std::endl;
+            datFileStream << std::to_string(passLength.Ticks()) << std::endl;
+            datFileStream.close();
+        }
+
+        std::list<ImageForSpread> imagesToSpread;
+
+        if(lrptDecoder.isChannel64Available() && lrptDecoder.isChannel65Available() && lrptDecoder.isChannel68Available()) {
+            cv::Mat threatedImage1 = lrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
+            cv::Mat ch68 = lrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
+            cv::Mat irImage = ch68;
+            cv::Mat threatedImage2 = lrptDecoder.getRGBImage(APID::APID64, APID::APID65, APID::APID68, mSettings.fillBackLines());
+
+            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
+            cv::Mat rainOverlay = ThreatImage::irToRain(irImage, rainRef);
+
+            if(!ThreatImage::isNightPass(threatedImage1, mSettings.getNightPassTreshold())) {
+                threatedImage1 = ThreatImage::sharpen(threatedImage1);
+                threatedImage2 = ThreatImage::sharpen(threatedImage2);
+
+                imagesToSpread.push_back(ImageForSpread(threatedImage1, "221_"));
+                imagesToSpread.push_back(ImageForSpread(threatedImage2, "125_"));
+
+                if(mSettings.addRainOverlay()) {
+                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(threatedImage1, rainOverlay), "rain_221_"));
+                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(threatedImage2, rainOverlay), "rain_125_"));
+                }
+
+                saveImage(job.outputPath + fileNameDate + "_221.bmp", threatedImage1);
+                saveImage(job.outputPath + fileNameDate + "_125.bmp", threatedImage2);
+            } else {
+                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
+            }
+
+            cv::Mat ch64 = lrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
+            cv::Mat ch65 = lrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
+
+            saveImage(job.outputPath + fileNameDate + "_64.bmp", ch64);
+            saveImage(job.outputPath + fileNameDate + "_65.bmp", ch65);
+            saveImage(job.outputPath + fileNameDate + "_68.bmp", ch68);
+
+            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
+            cv::Mat thermalImage = ThreatImage::irToTemperature(irImage, thermalRef);
+            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
+
+            irImage = ThreatImage::invertIR(irImage);
+            irImage = ThreatImage::gamma(irImage, 1.4);
+            irImage = ThreatImage::contrast(irImage, 1.3, -40);
+            irImage = ThreatImage::sharpen(irImage);
+            imagesToSpread.push_back(ImageForSpread(irImage, "68_"));
+
+            if(mSettings.addRainOverlay()) {
+                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(irImage, rainOverlay), "rain_68_"));
+            }
+
+        } else if(lrptDecoder.isChannel64Available() && lrptDecoder.isChannel65Available() && lrptDecoder.isChannel67Available()) {
+            cv::Mat ch64 = lrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
+            cv::Mat ch65 = lrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
+            cv::Mat ch67 = lrptDecoder.getChannelImage(APID::APID67, mSettings.fillBackLines());
+            cv::Mat irImage = ch67;
+
+            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
+            cv::Mat rainOverlay = ThreatImage::irToRain(irImage, rainRef);
+
+            saveImage(job.outputPath + fileNameDate + "_64.bmp", ch64);
+            saveImage(job.outputPath + fileNameDate + "_65.bmp", ch65);
+            saveImage(job.outputPath + fileNameDate + "_67.bmp", ch67);
+
+            irImage = ThreatImage::equalize(irImage);
+            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
+            cv::Mat thermalImage = ThreatImage::irToTemperature(irImage, thermalRef);
+            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
+
+            irImage = ThreatImage::invertIR(irImage);
+            imagesToSpread.push_back(ImageForSpread(irImage, "67_"));
+
+            if(mSettings.addRainOverlay()) {
+                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(irImage, rainOverlay), "rain_67_"));
+            }
+            cv::Mat image221 = lrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
+            cv::Mat image224 = lrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID67, mSettings.fillBackLines());
+
+            if(!ThreatImage::isNightPass(image221, mSettings.getNightPassTreshold())) {
+                image221 = ThreatImage::sharpen(image221);
+                image224 = ThreatImage::sharpen(image224);
+
+                imagesToSpread.push_back(ImageForSpread(image221, "221_"));
+                imagesToSpread.push_back(ImageForSpread(image224, "224_"));
+
+
+                if(mSettings.addRainOverlay()) {
+                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(image221, rainOverlay), "rain_221_"));
+                    imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(image224, rainOverlay), "rain_224_"));
                 }
-            }
 
-            if(mSettings.compositeEquadistantProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = equidistantTransform.begin();
-                for(const auto& img : thermalImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_thermal_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+                saveImage(job.outputPath + fileNameDate + "_221.bmp", image221);
+                saveImage(job.outputPath + fileNameDate + "_224.bmp", image224);
+            } else {
+                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
             }
 
-            if(mSettings.compositeMercatorProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = mercatorTransform.begin();
-                for(const auto& img : thermalImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_thermal_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+        } else if(lrptDecoder.isChannel64Available() && lrptDecoder.isChannel65Available() && lrptDecoder.isChannel66Available()) {
+            cv::Mat threatedImage1 = lrptDecoder.getRGBImage(APID::APID66, APID::APID65, APID::APID64, mSettings.fillBackLines());
+            cv::Mat threatedImage2 = lrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
+
+            if(!ThreatImage::isNightPass(threatedImage1, mSettings.getNightPassTreshold())) {
+                threatedImage1 = ThreatImage::sharpen(threatedImage1);
+                threatedImage2 = ThreatImage::sharpen(threatedImage2);
+
+                imagesToSpread.push_back(ImageForSpread(threatedImage1, "321_"));
+                saveImage(job.outputPath + fileNameDate + "_321.bmp", threatedImage1);
+
+                imagesToSpread.push_back(ImageForSpread(threatedImage2, "221_"));
+                saveImage(job.outputPath + fileNameDate + "_221.bmp", threatedImage2);
+            } else {
+                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
             }
-        }
-        if(images.images67.size() > 1) {
-            std::list<cv::Mat> thermalImages;
-            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
-                for(const auto& img : images.images67) {
-                    thermalImages.emplace_back(ThreatImage::irToTemperature(ThreatImage::equalize(img), thermalRef));
-                }
+
+            cv::Mat ch64 = lrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
+            cv::Mat ch65 = lrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
+            cv::Mat ch66 = lrptDecoder.getChannelImage(APID::APID66, mSettings.fillBackLines());
+
+            saveImage(job.outputPath + fileNameDate + "_64.bmp", ch64);
+            saveImage(job.outputPath + fileNameDate + "_65.bmp", ch65);
+            saveImage(job.outputPath + fileNameDate + "_66.bmp", ch66);
+        } else if(lrptDecoder.isChannel67Available() && lrptDecoder.isChannel68Available() && lrptDecoder.isChannel69Available()) {
+            cv::Mat ch67 = lrptDecoder.getChannelImage(APID::APID67, mSettings.fillBackLines());
+            cv::Mat ch68 = lrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
+            cv::Mat ch69 = lrptDecoder.getChannelImage(APID::APID69, mSettings.fillBackLines());
+            cv::Mat ch654 = lrptDecoder.getRGBImage(APID::APID67, APID::APID68, APID::APID69, mSettings.fillBackLines());
+
+            saveImage(job.outputPath + fileNameDate + "_67.bmp", ch67);
+            saveImage(job.outputPath + fileNameDate + "_68.bmp", ch68);
+            saveImage(job.outputPath + fileNameDate + "_69.bmp", ch69);
+
+            imagesToSpread.push_back(ImageForSpread(ch654, "654_"));
+            saveImage(job.outputPath + fileNameDate + "_654.bmp", ch654);
+
+            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
+            cv::Mat thermalImage = ThreatImage::irToTemperature(ch68, thermalRef);
+            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
+
+            ch68 = ThreatImage::invertIR(ch68);
+            ch68 = ThreatImage::gamma(ch68, 1.4);
+            ch68 = ThreatImage::contrast(ch68, 1.3, -40);
+            ch68 = ThreatImage::sharpen(ch68);
+            imagesToSpread.push_back(ImageForSpread(ch68, "68_"));
+
+            if(mSettings.addRainOverlay()) {
+                cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
+                cv::Mat rainOverlay = ThreatImage::irToRain(ch68, rainRef);
+                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(ch68, rainOverlay), "rain_68_"));
             }
 
-            if(mSettings.compositeEquadistantProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = equidistantTransform.begin();
-                for(const auto& img : thermalImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_thermal_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+        } else if(lrptDecoder.isChannel64Available() && lrptDecoder.isChannel65Available()) {
+            cv::Mat threatedImage = lrptDecoder.getRGBImage(APID::APID65, APID::APID65, APID::APID64, mSettings.fillBackLines());
+
+            if(!ThreatImage::isNightPass(threatedImage, mSettings.getNightPassTreshold())) {
+                threatedImage = ThreatImage::sharpen(threatedImage);
+
+                imagesToSpread.push_back(ImageForSpread(threatedImage, "221_"));
+                saveImage(job.outputPath + fileNameDate + "_221.bmp", threatedImage);
+            } else {
+                std::cout << "Night pass, RGB image skipped, threshold set to: " << mSettings.getNightPassTreshold() << std::endl;
             }
 
-            if(mSettings.compositeMercatorProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = mercatorTransform.begin();
-                for(const auto& img : thermalImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_thermal_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+            cv::Mat ch64 = lrptDecoder.getChannelImage(APID::APID64, mSettings.fillBackLines());
+            cv::Mat ch65 = lrptDecoder.getChannelImage(APID::APID65, mSettings.fillBackLines());
+
+            saveImage(job.outputPath + fileNameDate + "_64.bmp", ch64);
+            saveImage(job.outputPath + fileNameDate + "_65.bmp", ch65);
+        } else if(lrptDecoder.isChannel68Available()) {
+            cv::Mat ch68 = lrptDecoder.getChannelImage(APID::APID68, mSettings.fillBackLines());
+            saveImage(job.outputPath + fileNameDate + "_68.bmp", ch68);
+
+            if(mSettings.addRainOverlay()) {
+                cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
+                cv::Mat rainOverlay = ThreatImage::irToRain(ch68, rainRef);
+                imagesToSpread.push_back(ImageForSpread(ThreatImage::addRainOverlay(ch68, rainOverlay), "rain_68_"));
             }
+
+            ch68 = ThreatImage::invertIR(ch68);
+            ch68 = ThreatImage::gamma(ch68, 1.4);
+            ch68 = ThreatImage::contrast(ch68, 1.3, -40);
+            ch68 = ThreatImage::sharpen(ch68);
+            imagesToSpread.push_back(ImageForSpread(ch68, "68_"));
+
+            cv::Mat thermalRef = cv::imread(mSettings.getResourcesPath() + "thermal_ref.bmp");
+            cv::Mat thermalImage = ThreatImage::irToTemperature(ch68, thermalRef);
+            imagesToSpread.push_back(ImageForSpread(thermalImage, "thermal_"));
+        } else {
+            std::cout << "No usable channel data found!" << std::endl;
+
+            return PassResult::NoChannelData;
         }
-    }
 
-    if(mSettings.generateComposite68Rain()) {
-        if(images.images68.size() > 1) {
-            std::list<cv::Mat> irImages;
-            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
-                for(const auto& img : images.images68) {
-                    cv::Mat rainOverlay = ThreatImage::irToRain(img, rainRef);
-                    cv::Mat ir = ThreatImage::invertIR(img);
-                    ir = ThreatImage::gamma(ir, 1.4);
-                    ir = ThreatImage::contrast(ir, 1.3, -40);
-                    ir = ThreatImage::sharpen(ir);
-                    ir = ThreatImage::addRainOverlay(ir, rainOverlay);
-                    irImages.emplace_back(ir);
-                }
-            }
+        TleReader reader(mSettings.getTlePath());
+        TleReader::TLE tle;
+        reader.processFile();
+        const auto& projectionSetting = job.projectionSetting;
+        if(!reader.getTLE(projectionSetting.satelliteNameInTLE, tle)) {
+            std::cout << "TLE data not found in TLE file, unable to create projected images..." << std::endl;
+            return PassResult::NoTLE;
+        }
 
-            if(mSettings.compositeEquadistantProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = equidistantTransform.begin();
-                for(const auto& img : irImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_68_rain_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
-            }
+        PixelGeolocationCalculator calc(
+            tle, passStart, passLength, projectionSetting.scanAngle, projectionSetting.roll, projectionSetting.pitch, projectionSetting.yaw, imagesToSpread.front().image.size().width, imagesToSpread.front().image.size().height);
 
-            if(mSettings.compositeMercatorProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = mercatorTransform.begin();
-                for(const auto& img : irImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_68_rain_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
-            }
+        std::ostringstream oss;
+        oss << std::setfill('0') << std::setw(2) << passStart.Day() << "/" << std::setw(2) << passStart.Month() << "/" << passStart.Year() << " " << std::setw(2) << passStart.Hour() << ":" << std::setw(2) << passStart.Minute() << ":"
+            << std::setw(2) << passStart.Second() << " UTC";
+        std::string dateStr = oss.str();
+        std::string satelliteName = decoder::protocol::lrpt::Decoder::serialNumberToSatName(lrptDecoder.getSerialNumber());
+
+
+        ProjectImage rectifier(ProjectImage::Projection::Rectify, calc, mSettings.getProjectionScale());
+        ProjectImage mercatorProjector(ProjectImage::Projection::Mercator, calc, mSettings.getProjectionScale());
+        ProjectImage equdistantProjector(ProjectImage::Projection::Equidistant, calc, mSettings.getProjectionScale());
+
+        if(mSettings.spreadImage()) {
+            rectifier.calculateTransformation(imagesToSpread.front().image.size());
         }
 
-        if(images.images67.size() > 1) {
-            std::list<cv::Mat> irImages;
-            cv::Mat rainRef = cv::imread(mSettings.getResourcesPath() + "rain.bmp");
-            if(mSettings.compositeEquadistantProjection() || mSettings.compositeMercatorProjection()) {
-                for(const auto& img : images.images67) {
-                    cv::Mat rainOverlay = ThreatImage::irToRain(img, rainRef);
-                    irImages.emplace_back(ThreatImage::addRainOverlay(ThreatImage::invertIR(ThreatImage::equalize(img)), rainOverlay));
-                }
+        if(mSettings.mercatorProjection()) {
+            std::cout << "Calculate Mercator TPS" << std::endl;
+            mercatorProjector.calculateTransformation(imagesToSpread.front().image.size());
+            std::cout << "Calculate Mercator TPS Done" << std::endl;
+        }
+
+        if(mSettings.equadistantProjection()) {
+            std::cout << "Calculate Equidistant TPS" << std::endl;
+            equdistantProjector.calculateTransformation(imagesToSpread.front().image.size());
+            std::cout << "Calculate Equidistant Done" << std::endl;
+        }
+        std::list<ImageForSpread>::const_iterator it;
+        for(const auto& img : imagesToSpread) {
+            std::string fileName = img.fileNameBase + fileNameDate + "." + mSettings.getOutputFormat();
+
+            if(mSettings.spreadImage()) {
+                cv::Mat spreaded = rectifier.project(img.image);
+                ThreatImage::drawWatermark(spreaded, dateStr, satelliteName);
+                const std::string filePath = job.outputPath + std::string("spread_") + fileName;
+                std::cout << "Saving " << filePath << std::endl;
+                saveImage(filePath, spreaded);
             }
 
-            if(mSettings.compositeEquadistantProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = equidistantTransform.begin();
-                for(const auto& img : irImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "equidistant_" + compositeFileNameDateSS.str() + "_67_rain_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+            if(mSettings.mercatorProjection()) {
+                cv::Mat mercator = mercatorProjector.project(img.image);
+                ThreatImage::drawWatermark(mercator, dateStr, satelliteName);
+                const std::string filePath = job.outputPath + std::string("mercator_") + fileName;
+                std::cout << "Saving " << filePath << std::endl;
+                saveImage(filePath, mercator);
             }
 
-            if(mSettings.compositeMercatorProjection()) {
-                std::list<cv::Mat> imagesToBlend;
-                auto transformIt = mercatorTransform.begin();
-                for(const auto& img : irImages) {
-                    imagesToBlend.emplace_back(transformIt->project(img));
-                    transformIt++;
-                }
-                cv::Mat composite = BlendImages::merge(imagesToBlend);
-                const std::string filePath = mSettings.getOutputPath() + "mercator_" + compositeFileNameDateSS.str() + "_67_rain_composite." + mSettings.getOutputFormat();
-                std::cout << "Saving composite: " << filePath << std::endl;
-                saveImage(filePath, composite);
+            if(mSettings.equadistantProjection()) {
+                cv::Mat equidistant = equdistantProjector.project(img.image);
+                ThreatImage::drawWatermark(equidistant, dateStr, satelliteName);
+                const std::string filePath = job.outputPath + std::string("equidistant_") + fileName;
+                std::cout << "Saving " << filePath << std::endl;
+                saveImage(filePath, equidistant);
             }
         }
-    }
 
-    std::cout << "Generate composite images done" << std::endl;
+        std::cout << "Save images done" << std::endl;
+    }
 
-    mThreadPool.stop();
-    return 0;
+    return decodedPacketCounter == 0 ? PassResult::NoData : PassResult::Done;
 }
 
 // 221, 321, 125, 224, 68, 67
@@ -973,11 +1225,99 @@ void saveImage(const std::string fileName, const cv::Mat& image) {
     }
 }
 
-void writeSymbolToFile(std::ostream& stream, const Wavreader::complex& sample) {
-    int8_t outBuffer[2];
+void quantizeSymbols(const Wavreader::complex* symbols, int count, uint8_t* softBits) {
+    for(int i = 0; i < count; i++) {
+        softBits[i * 2] = static_cast<int8_t>(std::clamp(std::imag(symbols[i]) * 127.0f, -128.0f, 127.0f));
+        softBits[i * 2 + 1] = static_cast<int8_t>(std::clamp(std::real(symbols[i]) * 127.0f, -128.0f, 127.0f));
+    }
+}
+
+// The quantized symbols are decoded on a separate thread while demodulation goes on, both sides pass soft bit blocks
+// around in a loop of two queues. Either side can stall for long on file I/O, so the queues sleep instead of spinning.
+// The blocks are written to symbolStream as well when it is given.
+void demodulateAndDecode(DSP::MeteorDemodulator& demodulator, DSP::IQSoruce& source, MeteorDecoder& decoder, std::ostream* symbolStream) {
+    static constexpr std::size_t cBlockSize = 64 * 1024;
+    static constexpr std::size_t cBlockCount = 16;
+
+    struct SoftBitBlock {
+        std::unique_ptr<uint8_t[]> softBits;
+        std::size_t size;
+    };
+
+    std::vector<SoftBitBlock> blocks(cBlockCount);
+    BlockingQueue<SoftBitBlock*> freeBlocks;
+    // A null block ends the stream
+    BlockingQueue<SoftBitBlock*> filledBlocks;
+
+    for(auto& block : blocks) {
+        block.softBits = std::make_unique<uint8_t[]>(cBlockSize);
+        block.size = 0;
+        freeBlocks.push(&block);
+    }
+
+    std::thread decoderThread([&]() {
+        SoftBitBlock* block;
+        while((block = filledBlocks.pop()) != nullptr) {
+            if(symbolStream != nullptr) {
+                symbolStream->write(reinterpret_cast<const char*>(block->softBits.get()), block->size);
+            }
+            decoder.decode(block->softBits.get(), block->size);
+            freeBlocks.push(block);
+        }
+    });
+
+    SoftBitBlock* block = freeBlocks.pop();
+    block->size = 0;
+    try {
+        demodulator.process(source, [&](const DSP::IQSoruce::complex* symbols, int count, float) {
+            while(count > 0) {
+                int n = std::min<int>(count, (cBlockSize - block->size) / 2);
+                quantizeSymbols(symbols, n, &block->softBits[block->size]);
+                block->size += n * 2;
+                symbols += n;
+                count -= n;
+
+                if(block->size == cBlockSize) {
+                    filledBlocks.push(block);
+                    block = freeBlocks.pop();
+                    block->size = 0;
+                }
+            }
+        });
+    } catch(...) {
+        filledBlocks.push(nullptr);
+        decoderThread.join();
+        throw;
+    }
+
+    if(block->size > 0) {
+        filledBlocks.push(block);
+    }
+    filledBlocks.push(nullptr);
+    decoderThread.join();
+}
+
+// Decodes the start of the soft bits with every configuration, the stream is left somewhere in the middle
+bool detectMode(std::istream& softBitsStream, int threads, ModeDetector::Mode& mode) {
+    std::cout << "Detecting mode..." << std::endl;
+
+    ModeDetector modeDetector(threads);
+    std::vector<uint8_t> softBits(1024 * 1024);
+    while(softBitsStream) {
+        softBitsStream.read(reinterpret_cast<char*>(softBits.data()), softBits.size());
+        std::streamsize readed = softBitsStream.gcount();
+        if(readed > 0 && modeDetector.push(softBits.data(), static_cast<size_t>(readed))) {
+            break;
+        }
+    }
+    bool found = modeDetector.finish(mode);
 
-    outBuffer[0] = static_cast<int8_t>(std::clamp(std::imag(sample) * 127.0f, -128.0f, 127.0f));
-    outBuffer[1] = static_cast<int8_t>(std::clamp(std::real(sample) * 127.0f, -128.0f, 127.0f));
+    for(const auto& candidate : modeDetector.getCandidates()) {
+        std::cout << (candidate.mode.oqpsk ? "oqpsk" : "qpsk") << " diff:" << candidate.mode.differentialDecode << " int:" << candidate.mode.deInterleave << " | Decoded Packets:" << candidate.decodedPackets << std::endl;
+    }
+    if(found) {
+        std::cout << "Detected mode from " << modeDetector.getProbedLength() << " soft bits: " << (mode.oqpsk ? "oqpsk" : "qpsk") << " diff:" << mode.differentialDecode << " int:" << mode.deInterleave << std::endl;
+    }
 
-    stream.write(reinterpret_cast<char*>(outBuffer), sizeof(outBuffer));
+    return found;
 }
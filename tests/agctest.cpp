@@ -0,0 +1,120 @@
+// Checks the AGC modes on QPSK with noise, with and without a DC offset, against the per-sample recursion evaluated in double.
+// The float Sample mode drifts from it by rounding in the long running averages, the block modes have to stay much closer.
+// BlockPower tracks the mean squared magnitude, so its output settles at an RMS level of the target instead of a mean magnitude.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "agc.h"
+
+namespace {
+
+typedef std::complex<float> complex;
+
+static constexpr float cTarget = 0.5f;
+static constexpr float cMaxGain = 100.0f;
+static constexpr int cWindowSize = 1024 * 64;
+static constexpr int cBiasWindowSize = 256 * 1024;
+static constexpr int cSamples = 1024 * 1024;
+static constexpr int cChunkSize = 4000;
+// The first bias window is the settling time, only the rest is checked
+static constexpr int cSettled = cBiasWindowSize;
+
+std::vector<complex> qpsk(complex offset) {
+    std::mt19937 generator(1);
+    std::normal_distribution<float> noise(0.0f, 0.03f);
+    std::vector<complex> samples(cSamples);
+    for(auto& sample : samples) {
+        uint32_t symbol = generator();
+        sample = complex(symbol & 1 ? 0.1f : -0.1f, symbol & 2 ? 0.1f : -0.1f) + complex(noise(generator), noise(generator)) + offset;
+    }
+    return samples;
+}
+
+// In chunks that do not line up with the AGC blocks
+std::vector<complex> run(const std::vector<complex>& input, DSP::Agc::Mode mode) {
+    DSP::Agc agc(cTarget, cMaxGain, cWindowSize, cBiasWindowSize, mode);
+    std::vector<complex> output(input.size());
+    for(int i = 0; i < cSamples; i += cChunkSize) {
+        agc.process(&input[i], &output[i], std::min(cChunkSize, cSamples - i));
+    }
+    return output;
+}
+
+// Agc::processSample in double, with the squared magnitude averaged for BlockPower
+std::vector<complex> reference(const std::vector<complex>& input, bool power) {
+    std::vector<complex> output(input.size());
+    std::complex<double> bias = 0.0;
+    double avg = power ? cTarget * cTarget : cTarget;
+    for(size_t i = 0; i < input.size(); i++) {
+        bias = (bias * (cBiasWindowSize - 1.0) + std::complex<double>(input[i])) / static_cast<double>(cBiasWindowSize);
+        std::complex<double> sample = std::complex<double>(input[i]) - bias;
+        avg = (avg * (cWindowSize - 1.0) + (power ? std::norm(sample) : std::abs(sample))) / cWindowSize;
+        double gain = std::min<double>(cMaxGain, cTarget / (power ? std::sqrt(avg) : avg));
+        output[i] = complex(sample * gain);
+    }
+    return output;
+}
+
+double meanMagnitude(const std::vector<complex>& samples) {
+    double sum = 0.0;
+    for(int i = cSettled; i < cSamples; i++) {
+        sum += std::abs(samples[i]);
+    }
+    return sum / (cSamples - cSettled);
+}
+
+double rms(const std::vector<complex>& samples) {
+    double sum = 0.0;
+    for(int i = cSettled; i < cSamples; i++) {
+        sum += std::norm(samples[i]);
+    }
+    return std::sqrt(sum / (cSamples - cSettled));
+}
+
+double relativeRmsDifference(const std::vector<complex>& expected, const std::vector<complex>& actual) {
+    double error = 0.0;
+    double power = 0.0;
+    for(int i = cSettled; i < cSamples; i++) {
+        error += std::norm(actual[i] - expected[i]);
+        power += std::norm(expected[i]);
+    }
+    return std::sqrt(error / power);
+}
+
+bool check(const char* name, double value, double bound) {
+    bool passed = value < bound;
+    std::cout << (passed ? "PASS " : "FAIL ") << name << " " << value << " (bound " << bound << ")" << std::endl;
+    return passed;
+}
+
+bool compare(complex offset) {
+    std::vector<complex> input = qpsk(offset);
+    std::vector<complex> sample = run(input, DSP::Agc::Mode::Sample);
+    std::vector<complex> block = run(input, DSP::Agc::Mode::Block);
+    std::vector<complex> blockPower = run(input, DSP::Agc::Mode::BlockPower);
+    std::vector<complex> magnitudeReference = reference(input, false);
+    std::vector<complex> powerReference = reference(input, true);
+
+    std::cout << "DC offset " << offset << std::endl;
+    bool passed = true;
+    passed &= check(" Sample relative RMS difference", relativeRmsDifference(magnitudeReference, sample), 5e-3);
+    passed &= check(" Block relative RMS difference", relativeRmsDifference(magnitudeReference, block), 1e-3);
+    passed &= check(" Block vs Sample relative RMS difference", relativeRmsDifference(sample, block), 5e-3);
+    passed &= check(" BlockPower relative RMS difference", relativeRmsDifference(powerReference, blockPower), 1e-3);
+    passed &= check(" Block mean magnitude level error", std::abs(meanMagnitude(block) / cTarget - 1.0), 0.02);
+    passed &= check(" BlockPower RMS level error", std::abs(rms(blockPower) / cTarget - 1.0), 0.02);
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    bool passed = true;
+    passed &= compare(complex(0.0f, 0.0f));
+    passed &= compare(complex(0.05f, -0.03f));
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// Checks every BitKernels variant the CPU supports against the scalar code it replaced:
+// rotate* against Correlation::rotateSoftIqInPlace for all 16 phase shifts, in place and out of place,
+// xor* against the PRAND loop and the byte 9 inversion of the old MeteorDecoder::decodeFrame.
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bitkernels.h"
+#include "correlation.h"
+#include "cpufeatures.h"
+
+namespace {
+
+template <typename Func>
+struct Kernel {
+    const char* name;
+    Func func;
+};
+
+std::vector<Kernel<BitKernels::RotateFunc>> rotateKernels() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<Kernel<BitKernels::RotateFunc>> kernels = {{"generic", BitKernels::rotateGeneric}};
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        kernels.push_back({"SSE2", BitKernels::rotateSSE2});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", BitKernels::rotateAVX2});
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", BitKernels::rotateNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+std::vector<Kernel<BitKernels::XorFunc>> xorKernels() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<Kernel<BitKernels::XorFunc>> kernels = {{"generic", BitKernels::xorGeneric}};
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        kernels.push_back({"SSE2", BitKernels::xorSSE2});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", BitKernels::xorAVX2});
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", BitKernels::xorNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+// The CCSDS pseudo-randomizer sequence (x^8 + x^7 + x^5 + x^3 + 1, all ones seed), the PRAND table of MeteorDecoder
+std::vector<uint8_t> pseudoRandomSequence() {
+    std::vector<uint8_t> sequence(255);
+    uint8_t state = 0xFF;
+    for(auto& byte : sequence) {
+        byte = 0;
+        for(int bit = 0; bit < 8; bit++) {
+            uint8_t out = state & 1;
+            byte = (byte << 1) | out;
+            uint8_t feedback = (state ^ (state >> 3) ^ (state >> 5) ^ (state >> 7)) & 1;
+            state = (state >> 1) | (feedback << 7);
+        }
+    }
+    return sequence;
+}
+
+bool testRotate(std::mt19937& generator) {
+    std::uniform_int_distribution<int> distribution(0, 255);
+    bool passed = true;
+
+    for(const auto& kernel : rotateKernels()) {
+        int failures = 0;
+        for(uint32_t length : {0u, 2u, 14u, 16u, 30u, 32u, 34u, 62u, 64u, 66u, 1000u, 16384u, 16386u}) {
+            std::vector<uint8_t> input(length);
+            for(auto& softBit : input) {
+                softBit = static_cast<uint8_t>(distribution(generator));
+            }
+
+            for(uint16_t phaseShift = 0; phaseShift < 16; phaseShift++) {
+                std::vector<uint8_t> expected(input);
+                Correlation::rotateSoftIqInPlace(expected.data(), length, phaseShift);
+
+                std::vector<uint8_t> outOfPlace(length);
+                kernel.func(input.data(), outOfPlace.data(), length, phaseShift);
+                std::vector<uint8_t> inPlace(input);
+                kernel.func(inPlace.data(), inPlace.data(), length, phaseShift);
+
+                if(outOfPlace != expected || inPlace != expected) {
+                    if(failures++ < 4) {
+                        std::cout << "FAIL rotate " << kernel.name << " length " << length << " phase " << phaseShift << (outOfPlace != expected ? " out of place" : " in place") << std::endl;
+                    }
+                }
+            }
+        }
+        std::cout << (failures == 0 ? "PASS" : "FAIL") << " rotate " << kernel.name << std::endl;
+        passed &= failures == 0;
+    }
+    return passed;
+}
+
+bool testXor(std::mt19937& generator) {
+    static constexpr int cCaduSize = 1024;
+    static constexpr int cCadus = 1000;
+
+    const std::vector<uint8_t> prand = pseudoRandomSequence();
+    uint8_t pattern[cCaduSize - 4];
+    for(int i = 0; i < cCaduSize - 4; i++) {
+        pattern[i] = prand[i % prand.size()];
+    }
+
+    std::uniform_int_distribution<int> distribution(0, 255);
+    bool passed = true;
+
+    for(const auto& kernel : xorKernels()) {
+        int failures = 0;
+        for(int n = 0; n < cCadus; n++) {
+            uint8_t cadu[cCaduSize];
+            for(auto& byte : cadu) {
+                byte = static_cast<uint8_t>(distribution(generator));
+            }
+            // Half of them derandomize to an inverted frame
+            if(n & 1) {
+                cadu[9] = prand[5] ^ 0xFF;
+            }
+
+            uint8_t expected[cCaduSize];
+            std::memcpy(expected, cadu, cCaduSize);
+            for(int j = 0; j < cCaduSize - 4; j++) {
+                expected[j + 4] = expected[j + 4] ^ prand[j % 255];
+            }
+            if(expected[9] == 0xFF) {
+                for(int i = 0; i < cCaduSize; i++) {
+                    expected[i] ^= 0xFF;
+                }
+            }
+
+            uint8_t invert = ((cadu[9] ^ pattern[5]) == 0xFF) ? 0xFF : 0x00;
+            kernel.func(cadu + 4, pattern, invert, sizeof(pattern));
+            for(int i = 0; i < 4; i++) {
+                cadu[i] ^= invert;
+            }
+
+            if(std::memcmp(cadu, expected, cCaduSize) != 0) {
+                failures++;
+            }
+        }
+        std::cout << (failures == 0 ? "PASS" : "FAIL") << " xor " << kernel.name << " " << failures << " of " << cCadus << " frames differ" << std::endl;
+        passed &= failures == 0;
+    }
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 generator(17);
+
+    bool passed = testRotate(generator);
+    passed &= testXor(generator);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+// Stands in for libcorrect in the tests of the in-tree decoders, so they build without the external project.
+// Nothing can be created, the paths that would need libcorrect report a failure.
+
+extern "C" {
+#include "correct.h"
+}
+
+correct_convolutional* correct_convolutional_create(size_t, size_t, const correct_convolutional_polynomial_t*) {
+    return nullptr;
+}
+
+void correct_convolutional_destroy(correct_convolutional*) {}
+
+size_t correct_convolutional_encode_len(correct_convolutional*, size_t) {
+    return 0;
+}
+
+size_t correct_convolutional_encode(correct_convolutional*, const uint8_t*, size_t, uint8_t*) {
+    return 0;
+}
+
+ssize_t correct_convolutional_decode_soft(correct_convolutional*, const correct_convolutional_soft_t*, size_t, uint8_t*) {
+    return -1;
+}
+
+correct_reed_solomon* correct_reed_solomon_create(uint16_t, uint8_t, uint8_t, size_t) {
+    return nullptr;
+}
+
+ssize_t correct_reed_solomon_decode(correct_reed_solomon*, const uint8_t*, size_t, uint8_t*) {
+    return -1;
+}
+
+void correct_reed_solomon_destroy(correct_reed_solomon*) {}
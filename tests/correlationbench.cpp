@@ -0,0 +1,72 @@
+// Sync word search throughput of Correlation::correlate and the byte by byte reference, in positions per second.
+// Usage: correlationbench [soft bits .s file|-] [qpsk|oqpsk] [max soft bits]
+// Without a file (or with -) 4M synthetic soft bits are searched. The reference is slow, the third argument limits the input.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "correlation.h"
+#include "referencecorrelation.h"
+#include "softbits.h"
+
+namespace {
+
+template <typename Correlator>
+double positionsPerSecond(const Correlator& correlate, const std::vector<uint8_t>& softBits, std::size_t& hits) {
+    hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    correlate(softBits.data(), static_cast<int64_t>(softBits.size()), [&](Correlation::CorellationResult&, Correlation::PhaseShift) {
+        hits++;
+        // No frame skip, every position is searched
+        return 0u;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return softBits.size() / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const bool oqpsk = argc > 2 && std::string(argv[2]) == "oqpsk";
+    const uint64_t syncWord = oqpsk ? 0xFC4EF4FD0CC2DF89U : 0xFCA2B63DB00D9794U;
+    const std::size_t maxSize = argc > 3 ? std::stoull(argv[3]) : 0;
+
+    std::vector<uint8_t> softBits;
+    if(argc > 1 && std::string(argv[1]) != "-") {
+        std::ifstream file(argv[1], std::ios::binary);
+        if(!file) {
+            std::cout << "Unable to open " << argv[1] << std::endl;
+            return 1;
+        }
+        softBits.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        softBits = syntheticSoftBits(4 * 1024 * 1024, syncWord, oqpsk, 30.0f);
+    }
+    if(maxSize > 0 && softBits.size() > maxSize) {
+        softBits.resize(maxSize);
+    }
+
+    Correlation correlation(syncWord, oqpsk);
+    ReferenceCorrelation reference(syncWord, oqpsk);
+    std::size_t hits;
+    std::size_t referenceHits;
+
+    double packed = positionsPerSecond(
+        [&](const uint8_t* data, int64_t size, Correlation::CorrelationCallback callback) {
+            correlation.correlate(data, size, callback);
+        },
+        softBits, hits);
+    double byteWise = positionsPerSecond(
+        [&](const uint8_t* data, int64_t size, Correlation::CorrelationCallback callback) {
+            reference.correlate(data, size, callback);
+        },
+        softBits, referenceHits);
+
+    std::cout << softBits.size() << " soft bits, " << (oqpsk ? "OQPSK" : "QPSK") << std::endl;
+    std::cout << "Correlation: " << packed / 1e6 << " Mpos/s, " << hits << " sync words" << std::endl;
+    std::cout << "Reference:   " << byteWise / 1e6 << " Mpos/s, " << referenceHits << " sync words" << std::endl;
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Checks that the packed correlator (Correlation::correlate over findSync) reports the same sync positions, scores
+// and phase shifts as the byte by byte reference, for QPSK and OQPSK kernels, clean and noisy soft bits,
+// and with and without skipping a frame after a hit.
+
+#include <iostream>
+#include <vector>
+
+#include "correlation.h"
+#include "referencecorrelation.h"
+#include "softbits.h"
+
+namespace {
+
+struct Hit {
+    uint32_t pos;
+    uint32_t corr;
+    Correlation::PhaseShift phaseShift;
+
+    bool operator==(const Hit& other) const {
+        return pos == other.pos && corr == other.corr && phaseShift == other.phaseShift;
+    }
+};
+
+bool compare(bool oqpsk, float noise, uint32_t skip) {
+    static constexpr int64_t cSize = 1024 * 1024;
+    const uint64_t syncWord = oqpsk ? 0xFC4EF4FD0CC2DF89U : 0xFCA2B63DB00D9794U;
+    const std::vector<uint8_t> softBits = syntheticSoftBits(cSize, syncWord, oqpsk, noise);
+
+    std::vector<Hit> expected;
+    ReferenceCorrelation reference(syncWord, oqpsk);
+    reference.correlate(softBits.data(), cSize, [&](Correlation::CorellationResult& result, Correlation::PhaseShift phaseShift) {
+        expected.push_back({result.pos, result.corr, phaseShift});
+        return skip;
+    });
+
+    std::vector<Hit> hits;
+    Correlation correlation(syncWord, oqpsk);
+    correlation.correlate(softBits.data(), cSize, [&](Correlation::CorellationResult& result, Correlation::PhaseShift phaseShift) {
+        hits.push_back({result.pos, result.corr, phaseShift});
+        return skip;
+    });
+
+    bool passed = hits == expected && !expected.empty();
+    std::cout << (passed ? "PASS" : "FAIL") << (oqpsk ? " OQPSK" : " QPSK") << " noise " << noise << " skip " << skip << " hits " << hits.size() << " reference " << expected.size() << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    bool passed = true;
+    for(bool oqpsk : {false, true}) {
+        for(float noise : {0.0f, 30.0f, 60.0f}) {
+            for(uint32_t skip : {0u, 16383u}) {
+                passed &= compare(oqpsk, noise, skip);
+            }
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+// Throughput of the streaming DeInterleaver on synthetic 80k soft bits, in MB/s of input.
+// Usage: deinterleaverbench [megabytes] [chunk size]
+// The input is pushed in chunks of the given size (default 64 KiB), the output is only counted.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "deinterleaver.h"
+#include "stream80k.h"
+
+int main(int argc, char* argv[]) {
+    const uint64_t size = (argc > 1 ? std::stoull(argv[1]) : 64) * 1024 * 1024;
+    const uint64_t chunkSize = argc > 2 ? std::stoull(argv[2]) : 64 * 1024;
+
+    std::vector<uint8_t> softBits = synthetic80kStream(size, 30.0f);
+
+    uint64_t outputLength = 0;
+    auto count = [&outputLength](const uint8_t*, uint64_t length) {
+        outputLength += length;
+    };
+
+    DeInterleaver deInterleaver(false);
+    auto start = std::chrono::steady_clock::now();
+    for(uint64_t i = 0; i < size; i += chunkSize) {
+        deInterleaver.push(&softBits[i], std::min(chunkSize, size - i), count);
+    }
+    deInterleaver.flush(count);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "DeInterleaver: " << size / seconds / 1e6 << " MB/s, " << outputLength << " soft bits out of " << size << " in chunks of " << chunkSize << std::endl;
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Checks that the streaming DeInterleaver gives the same output whatever the input chunking is.
+// The reference pushes the whole stream at once, the others push it in fixed and in random sized chunks.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "deinterleaver.h"
+#include "stream80k.h"
+
+namespace {
+
+// chunkSize 0 picks a random size up to maxRandomChunk for every push
+std::vector<uint8_t> deInterleave(const std::vector<uint8_t>& softBits, uint64_t chunkSize, uint64_t maxRandomChunk = 0) {
+    std::mt19937 generator(18);
+    std::vector<uint8_t> output;
+    auto append = [&output](const uint8_t* deInterleaved, uint64_t length) {
+        output.insert(output.end(), deInterleaved, deInterleaved + length);
+    };
+
+    DeInterleaver deInterleaver(false);
+    for(uint64_t i = 0; i < softBits.size();) {
+        uint64_t n = std::min<uint64_t>(chunkSize > 0 ? chunkSize : 1 + generator() % maxRandomChunk, softBits.size() - i);
+        deInterleaver.push(&softBits[i], n, append);
+        i += n;
+    }
+    deInterleaver.flush(append);
+    return output;
+}
+
+bool compare(const std::vector<uint8_t>& expected, const std::vector<uint8_t>& softBits, uint64_t chunkSize, uint64_t maxRandomChunk = 0) {
+    std::vector<uint8_t> output = deInterleave(softBits, chunkSize, maxRandomChunk);
+    bool passed = output == expected;
+
+    if(chunkSize > 0) {
+        std::cout << (passed ? "PASS" : "FAIL") << " chunk " << chunkSize;
+    } else {
+        std::cout << (passed ? "PASS" : "FAIL") << " random chunks up to " << maxRandomChunk;
+    }
+    std::cout << ": " << output.size() << " soft bits, expected " << expected.size() << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    // Longer than the consumed input compaction and the look back of the output, with sync losses on the way
+    std::vector<uint8_t> softBits = synthetic80kStream(5 * 1024 * 1024, 20.0f);
+    std::vector<uint8_t> expected = deInterleave(softBits, softBits.size());
+
+    bool passed = std::count_if(expected.begin(), expected.end(), [](uint8_t softBit) { return softBit != 0; }) > static_cast<long>(softBits.size() / 2);
+    std::cout << (passed ? "PASS" : "FAIL") << " whole stream: " << expected.size() << " soft bits" << std::endl;
+
+    for(uint64_t chunkSize : {1, 7, 80, 4095, 65536, 1 << 20}) {
+        passed &= compare(expected, softBits, chunkSize);
+    }
+    for(uint64_t maxRandomChunk : {100, 100000}) {
+        passed &= compare(expected, softBits, 0, maxRandomChunk);
+    }
+    return passed ? 0 : 1;
+}
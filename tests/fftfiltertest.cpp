@@ -0,0 +1,82 @@
+// Checks the overlap-save FFTFilter against the direct form RRCFilter on random input.
+// The FFT filter output is delayed by blockSize() samples, the flushed tail has to complete the stream.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "fftfilter.h"
+#include "filter.h"
+#include "rootraisedcosine.h"
+
+namespace {
+
+typedef std::complex<float> complex;
+
+bool compare(int taps, int chunkSize) {
+    static constexpr float cBeta = 0.6f;
+    static constexpr float cSymbolRate = 72000.0f;
+    static constexpr float cSampleRate = 144000.0f;
+    static constexpr int cSamples = 100000;
+
+    std::mt19937 generator(taps);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<complex> input(cSamples);
+    for(auto& sample : input) {
+        sample = complex(distribution(generator), distribution(generator));
+    }
+
+    DSP::RRCFilter direct(taps, cBeta, cSymbolRate, cSampleRate);
+    std::vector<complex> expected(cSamples);
+    direct.process(input.data(), expected.data(), cSamples);
+
+    // In-place, in chunks that do not line up with the FFT blocks
+    DSP::FFTFilter fast(DSP::TAPS::rootRaisedCosine(taps, cBeta, cSampleRate / cSymbolRate));
+    std::vector<complex> output(input);
+    for(int i = 0; i < cSamples; i += chunkSize) {
+        int n = std::min(chunkSize, cSamples - i);
+        if(fast.process(&output[i], &output[i], n) != n) {
+            std::cout << "FFTFilter::process did not return the sample count" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<complex> tail(chunkSize);
+    int flushed = 0;
+    int n;
+    while((n = fast.flush(tail.data(), chunkSize)) > 0) {
+        output.insert(output.end(), tail.begin(), tail.begin() + n);
+        flushed += n;
+    }
+    if(flushed != fast.blockSize()) {
+        std::cout << "taps " << taps << ": flushed " << flushed << " samples instead of " << fast.blockSize() << std::endl;
+        return false;
+    }
+
+    float maxError = 0.0f;
+    float maxLeading = 0.0f;
+    for(int i = 0; i < fast.blockSize(); i++) {
+        maxLeading = std::max(maxLeading, std::abs(output[i]));
+    }
+    for(int i = 0; i < cSamples; i++) {
+        maxError = std::max(maxError, std::abs(output[i + fast.blockSize()] - expected[i]));
+    }
+
+    bool passed = maxError < 1e-4f && maxLeading == 0.0f;
+    std::cout << (passed ? "PASS" : "FAIL") << " taps " << taps << " chunk " << chunkSize << " block " << fast.blockSize() << " max error " << maxError << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    bool passed = true;
+    for(int taps : {65, 129, 255, 1023}) {
+        for(int chunkSize : {1000, 8192}) {
+            passed &= compare(taps, chunkSize);
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// FIR filter throughput in complex samples per second. The list based filter FilterBase used to be is measured as the
+// baseline, then RRCFilter with each dot product kernel the CPU supports, and the FFTFilter above the crossover.
+// Usage: firbench [samples]
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpufeatures.h"
+#include "fftfilter.h"
+#include "filter.h"
+#include "rootraisedcosine.h"
+
+namespace {
+
+typedef std::complex<float> complex;
+
+static constexpr float cBeta = 0.6f;
+static constexpr float cSymbolRate = 72000.0f;
+static constexpr float cSampleRate = 144000.0f;
+
+// FilterBase before the contiguous delay line: a std::list shifted by one node per sample
+class ListFilter {
+  public:
+    explicit ListFilter(const std::vector<float>& coeffs)
+        : mCoeffs(coeffs)
+        , mMemory(coeffs.size(), 0)
+        , mTaps(static_cast<int>(coeffs.size())) {}
+
+    int process(const complex* inSamples, complex* outSamples, int count) {
+        for(int n = 0; n < count; n++) {
+            complex out = 0.0f;
+            mMemory.push_front(inSamples[n]);
+            mMemory.pop_back();
+            std::list<complex>::const_reverse_iterator it = mMemory.crbegin();
+            for(int i = mTaps - 1; i >= 0; --i, ++it) {
+                out += (*it) * mCoeffs[i];
+            }
+            outSamples[n] = out;
+        }
+        return count;
+    }
+
+  private:
+    std::vector<float> mCoeffs;
+    std::list<complex> mMemory;
+    int mTaps;
+};
+
+// RRCFilter with the dot product kernel forced
+class KernelFilter : public DSP::RRCFilter {
+  public:
+    KernelFilter(int taps, DSP::FIR::DotProductFunc dotProduct)
+        : DSP::RRCFilter(taps, cBeta, cSymbolRate, cSampleRate) {
+        mDotProduct = dotProduct;
+    }
+};
+
+template <typename Filter>
+double samplesPerSecond(Filter& filter, const std::vector<complex>& input, std::vector<complex>& output) {
+    auto start = std::chrono::steady_clock::now();
+    filter.process(input.data(), output.data(), static_cast<int>(input.size()));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return input.size() / seconds;
+}
+
+std::vector<std::pair<const char*, DSP::FIR::DotProductFunc>> dotProductKernels() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<std::pair<const char*, DSP::FIR::DotProductFunc>> kernels = {{"generic", DSP::FIR::dotProductGeneric}};
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        kernels.push_back({"SSE", DSP::FIR::dotProductSSE});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", DSP::FIR::dotProductAVX2});
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", DSP::FIR::dotProductNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int samples = argc > 1 ? std::stoi(argv[1]) : 1 << 20;
+
+    std::mt19937 generator(1);
+    std::normal_distribution<float> distribution;
+    std::vector<complex> input(samples);
+    for(auto& sample : input) {
+        sample = complex(distribution(generator), distribution(generator));
+    }
+    std::vector<complex> output(samples);
+
+    for(int taps : {31, 32, 64, 128, 256}) {
+        const std::vector<float> coeffs = DSP::TAPS::rootRaisedCosine(taps, cBeta, cSampleRate / cSymbolRate);
+        std::cout << "taps " << taps << std::endl;
+
+        ListFilter list(coeffs);
+        std::cout << "  list: " << samplesPerSecond(list, input, output) / 1e6 << " Msps" << std::endl;
+
+        for(const auto& kernel : dotProductKernels()) {
+            KernelFilter filter(taps, kernel.second);
+            std::cout << "  " << kernel.first << ": " << samplesPerSecond(filter, input, output) / 1e6 << " Msps" << std::endl;
+        }
+
+        DSP::FFTFilter fftFilter(coeffs);
+        std::cout << "  FFT: " << samplesPerSecond(fftFilter, input, output) / 1e6 << " Msps" << std::endl;
+    }
+    return 0;
+}
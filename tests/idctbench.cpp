@@ -0,0 +1,32 @@
+// 8x8 IDCT throughput of every kernel the CPU supports, in MCUs (one 8x8 block of a channel) per second.
+// Usage: idctbench [blocks] [repeats]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "idctblocks.h"
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::stoi(argv[1]) : 20000;
+    const int repeats = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    const IdctBlocks blocks(count);
+    std::vector<uint8_t> pixels(count * 64);
+
+    for(const auto& kernel : idctKernels()) {
+        // The direct transform is far slower, one pass is enough
+        int passes = kernel.func == decoder::protocol::lrpt::msumr::IdctKernels::idctReference ? 1 : repeats;
+
+        auto start = std::chrono::steady_clock::now();
+        for(int pass = 0; pass < passes; pass++) {
+            for(int b = 0; b < count; b++) {
+                kernel.func(blocks.coefficients(b), blocks.quantization(b), &pixels[b * 64]);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << kernel.name << ": " << static_cast<double>(count) * passes / seconds / 1e6 << " M MCU/s" << std::endl;
+    }
+    return 0;
+}
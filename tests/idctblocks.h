@@ -0,0 +1,92 @@
+#ifndef IDCTBLOCKS_H
+#define IDCTBLOCKS_H
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "cpufeatures.h"
+#include "protocol/lrpt/msumr/idct.h"
+
+struct IdctKernel {
+    const char* name;
+    decoder::protocol::lrpt::msumr::IdctKernels::IdctFunc func;
+};
+
+// The reference and every fast kernel the CPU supports
+inline std::vector<IdctKernel> idctKernels() {
+    using namespace decoder::protocol::lrpt::msumr::IdctKernels;
+
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<IdctKernel> kernels = {{"reference", idctReference}, {"generic", idctGeneric}};
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        kernels.push_back({"SSE2", idctSSE2});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", idctAVX2});
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", idctNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+// Random quantized blocks shaped like MSU-MR data: any DC, mostly small low frequency AC and few high frequency ones.
+// The blocks cycle through the quantization tables of quality 20-90, built like Image::fillDqtByQ.
+class IdctBlocks {
+  public:
+    explicit IdctBlocks(int count, uint32_t seed = 5)
+        : mCoefficients(count * 64) {
+        static constexpr std::array<uint8_t, 64> cStandardTable{16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,  14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+                                                                 18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
+        for(int q = 0; q < cTables; q++) {
+            int quality = 20 + q * 10;
+            float f = (quality > 20 && quality < 50) ? 5000.0 / quality : 200.0 - 2.0 * quality;
+            for(int i = 0; i < 64; i++) {
+                mSteps[q][i] = std::max(1, static_cast<int>(std::round(f / 100. * cStandardTable[i])));
+            }
+            decoder::protocol::lrpt::msumr::IdctKernels::fillQuantizationTable(mSteps[q], mQuantization[q]);
+        }
+
+        std::mt19937 generator(seed);
+        for(int b = 0; b < count; b++) {
+            int32_t* block = &mCoefficients[b * 64];
+            block[0] = static_cast<int32_t>(generator() % 256) - 128;
+            for(int i = 1; i < 64; i++) {
+                bool nonZero = static_cast<int>(generator() % 100) < (i < 10 ? 50 : 15);
+                block[i] = nonZero ? static_cast<int32_t>(generator() % 21) - 10 : 0;
+            }
+        }
+    }
+
+    int count() const {
+        return static_cast<int>(mCoefficients.size() / 64);
+    }
+
+    const int32_t* coefficients(int block) const {
+        return &mCoefficients[block * 64];
+    }
+
+    const std::array<int, 64>& steps(int block) const {
+        return mSteps[block % cTables];
+    }
+
+    const decoder::protocol::lrpt::msumr::IdctKernels::QuantizationTable& quantization(int block) const {
+        return mQuantization[block % cTables];
+    }
+
+  private:
+    static constexpr int cTables = 8;
+    std::vector<int32_t> mCoefficients;
+    std::array<std::array<int, 64>, cTables> mSteps;
+    std::array<decoder::protocol::lrpt::msumr::IdctKernels::QuantizationTable, cTables> mQuantization;
+};
+
+#endif // IDCTBLOCKS_H
@@ -0,0 +1,84 @@
+// Checks the IDCT kernels on random quantized blocks at several quality factors. idctReference has to give exactly
+// the pixels of the direct transform Image used before the AAN kernels, the fast kernels may be off by one level.
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "idctblocks.h"
+
+namespace {
+
+using namespace decoder::protocol::lrpt::msumr;
+
+// The former Image::filtIdct8x8 followed by the rounding and saturation of Image::fillPix
+void directIdct(const int32_t* coefficients, const std::array<int, 64>& steps, uint8_t* pixels) {
+    static float cosine[8][8];
+    static float alpha[8];
+    static bool initialized = false;
+    if(!initialized) {
+        for(int y = 0; y < 8; y++) {
+            for(int x = 0; x < 8; x++) {
+                cosine[y][x] = cos(M_PI / 16 * (2 * y + 1) * x);
+            }
+        }
+        for(int x = 0; x < 8; x++) {
+            alpha[x] = (x == 0) ? 1.0f / std::sqrt(2.0f) : 1.0f;
+        }
+        initialized = true;
+    }
+
+    std::array<float, 64> inp;
+    for(int i = 0; i < 64; i++) {
+        inp[i] = coefficients[i] * steps[i];
+    }
+    for(int y = 0; y < 8; y++) {
+        for(int x = 0; x < 8; x++) {
+            float s = 0;
+            for(int u = 0; u < 8; u++) {
+                float cxu = alpha[u] * cosine[x][u];
+                s += cxu
+                     * (inp[0 * 8 + u] * alpha[0] * cosine[y][0] + inp[1 * 8 + u] * alpha[1] * cosine[y][1] + inp[2 * 8 + u] * alpha[2] * cosine[y][2] + inp[3 * 8 + u] * alpha[3] * cosine[y][3]
+                        + inp[4 * 8 + u] * alpha[4] * cosine[y][4] + inp[5 * 8 + u] * alpha[5] * cosine[y][5] + inp[6 * 8 + u] * alpha[6] * cosine[y][6] + inp[7 * 8 + u] * alpha[7] * cosine[y][7]);
+            }
+            int t = std::round(s / 4 + 128.0f);
+            pixels[y * 8 + x] = t < 0 ? 0 : (t > 255 ? 255 : t);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    static constexpr int cBlocks = 20000;
+    static constexpr double cMinPsnr = 70.0;
+
+    const IdctBlocks blocks(cBlocks);
+    std::vector<uint8_t> expected(cBlocks * 64);
+    for(int b = 0; b < cBlocks; b++) {
+        directIdct(blocks.coefficients(b), blocks.steps(b), &expected[b * 64]);
+    }
+
+    bool passed = true;
+    std::vector<uint8_t> pixels(cBlocks * 64);
+    for(const auto& kernel : idctKernels()) {
+        for(int b = 0; b < cBlocks; b++) {
+            kernel.func(blocks.coefficients(b), blocks.quantization(b), &pixels[b * 64]);
+        }
+
+        int maxError = 0;
+        double squaredError = 0.0;
+        for(std::size_t i = 0; i < pixels.size(); i++) {
+            int error = std::abs(pixels[i] - expected[i]);
+            maxError = std::max(maxError, error);
+            squaredError += error * error;
+        }
+        double psnr = squaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / (squaredError / pixels.size())) : INFINITY;
+
+        bool exact = kernel.func == IdctKernels::idctReference;
+        bool kernelPassed = exact ? maxError == 0 : (maxError <= 1 && psnr >= cMinPsnr);
+        std::cout << (kernelPassed ? "PASS " : "FAIL ") << kernel.name << " max error " << maxError << " PSNR " << psnr << " dB" << std::endl;
+        passed &= kernelPassed;
+    }
+    return passed ? 0 : 1;
+}
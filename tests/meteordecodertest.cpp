@@ -0,0 +1,145 @@
+// Checks that the streaming MeteorDecoder gives the same CADUs whatever the chunking of the soft bits is.
+// The stream holds runs of valid CADUs (Reed-Solomon encoded, randomized, convolutionally encoded) separated by noise,
+// every CADU has to come out of the whole buffer decode and the chunked decodes the same. Builds without libcorrect,
+// the frames go through the in-tree Viterbi decoder and the clean codewords never reach the full Reed-Solomon decoder.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "meteordecoder.h"
+#include "reedsolomonencoder.h"
+
+namespace {
+
+static constexpr uint8_t cPolynomA = 0x4F;
+static constexpr uint8_t cPolynomB = 0x6D;
+static constexpr int cRuns = 3;
+static constexpr int cFramesPerRun = 50;
+
+// Same pattern as MeteorDecoder::PRAND, the CCSDS pseudo-random sequence x^8 + x^7 + x^5 + x^3 + 1 from all ones
+std::vector<uint8_t> randomizationPattern() {
+    std::vector<uint8_t> pattern(255);
+    uint8_t state = 0xFF;
+    for(auto& byte : pattern) {
+        byte = 0;
+        for(int bit = 0; bit < 8; bit++) {
+            byte = static_cast<uint8_t>((byte << 1) | (state & 1));
+            uint8_t feedback = ((state >> 0) ^ (state >> 3) ^ (state >> 5) ^ (state >> 7)) & 1;
+            state = static_cast<uint8_t>((state >> 1) | (feedback << 7));
+        }
+    }
+    return pattern;
+}
+
+int parity(uint32_t value) {
+    value ^= value >> 4;
+    value ^= value >> 2;
+    value ^= value >> 1;
+    return value & 1;
+}
+
+struct Stream {
+    std::vector<uint8_t> softBits;
+    // The CADUs as the decoder passes them on: sync word and the data bytes of the 4 codewords, the parity stays zero
+    std::vector<std::vector<uint8_t>> cadus;
+};
+
+Stream synthesize() {
+    static const uint8_t syncWord[4] = {0x1A, 0xCF, 0xFC, 0x1D};
+    const ReedSolomonEncoder encoder;
+    const std::vector<uint8_t> pattern = randomizationPattern();
+    std::mt19937 generator(14);
+    Stream stream;
+
+    auto noise = [&](int length) {
+        for(int i = 0; i < length; i++) {
+            stream.softBits.push_back(static_cast<uint8_t>(generator()));
+        }
+    };
+
+    uint32_t shiftRegister = 0;
+    auto convolutionalEncode = [&](const uint8_t* bytes, int length) {
+        for(int i = 0; i < length * 8; i++) {
+            shiftRegister = ((shiftRegister << 1) | ((bytes[i / 8] >> (7 - i % 8)) & 1)) & 0x7F;
+            stream.softBits.push_back(parity(shiftRegister & cPolynomA) ? 207 : 47);
+            stream.softBits.push_back(parity(shiftRegister & cPolynomB) ? 207 : 47);
+        }
+    };
+
+    for(int run = 0; run < cRuns; run++) {
+        noise(5000 + generator() % 20000);
+        for(int f = 0; f < cFramesPerRun; f++) {
+            uint8_t data[255 * 4];
+            for(int c = 0; c < 4; c++) {
+                uint8_t codeword[255];
+                for(int i = 0; i < 223; i++) {
+                    codeword[i] = static_cast<uint8_t>(generator());
+                }
+                // Byte 9 of the CADU is zero like in the VCDU header, the decoder resolves the inverted phases by it
+                if(c == 1) {
+                    codeword[1] = 0;
+                }
+                encoder.encode(codeword);
+                for(int i = 0; i < 255; i++) {
+                    data[i * 4 + c] = codeword[i];
+                }
+            }
+
+            std::vector<uint8_t> cadu(1024, 0);
+            std::copy(syncWord, syncWord + 4, cadu.begin());
+            std::copy(data, data + 223 * 4, cadu.begin() + 4);
+            stream.cadus.push_back(cadu);
+
+            uint8_t transmitted[1024];
+            std::copy(syncWord, syncWord + 4, transmitted);
+            for(int i = 0; i < 255 * 4; i++) {
+                transmitted[4 + i] = data[i] ^ pattern[i % 255];
+            }
+            convolutionalEncode(transmitted, sizeof(transmitted));
+        }
+    }
+    noise(30000);
+    return stream;
+}
+
+// chunkSize 0 decodes the whole buffer at once
+std::vector<std::vector<uint8_t>> decode(std::vector<uint8_t>& softBits, size_t chunkSize) {
+    std::vector<std::vector<uint8_t>> cadus;
+    auto collect = [&cadus](const uint8_t* cadu, std::size_t size) {
+        cadus.emplace_back(cadu, cadu + size);
+    };
+
+    MeteorDecoder decoder(false, false, false, 2);
+    decoder.setVerbose(false);
+    if(chunkSize == 0) {
+        decoder.decode(softBits.data(), softBits.size(), collect);
+        return cadus;
+    }
+
+    decoder.start(collect);
+    for(size_t i = 0; i < softBits.size(); i += chunkSize) {
+        decoder.decode(&softBits[i], std::min(chunkSize, softBits.size() - i));
+    }
+    decoder.finish();
+    return cadus;
+}
+
+} // namespace
+
+int main() {
+    Stream stream = synthesize();
+
+    std::vector<std::vector<uint8_t>> expected = decode(stream.softBits, 0);
+    bool passed = expected == stream.cadus;
+    std::cout << (passed ? "PASS" : "FAIL") << " whole buffer: " << expected.size() << " CADUs of " << stream.cadus.size() << std::endl;
+
+    for(size_t chunkSize : {1, 7, 4095}) {
+        std::vector<std::vector<uint8_t>> cadus = decode(stream.softBits, chunkSize);
+        bool same = cadus == expected;
+        std::cout << (same ? "PASS" : "FAIL") << " chunk " << chunkSize << ": " << cadus.size() << " CADUs" << std::endl;
+        passed &= same;
+    }
+    return passed ? 0 : 1;
+}
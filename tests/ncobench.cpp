@@ -0,0 +1,99 @@
+// Accuracy and throughput of the polynomial NCO functions against libm sinf/cosf/atan2f.
+// The accuracy is the largest absolute error over [-2pi, 2pi] (the loop phase range) and over random atan2 arguments,
+// the throughput is measured on independent samples, so it is not bound by the latency of a loop recursion.
+// Usage: ncobench [samples]
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "nco.h"
+
+namespace {
+
+template <typename Function>
+double nanosecondsPerCall(const Function& function, int count) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds / count * 1e9;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int samples = argc > 1 ? std::stoi(argv[1]) : 1 << 22;
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> phaseDistribution(-2.0f * M_PI, 2.0f * M_PI);
+    std::normal_distribution<float> distribution;
+    std::vector<float> phases(samples);
+    std::vector<float> ys(samples);
+    std::vector<float> xs(samples);
+    for(int i = 0; i < samples; i++) {
+        phases[i] = phaseDistribution(generator);
+        ys[i] = distribution(generator);
+        xs[i] = distribution(generator);
+    }
+
+    double sinError = 0.0;
+    double cosError = 0.0;
+    double atan2Error = 0.0;
+    for(int i = 0; i < samples; i++) {
+        float sinValue;
+        float cosValue;
+        DSP::NCO::sinCos(phases[i], sinValue, cosValue);
+        sinError = std::max(sinError, std::fabs(static_cast<double>(sinValue) - std::sin(static_cast<double>(phases[i]))));
+        cosError = std::max(cosError, std::fabs(static_cast<double>(cosValue) - std::cos(static_cast<double>(phases[i]))));
+        atan2Error = std::max(atan2Error, std::fabs(static_cast<double>(DSP::NCO::atan2(ys[i], xs[i])) - std::atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i]))));
+    }
+    std::cout << "Max error vs double precision libm: sin " << sinError << " cos " << cosError << " atan2 " << atan2Error << " rad" << std::endl;
+
+    std::vector<float> sinValues(samples);
+    std::vector<float> cosValues(samples);
+    std::vector<float> angles(samples);
+
+    double ncoSinCos = nanosecondsPerCall(
+        [&]() {
+            for(int i = 0; i < samples; i++) {
+                DSP::NCO::sinCos(phases[i], sinValues[i], cosValues[i]);
+            }
+        },
+        samples);
+    double libmSinCos = nanosecondsPerCall(
+        [&]() {
+            for(int i = 0; i < samples; i++) {
+                sinValues[i] = sinf(phases[i]);
+                cosValues[i] = cosf(phases[i]);
+            }
+        },
+        samples);
+    double ncoAtan2 = nanosecondsPerCall(
+        [&]() {
+            for(int i = 0; i < samples; i++) {
+                angles[i] = DSP::NCO::atan2(ys[i], xs[i]);
+            }
+        },
+        samples);
+    double libmAtan2 = nanosecondsPerCall(
+        [&]() {
+            for(int i = 0; i < samples; i++) {
+                angles[i] = atan2f(ys[i], xs[i]);
+            }
+        },
+        samples);
+
+    // Keeps the results alive
+    float checksum = 0.0f;
+    for(int i = 0; i < samples; i += 4096) {
+        checksum += sinValues[i] + cosValues[i] + angles[i];
+    }
+
+    std::cout << "sinCos: NCO " << ncoSinCos << " ns, sinf + cosf " << libmSinCos << " ns" << std::endl;
+    std::cout << "atan2:  NCO " << ncoAtan2 << " ns, atan2f " << libmAtan2 << " ns" << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
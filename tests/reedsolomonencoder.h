@@ -0,0 +1,82 @@
+#ifndef REEDSOLOMONENCODER_H
+#define REEDSOLOMONENCODER_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+// Reed-Solomon (255, 223) encoder of the tests, over the field of the Meteor code: polynomial 0x187, first root 112, root gap 11,
+// 32 roots, the first byte of a codeword is the highest degree
+class ReedSolomonEncoder {
+  public:
+    static constexpr int cRoots = 32;
+    static constexpr int cFirstRoot = 112;
+    static constexpr int cRootGap = 11;
+
+  public:
+    ReedSolomonEncoder() {
+        int element = 1;
+        for(int i = 0; i < 255; i++) {
+            mExp[i] = mExp[i + 255] = static_cast<uint8_t>(element);
+            mLog[element] = static_cast<uint8_t>(i);
+            element <<= 1;
+            if(element & 0x100) {
+                element ^= 0x187;
+            }
+        }
+
+        // Generator polynomial, highest degree first
+        mGenerator.assign(1, 1);
+        for(int j = 0; j < cRoots; j++) {
+            uint8_t root = mExp[rootLog(j)];
+            std::vector<uint8_t> product(mGenerator.size() + 1, 0);
+            for(size_t i = 0; i < mGenerator.size(); i++) {
+                product[i] ^= mGenerator[i];
+                product[i + 1] ^= mul(mGenerator[i], root);
+            }
+            mGenerator = product;
+        }
+    }
+
+    static int rootLog(int j) {
+        return (cRootGap * (cFirstRoot + j)) % 255;
+    }
+
+    uint8_t mul(uint8_t a, uint8_t b) const {
+        return a == 0 || b == 0 ? 0 : mExp[mLog[a] + mLog[b]];
+    }
+
+    uint8_t mulLog(uint8_t a, int factorLog) const {
+        return a == 0 ? 0 : mExp[mLog[a] + factorLog];
+    }
+
+    // Systematic encoding, the parity bytes are the remainder of the message times x^32 divided by the generator
+    void encode(uint8_t* codeword) const {
+        uint8_t remainder[cRoots] = {};
+        for(int i = 0; i < 255 - cRoots; i++) {
+            uint8_t feedback = codeword[i] ^ remainder[0];
+            for(int k = 0; k < cRoots - 1; k++) {
+                remainder[k] = remainder[k + 1] ^ mul(feedback, mGenerator[k + 1]);
+            }
+            remainder[cRoots - 1] = mul(feedback, mGenerator[cRoots]);
+        }
+        std::copy(remainder, remainder + cRoots, codeword + 255 - cRoots);
+    }
+
+    // Syndrome j of the codeword in data[0], data[stride], ..., byte i is the coefficient of x^(254 - i)
+    uint8_t syndrome(const uint8_t* data, int j, int stride = 1) const {
+        uint8_t value = 0;
+        for(int i = 0; i < 255; i++) {
+            value = mulLog(value, rootLog(j)) ^ data[i * stride];
+        }
+        return value;
+    }
+
+  private:
+    uint8_t mExp[255 * 2];
+    uint8_t mLog[256];
+    std::vector<uint8_t> mGenerator;
+};
+
+#endif // REEDSOLOMONENCODER_H
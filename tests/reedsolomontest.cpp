@@ -0,0 +1,174 @@
+// Checks the Reed-Solomon syndrome kernels without libcorrect, against codewords of an encoder over the same field.
+// Every kernel the CPU supports has to give the accumulators of the generic one, the combined syndromes have to match a direct
+// evaluation, be zero for valid codewords and non-zero for any single corrupted byte.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "cpufeatures.h"
+#include "reedsolomon.h"
+#include "reedsolomonencoder.h"
+
+namespace {
+
+static constexpr int cRoots = ReedSolomonEncoder::cRoots;
+static constexpr int cInterleave = ReedSolomon::cInterleave;
+static constexpr int cSize = 255 * cInterleave;
+
+struct Kernel {
+    const char* name;
+    ReedSolomon::SyndromesFunc syndromes;
+};
+
+std::vector<Kernel> syndromeKernels() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<Kernel> kernels;
+#if defined(CPU_X86)
+    if(cpu.hasSSSE3()) {
+        kernels.push_back({"SSSE3", ReedSolomon::syndromesSSSE3});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", ReedSolomon::syndromesAVX2});
+    }
+#endif
+#if defined(CPU_NEON) && defined(__aarch64__)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", ReedSolomon::syndromesNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+// The accumulators combined like ReedSolomon::decodeInterleaved does
+uint8_t combine(const ReedSolomonEncoder& field, const uint8_t* accumulators, int c, int j) {
+    const uint8_t* accumulator = &accumulators[j * 16 + c];
+    uint8_t syndrome = accumulator[12];
+    for(int p = 0; p < 3; p++) {
+        syndrome ^= field.mulLog(accumulator[p * 4], (ReedSolomonEncoder::rootLog(j) * (3 - p)) % 255);
+    }
+    return syndrome;
+}
+
+std::vector<uint8_t> interleavedCodewords(const ReedSolomonEncoder& field, std::mt19937& generator) {
+    std::vector<uint8_t> data(cSize);
+    for(int c = 0; c < cInterleave; c++) {
+        uint8_t codeword[255];
+        for(int i = 0; i < 255 - cRoots; i++) {
+            codeword[i] = static_cast<uint8_t>(generator());
+        }
+        field.encode(codeword);
+        for(int i = 0; i < 255; i++) {
+            data[i * cInterleave + c] = codeword[i];
+        }
+    }
+    return data;
+}
+
+// Returns false when a kernel differs from the generic one, nonZero[c] tells if codeword c has a non-zero syndrome
+bool syndromes(const ReedSolomonEncoder& field, const std::vector<uint8_t>& data, bool* nonZero, bool compareDirect) {
+    alignas(32) uint8_t expected[cRoots * 16];
+    ReedSolomon::syndromesGeneric(data.data(), expected);
+
+    bool passed = true;
+    for(const Kernel& kernel : syndromeKernels()) {
+        alignas(32) uint8_t accumulators[cRoots * 16];
+        kernel.syndromes(data.data(), accumulators);
+        if(!std::equal(accumulators, accumulators + cRoots * 16, expected)) {
+            std::cout << "FAIL " << kernel.name << " accumulators differ from the generic kernel" << std::endl;
+            passed = false;
+        }
+    }
+
+    for(int c = 0; c < cInterleave; c++) {
+        nonZero[c] = false;
+        for(int j = 0; j < cRoots; j++) {
+            uint8_t syndrome = combine(field, expected, c, j);
+            if(compareDirect && syndrome != field.syndrome(data.data() + c, j, cInterleave)) {
+                std::cout << "FAIL syndrome " << j << " of codeword " << c << " differs from the direct evaluation" << std::endl;
+                passed = false;
+            }
+            nonZero[c] |= syndrome != 0;
+        }
+    }
+    return passed;
+}
+
+bool checkValid(const ReedSolomonEncoder& field, std::mt19937& generator) {
+    bool passed = true;
+    for(int round = 0; round < 20; round++) {
+        std::vector<uint8_t> data = interleavedCodewords(field, generator);
+        bool nonZero[cInterleave];
+        passed &= syndromes(field, data, nonZero, true);
+        for(int c = 0; c < cInterleave; c++) {
+            passed &= !nonZero[c];
+        }
+
+        // Random bytes are no codewords, the kernels and the combination still have to agree with the direct evaluation
+        for(auto& byte : data) {
+            byte = static_cast<uint8_t>(generator());
+        }
+        passed &= syndromes(field, data, nonZero, true);
+    }
+    std::cout << (passed ? "PASS " : "FAIL ") << "valid codewords have zero syndromes, random data matches the direct evaluation" << std::endl;
+    return passed;
+}
+
+// Every position of every codeword, including the first and the last byte
+bool checkCorrupted(const ReedSolomonEncoder& field, std::mt19937& generator) {
+    std::vector<uint8_t> data = interleavedCodewords(field, generator);
+    bool passed = true;
+    for(int c = 0; c < cInterleave; c++) {
+        for(int i = 0; i < 255; i++) {
+            std::vector<uint8_t> corrupted(data);
+            corrupted[i * cInterleave + c] ^= static_cast<uint8_t>(1 + generator() % 255);
+            bool nonZero[cInterleave];
+            bool same = syndromes(field, corrupted, nonZero, false);
+            for(int other = 0; other < cInterleave; other++) {
+                same &= nonZero[other] == (other == c);
+            }
+            if(!same) {
+                std::cout << "FAIL corrupted byte " << i << " of codeword " << c << std::endl;
+            }
+            passed &= same;
+        }
+    }
+    std::cout << (passed ? "PASS " : "FAIL ") << "every single corrupted byte gives non-zero syndromes in its codeword only" << std::endl;
+    return passed;
+}
+
+// Clean codewords are only copied, a corrupted one goes to the full decoder (libcorrect is not linked, it reports a failure)
+bool checkDecodeInterleaved(const ReedSolomonEncoder& field, std::mt19937& generator) {
+    ReedSolomon reedSolomon;
+    std::vector<uint8_t> data = interleavedCodewords(field, generator);
+    std::vector<uint8_t> output(223 * cInterleave);
+    int results[cInterleave];
+
+    reedSolomon.decodeInterleaved(data.data(), output.data(), results);
+    bool passed = std::equal(output.begin(), output.end(), data.begin());
+    for(int c = 0; c < cInterleave; c++) {
+        passed &= results[c] == 0;
+    }
+
+    data[254 * cInterleave + 2] ^= 0x5A;
+    reedSolomon.decodeInterleaved(data.data(), output.data(), results);
+    passed &= results[0] == 0 && results[1] == 0 && results[2] != 0 && results[3] == 0;
+
+    std::cout << (passed ? "PASS " : "FAIL ") << "decodeInterleaved copies clean codewords and decodes the corrupted one" << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    std::cout << (syndromeKernels().empty() ? "Generic kernel only" : "Generic and SIMD kernels") << std::endl;
+    ReedSolomonEncoder field;
+    std::mt19937 generator(16);
+    bool passed = true;
+    passed &= checkValid(field, generator);
+    passed &= checkCorrupted(field, generator);
+    passed &= checkDecodeInterleaved(field, generator);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#ifndef REFERENCECORRELATION_H
+#define REFERENCECORRELATION_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "correlation.h"
+
+// The byte by byte correlator Correlation replaced, every position compares 64 soft bits with every kernel.
+// Kept for the tests and benchmarks as the reference the packed correlator has to agree with.
+class ReferenceCorrelation {
+  public:
+    ReferenceCorrelation(uint64_t syncWord, bool oqpsk) {
+        Correlation correlation(syncWord, oqpsk);
+        for(int i = 0; i < 8; i++) {
+            mKernels.push_back(hardToSoft(correlation.rotate64(syncWord, i)));
+        }
+        if(oqpsk) {
+            for(int i = 0; i < 8; i++) {
+                mKernels.push_back(mKernels[i]);
+                uint8_t last = 0;
+                for(int k = 0; k < 32; k++) {
+                    uint8_t back = mKernels.back()[k * 2 + 1];
+                    mKernels.back()[k * 2 + 1] = last;
+                    last = back;
+                }
+            }
+        }
+    }
+
+    void correlate(const uint8_t* softBits, int64_t size, Correlation::CorrelationCallback callback) const {
+        Correlation::CorellationResult result{};
+
+        for(int64_t i = 0; i < size - 64; i++) {
+            for(int n = 0; n < static_cast<int>(mKernels.size()); n++) {
+                uint32_t score = 0;
+                for(int k = 0; k < 64; k++) {
+                    score += (softBits[i + k] >= 127) == (mKernels[n][k] == 0xFF);
+                }
+                if(score >= cCorrelationLimit) {
+                    result.pos = static_cast<uint32_t>(i);
+                    result.corr = score;
+                    i += callback(result, static_cast<Correlation::PhaseShift>(n));
+                    break;
+                }
+            }
+        }
+    }
+
+  private:
+    static std::vector<uint8_t> hardToSoft(uint64_t word) {
+        std::vector<uint8_t> soft(64);
+        for(int i = 0; i < 64; i++) {
+            soft[i] = (word >> (63 - i)) & 1 ? 0xFF : 0x00;
+        }
+        return soft;
+    }
+
+  private:
+    static constexpr uint32_t cCorrelationLimit = 54;
+    std::vector<std::vector<uint8_t>> mKernels;
+};
+
+#endif // REFERENCECORRELATION_H
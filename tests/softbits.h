@@ -0,0 +1,38 @@
+#ifndef SOFTBITS_H
+#define SOFTBITS_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "correlation.h"
+
+// Synthetic soft bits for the tests and benchmarks: random data with a sync word in a random rotation every frameBits bits,
+// +-60 around the 127 midpoint with gaussian noise of the given deviation
+inline std::vector<uint8_t> syntheticSoftBits(int64_t size, uint64_t syncWord, bool oqpsk, float noise, int frameBits = 16384, uint32_t seed = 1) {
+    std::mt19937 generator(seed);
+    std::normal_distribution<float> distribution;
+    Correlation correlation(syncWord, oqpsk);
+
+    std::vector<uint8_t> bits(size);
+    for(auto& bit : bits) {
+        bit = generator() & 1;
+    }
+    for(int64_t position = 1000; position + 64 < size; position += frameBits) {
+        uint64_t word = correlation.rotate64(syncWord, generator() % 8);
+        for(int k = 0; k < 64; k++) {
+            bits[position + k] = (word >> (63 - k)) & 1;
+        }
+    }
+
+    std::vector<uint8_t> softBits(size);
+    for(int64_t i = 0; i < size; i++) {
+        float value = 127.0f + (bits[i] ? 60.0f : -60.0f) + distribution(generator) * noise;
+        softBits[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+    }
+    return softBits;
+}
+
+#endif // SOFTBITS_H
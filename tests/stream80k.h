@@ -0,0 +1,44 @@
+#ifndef STREAM80K_H
+#define STREAM80K_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Synthetic interleaved 80k soft bits for the deinterleaver tests and benchmarks: the sync byte 00100111 and 72 random bits
+// every 80 bits, in runs of random length separated by random gaps without sync. +-60 around the 127 midpoint with gaussian noise.
+inline std::vector<uint8_t> synthetic80kStream(uint64_t size, float noise, uint32_t seed = 1) {
+    static const uint8_t syncByte = 0x27;
+    std::mt19937 generator(seed);
+    std::normal_distribution<float> distribution;
+
+    std::vector<uint8_t> bits;
+    bits.reserve(size);
+    while(bits.size() < size) {
+        uint64_t frames = 1000 + generator() % 20000;
+        for(uint64_t f = 0; f < frames; f++) {
+            for(int k = 0; k < 8; k++) {
+                bits.push_back((syncByte >> (7 - k)) & 1);
+            }
+            for(int k = 0; k < 72; k++) {
+                bits.push_back(generator() & 1);
+            }
+        }
+        uint64_t gap = generator() % 5000;
+        for(uint64_t k = 0; k < gap; k++) {
+            bits.push_back(generator() & 1);
+        }
+    }
+    bits.resize(size);
+
+    std::vector<uint8_t> softBits(size);
+    for(uint64_t i = 0; i < size; i++) {
+        float value = 127.0f + (bits[i] ? 60.0f : -60.0f) + distribution(generator) * noise;
+        softBits[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+    }
+    return softBits;
+}
+
+#endif // STREAM80K_H
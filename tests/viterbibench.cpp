@@ -0,0 +1,87 @@
+// Rate 1/2, K = 7 Viterbi decoding speed of the in-tree SIMD decoder and libcorrect, in decoded Mbit/s.
+// Usage: viterbibench [frames] [noise]
+// The frames are 16384 soft bits cut from one continuous encoded stream like the decoder gets them, the noise is the
+// gaussian deviation on the +-80 soft bit levels. The bit errors are printed for the record, the cut frames have no flushed tail.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "viterbi.h"
+
+namespace {
+
+static constexpr int cFrameBits = 16384;
+static constexpr uint8_t cPolynomA = 0x4F;
+static constexpr uint8_t cPolynomB = 0x6D;
+
+int parity(uint32_t value) {
+    value ^= value >> 4;
+    value ^= value >> 2;
+    value ^= value >> 1;
+    return value & 1;
+}
+
+long bitErrors(const std::vector<uint8_t>& decoded, const std::vector<uint8_t>& message) {
+    long errors = 0;
+    for(std::size_t i = 0; i < decoded.size(); i++) {
+        uint8_t difference = decoded[i] ^ message[i];
+        for(; difference != 0; difference &= difference - 1) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int frames = argc > 1 ? std::stoi(argv[1]) : 200;
+    const float noise = argc > 2 ? std::stof(argv[2]) : 60.0f;
+    const int frameBytes = cFrameBits / 16;
+
+    std::mt19937 generator(13);
+    std::normal_distribution<float> distribution;
+    std::vector<uint8_t> message(static_cast<std::size_t>(frames) * frameBytes);
+    for(auto& byte : message) {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    // Shift register with the newest bit in bit 0, soft bits 0 is a confident 0 and 255 a confident 1
+    std::vector<uint8_t> softBits(message.size() * 16);
+    uint32_t shiftRegister = 0;
+    for(std::size_t i = 0; i < message.size() * 8; i++) {
+        shiftRegister = ((shiftRegister << 1) | ((message[i / 8] >> (7 - i % 8)) & 1)) & 0x7F;
+        for(int polynom = 0; polynom < 2; polynom++) {
+            int bit = parity(shiftRegister & (polynom == 0 ? cPolynomA : cPolynomB));
+            float value = 127.5f + (bit ? 80.0f : -80.0f) + distribution(generator) * noise;
+            softBits[i * 2 + polynom] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+        }
+    }
+
+    std::vector<uint8_t> decoded(message.size());
+
+    Viterbi viterbi(7, cPolynomA, cPolynomB);
+    auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < frames; frame++) {
+        viterbi.decodeSoft(&softBits[static_cast<std::size_t>(frame) * cFrameBits], &decoded[static_cast<std::size_t>(frame) * frameBytes], cFrameBits);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Viterbi:    " << message.size() * 8 / seconds / 1e6 << " Mbit/s, " << bitErrors(decoded, message) << " bit errors" << std::endl;
+
+    correct_convolutional_polynomial_t polynomials[2] = {cPolynomA, cPolynomB};
+    correct_convolutional* convolutional = correct_convolutional_create(2, 7, polynomials);
+    start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < frames; frame++) {
+        correct_convolutional_decode_soft(convolutional, &softBits[static_cast<std::size_t>(frame) * cFrameBits], cFrameBits, &decoded[static_cast<std::size_t>(frame) * frameBytes]);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    correct_convolutional_destroy(convolutional);
+    std::cout << "libcorrect: " << message.size() * 8 / seconds / 1e6 << " Mbit/s, " << bitErrors(decoded, message) << " bit errors" << std::endl;
+
+    std::cout << frames << " frames of " << cFrameBits << " soft bits, noise " << noise << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Checks the in-tree rate 1/2, K = 7 Viterbi decoder without libcorrect.
+// Every forward kernel the CPU supports has to produce the decisions and metrics of the generic one, Viterbi has to decode
+// clean frames cut from a continuous stream without bit errors and report the BER of the received hard bits against the re-encoded path.
+// ctest runs it a second time with METEORDEMOD_DISABLE_SIMD set, then only the generic kernels are used.
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "cpufeatures.h"
+#include "viterbi.h"
+#include "viterbikernels.h"
+
+namespace {
+
+static constexpr int cFrameBits = 16384;
+static constexpr int cFrameBytes = cFrameBits / 16;
+static constexpr int cFrames = 20;
+static constexpr uint8_t cPolynomA = 0x4F;
+static constexpr uint8_t cPolynomB = 0x6D;
+
+struct Kernel {
+    const char* name;
+    ViterbiKernels::ForwardFunc forward;
+};
+
+std::vector<Kernel> forwardKernels() {
+    const CpuFeatures& cpu = CpuFeatures::getInstance();
+    std::vector<Kernel> kernels;
+#if defined(CPU_X86)
+    if(cpu.hasSSE2()) {
+        kernels.push_back({"SSE2", ViterbiKernels::forwardSSE2});
+    }
+    if(cpu.hasAVX2()) {
+        kernels.push_back({"AVX2", ViterbiKernels::forwardAVX2});
+    }
+#endif
+#if defined(CPU_NEON)
+    if(cpu.hasNEON()) {
+        kernels.push_back({"NEON", ViterbiKernels::forwardNEON});
+    }
+#endif
+    (void)cpu;
+    return kernels;
+}
+
+int parity(uint32_t value) {
+    value ^= value >> 4;
+    value ^= value >> 2;
+    value ^= value >> 1;
+    return value & 1;
+}
+
+struct Stream {
+    std::vector<uint8_t> message;
+    std::vector<uint8_t> codeBits;
+    std::vector<uint8_t> softBits;
+};
+
+// Encoded like viterbibench, the shift register runs on over the frame boundaries. Every erasureInterval-th soft bit is set to 128.
+Stream encode(float noise, int erasureInterval, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::normal_distribution<float> distribution;
+    Stream stream;
+    stream.message.resize(static_cast<size_t>(cFrames) * cFrameBytes);
+    for(auto& byte : stream.message) {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    stream.codeBits.resize(stream.message.size() * 16);
+    stream.softBits.resize(stream.message.size() * 16);
+    uint32_t shiftRegister = 0;
+    for(size_t i = 0; i < stream.message.size() * 8; i++) {
+        shiftRegister = ((shiftRegister << 1) | ((stream.message[i / 8] >> (7 - i % 8)) & 1)) & 0x7F;
+        for(int polynom = 0; polynom < 2; polynom++) {
+            size_t n = i * 2 + polynom;
+            stream.codeBits[n] = static_cast<uint8_t>(parity(shiftRegister & (polynom == 0 ? cPolynomA : cPolynomB)));
+            float value = 127.5f + (stream.codeBits[n] ? 80.0f : -80.0f) + distribution(generator) * noise;
+            stream.softBits[n] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+            if(erasureInterval > 0 && n % erasureInterval == 0) {
+                stream.softBits[n] = 128;
+            }
+        }
+    }
+    return stream;
+}
+
+long bitErrors(const uint8_t* decoded, const uint8_t* message, int size) {
+    long errors = 0;
+    for(int i = 0; i < size; i++) {
+        errors += std::bitset<8>(decoded[i] ^ message[i]).count();
+    }
+    return errors;
+}
+
+// Same branch masks as Viterbi builds them
+void branchMasks(int16_t* masks) {
+    for(int j = 0; j < ViterbiKernels::cStates / 2; j++) {
+        masks[j] = parity((j * 2) & cPolynomA) ? 255 : 0;
+        masks[j + 32] = parity((j * 2) & cPolynomB) ? 255 : 0;
+    }
+}
+
+bool compareKernels(const Stream& stream) {
+    const int steps = cFrameBits / 2;
+    int16_t masks[ViterbiKernels::cStates];
+    branchMasks(masks);
+
+    std::vector<uint64_t> expectedDecisions(steps);
+    int16_t expectedMetrics[ViterbiKernels::cStates] = {};
+    ViterbiKernels::forwardGeneric(stream.softBits.data(), steps, masks, expectedMetrics, expectedDecisions.data());
+
+    bool passed = true;
+    for(const Kernel& kernel : forwardKernels()) {
+        std::vector<uint64_t> decisions(steps);
+        int16_t metrics[ViterbiKernels::cStates] = {};
+        kernel.forward(stream.softBits.data(), steps, masks, metrics, decisions.data());
+
+        bool same = decisions == expectedDecisions && std::memcmp(metrics, expectedMetrics, sizeof(metrics)) == 0;
+        std::cout << (same ? "PASS " : "FAIL ") << kernel.name << " forward kernel against the generic one" << std::endl;
+        passed &= same;
+    }
+    return passed;
+}
+
+bool decodeClean() {
+    Stream stream = encode(0.0f, 0, 7);
+    bool passed = compareKernels(stream);
+
+    Viterbi viterbi(7, cPolynomA, cPolynomB);
+    std::vector<uint8_t> decoded(stream.message.size());
+    long errors = 0;
+    float maxBer = 0.0f;
+    for(int frame = 0; frame < cFrames; frame++) {
+        size_t bytes = viterbi.decodeSoft(&stream.softBits[static_cast<size_t>(frame) * cFrameBits], &decoded[static_cast<size_t>(frame) * cFrameBytes], cFrameBits);
+        if(bytes != static_cast<size_t>(cFrameBytes)) {
+            std::cout << "FAIL decodeSoft returned " << static_cast<long>(bytes) << " bytes instead of " << cFrameBytes << std::endl;
+            return false;
+        }
+        errors += bitErrors(&decoded[static_cast<size_t>(frame) * cFrameBytes], &stream.message[static_cast<size_t>(frame) * cFrameBytes], cFrameBytes);
+        maxBer = std::max(maxBer, viterbi.getLastBER());
+    }
+
+    bool clean = errors == 0 && maxBer == 0.0f;
+    std::cout << (clean ? "PASS " : "FAIL ") << "clean frames: " << errors << " bit errors, max BER " << maxBer << std::endl;
+    return passed && clean;
+}
+
+// With moderate noise the frames still decode without errors, the re-encoded path is then the transmitted code and
+// the BER has to match a count of the disagreeing hard bits that skips the erasures
+bool decodeNoisy() {
+    Stream stream = encode(40.0f, 97, 11);
+    bool passed = compareKernels(stream);
+
+    Viterbi viterbi(7, cPolynomA, cPolynomB);
+    std::vector<uint8_t> decoded(cFrameBytes);
+    for(int frame = 0; frame < cFrames; frame++) {
+        const size_t first = static_cast<size_t>(frame) * cFrameBits;
+        viterbi.decodeSoft(&stream.softBits[first], decoded.data(), cFrameBits);
+        long errors = bitErrors(decoded.data(), &stream.message[static_cast<size_t>(frame) * cFrameBytes], cFrameBytes);
+
+        int disagreeing = 0;
+        int total = 0;
+        for(size_t n = first; n < first + cFrameBits; n++) {
+            if(stream.softBits[n] != 128) {
+                disagreeing += (stream.softBits[n] > 128) != (stream.codeBits[n] != 0);
+                total++;
+            }
+        }
+        float expectedBer = static_cast<float>(disagreeing) / total;
+
+        bool same = errors == 0 && viterbi.getLastBER() == expectedBer;
+        if(!same || frame == 0) {
+            std::cout << (same ? "PASS " : "FAIL ") << "noisy frame " << frame << ": " << errors << " bit errors, BER " << viterbi.getLastBER() << " expected " << expectedBer << std::endl;
+        }
+        passed &= same;
+    }
+    return passed;
+}
+
+} // namespace
+
+int main() {
+    std::cout << (forwardKernels().empty() ? "Generic kernels only" : "Generic and SIMD kernels") << std::endl;
+    bool passed = true;
+    passed &= decodeClean();
+    passed &= decodeNoisy();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#ifndef BLOCKINGQUEUE_H
+#define BLOCKINGQUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+// Unbounded queue guarded by a mutex, pop sleeps until an item arrives
+template <typename T>
+class BlockingQueue {
+  public:
+    BlockingQueue() = default;
+
+    BlockingQueue(const BlockingQueue& other) = delete;
+    BlockingQueue& operator=(const BlockingQueue& other) = delete;
+
+    void push(const T& value) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mQueue.push(value);
+        }
+        mConditionVariable.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mConditionVariable.wait(lock, [this]() {
+            return !mQueue.empty();
+        });
+        T value = mQueue.front();
+        mQueue.pop();
+        return value;
+    }
+
+  private:
+    std::queue<T> mQueue;
+    std::mutex mMutex;
+    std::condition_variable mConditionVariable;
+};
+
+#endif // BLOCKINGQUEUE_H
@@ -0,0 +1,56 @@
+#include "cpufeatures.h"
+
+#include <cstdlib>
+
+#if defined(CPU_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+const CpuFeatures& CpuFeatures::getInstance() {
+    static CpuFeatures instance;
+    return instance;
+}
+
+CpuFeatures::CpuFeatures()
+    : mSSE2(false)
+    , mSSSE3(false)
+    , mSSE41(false)
+    , mAVX2(false)
+    , mPOPCNT(false)
+    , mNEON(false) {
+
+    // Allows to compare the vectorized kernels against the generic implementations
+    if(std::getenv("METEORDEMOD_DISABLE_SIMD") != nullptr) {
+        return;
+    }
+
+#if defined(CPU_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    mSSE2 = __builtin_cpu_supports("sse2");
+    mSSSE3 = __builtin_cpu_supports("ssse3");
+    mSSE41 = __builtin_cpu_supports("sse4.1");
+    mAVX2 = __builtin_cpu_supports("avx2");
+    mPOPCNT = __builtin_cpu_supports("popcnt");
+#elif defined(CPU_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    mSSE2 = (info[3] & (1 << 26)) != 0;
+    mSSSE3 = (info[2] & (1 << 9)) != 0;
+    mSSE41 = (info[2] & (1 << 19)) != 0;
+    mPOPCNT = (info[2] & (1 << 23)) != 0;
+    bool osSavesYmm = ((info[2] & (1 << 27)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+
+    if(maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        mAVX2 = osSavesYmm && ((info[1] & (1 << 5)) != 0);
+    }
+#endif
+
+#if defined(CPU_NEON)
+    mNEON = true;
+#endif
+}
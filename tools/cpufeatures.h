@@ -0,0 +1,66 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CPU_NEON 1
+#endif
+
+// GCC and Clang only emit SIMD instructions for functions explicitly marked with the target ISA,
+// MSVC accepts the intrinsics without annotation
+#if defined(CPU_X86) && defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_POPCNT __attribute__((target("popcnt")))
+#else
+#define TARGET_SSE2
+#define TARGET_SSSE3
+#define TARGET_SSE41
+#define TARGET_AVX2
+#define TARGET_POPCNT
+#endif
+
+class CpuFeatures {
+  public:
+    static const CpuFeatures& getInstance();
+
+  private:
+    CpuFeatures();
+    CpuFeatures(CpuFeatures const&) = delete;
+    void operator=(CpuFeatures const&) = delete;
+
+  public:
+    bool hasSSE2() const {
+        return mSSE2;
+    }
+    bool hasSSSE3() const {
+        return mSSSE3;
+    }
+    bool hasSSE41() const {
+        return mSSE41;
+    }
+    bool hasAVX2() const {
+        return mAVX2;
+    }
+    bool hasPOPCNT() const {
+        return mPOPCNT;
+    }
+    bool hasNEON() const {
+        return mNEON;
+    }
+
+  private:
+    bool mSSE2;
+    bool mSSSE3;
+    bool mSSE41;
+    bool mAVX2;
+    bool mPOPCNT;
+    bool mNEON;
+};
+
+#endif // CPUFEATURES_H
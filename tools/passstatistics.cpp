@@ -0,0 +1,81 @@
+#include "passstatistics.h"
+
+#include <iomanip>
+
+// BER of the frames in 0.5% steps, RS corrections per codeword up to the 16 correctable bytes
+PassStatistics::PassStatistics()
+    : ber(0.005, 40)
+    , rsCorrections(1.0, 17) {}
+
+void PassStatistics::Histogram::add(double value) {
+    int bin = value > 0.0 ? static_cast<int>(value / binWidth) : 0;
+    bins[bin < static_cast<int>(bins.size()) ? bin : bins.size() - 1]++;
+}
+
+static void writeString(std::ostream& stream, const std::string& value) {
+    stream << '"';
+    for(char c : value) {
+        if(c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+static void writeStage(std::ostream& stream, const char* name, const PassStatistics::Stage& stage) {
+    double rate = stage.busySeconds > 0.0 ? stage.items / stage.busySeconds : 0.0;
+    stream << "    \"" << name << "\": {\"items\": " << stage.items << ", \"busySeconds\": " << stage.busySeconds << ", \"itemsPerSecond\": " << rate << "}";
+}
+
+static void writeHistogram(std::ostream& stream, const PassStatistics::Histogram& histogram) {
+    stream << "{\"binWidth\": " << histogram.binWidth << ", \"bins\": [";
+    for(size_t i = 0; i < histogram.bins.size(); i++) {
+        stream << (i > 0 ? ", " : "") << histogram.bins[i];
+    }
+    stream << "]}";
+}
+
+void PassStatistics::writeJson(std::ostream& stream) const {
+    stream << std::setprecision(6) << "{\n  \"input\": ";
+    writeString(stream, inputPath);
+
+    stream << ",\n  \"stages\": {\n";
+    writeStage(stream, "read", read);
+    stream << ",\n";
+    writeStage(stream, "filter", filter);
+    stream << ",\n";
+    writeStage(stream, "recovery", recovery);
+    stream << ",\n";
+    writeStage(stream, "decoder", decoder);
+    stream << ",\n";
+    writeStage(stream, "lrpt", lrpt);
+    stream << ",\n";
+    writeStage(stream, "images", images);
+    stream << "\n  },\n";
+
+    stream << "  \"demodulator\": {\n";
+    stream << "    \"samples\": " << read.items << ",\n";
+    stream << "    \"symbols\": " << symbols << ",\n";
+    stream << "    \"lockTime\": " << lockTime << ",\n";
+    stream << "    \"carrierTrace\": [";
+    for(size_t i = 0; i < carrierTrace.size(); i++) {
+        const CarrierPoint& point = carrierTrace[i];
+        stream << (i > 0 ? ",\n      " : "\n      ") << "{\"time\": " << point.time << ", \"frequency\": " << point.frequency << ", \"lockError\": " << point.lockError << ", \"locked\": " << (point.locked ? "true" : "false") << "}";
+    }
+    stream << (carrierTrace.empty() ? "]\n" : "\n    ]\n") << "  },\n";
+
+    stream << "  \"decoder\": {\n";
+    stream << "    \"softBits\": " << decoder.items << ",\n";
+    stream << "    \"syncWords\": " << syncWords << ",\n";
+    stream << "    \"frames\": " << frames << ",\n";
+    stream << "    \"packets\": " << packets << ",\n";
+    stream << "    \"ber\": ";
+    writeHistogram(stream, ber);
+    stream << ",\n    \"rsCorrections\": ";
+    writeHistogram(stream, rsCorrections);
+    stream << ",\n    \"rsFailures\": " << rsFailures << "\n  }\n}\n";
+}
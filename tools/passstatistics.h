@@ -0,0 +1,73 @@
+#ifndef PASSSTATISTICS_H
+#define PASSSTATISTICS_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Timers, counters and link quality traces of a pass, written as a JSON report.
+// Every member has a single writer thread, the report is written once the pass is processed.
+struct PassStatistics {
+    // Monotonic busy time of a processing stage and the number of items it processed
+    struct Stage {
+        uint64_t items = 0;
+        double busySeconds = 0.0;
+
+        void add(uint64_t count, std::chrono::steady_clock::time_point start) {
+            items += count;
+            busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    // Bins of binWidth from 0, larger values are counted in the last bin
+    struct Histogram {
+        Histogram(double binWidth_, int bins_)
+            : binWidth(binWidth_)
+            , bins(bins_, 0) {}
+
+        void add(double value);
+
+        double binWidth;
+        std::vector<uint64_t> bins;
+    };
+
+    struct CarrierPoint {
+        // Seconds of demodulated signal
+        double time;
+        float frequency;
+        float lockError;
+        bool locked;
+    };
+
+    PassStatistics();
+
+    void writeJson(std::ostream& stream) const;
+
+    std::string inputPath;
+
+    // Demodulator, time is counted in recovered symbols
+    Stage read;
+    Stage filter;
+    Stage recovery;
+    uint64_t symbols = 0;
+    double lockTime = -1.0;
+    std::vector<CarrierPoint> carrierTrace;
+
+    // MeteorDecoder, the stage counts soft bits. A sync word starts a chain of frames, the frames after it are found without search.
+    Stage decoder;
+    uint64_t syncWords = 0;
+    uint64_t frames = 0;
+    uint64_t packets = 0;
+    Histogram ber;
+    Histogram rsCorrections;
+    uint64_t rsFailures = 0;
+
+    // LRPT decoder counts packets, images is the image generation after it
+    Stage lrpt;
+    Stage images;
+};
+
+#endif // PASSSTATISTICS_H
@@ -0,0 +1,131 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread
+template <typename T>
+class SpscQueue {
+  public:
+    explicit SpscQueue(std::size_t capacity)
+        : mBuffer(capacity + 1)
+        , mHead(0)
+        , mTail(0)
+        , mWaiting(0) {}
+
+    SpscQueue(const SpscQueue& other) = delete;
+    SpscQueue& operator=(const SpscQueue& other) = delete;
+
+    bool tryPush(const T& value) {
+        if(!pushOnce(value)) {
+            return false;
+        }
+        wakeWaiting();
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        if(!popOnce(value)) {
+            return false;
+        }
+        wakeWaiting();
+        return true;
+    }
+
+    // Blocking variants, the waiting side spins for a short while then sleeps until the other side moves
+    void push(const T& value) {
+        for(int i = 0; i < cSpinCount; i++) {
+            if(tryPush(value)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        wait([this, &value]() {
+            return pushOnce(value);
+        });
+    }
+
+    T pop() {
+        T value;
+        for(int i = 0; i < cSpinCount; i++) {
+            if(tryPop(value)) {
+                return value;
+            }
+            std::this_thread::yield();
+        }
+        wait([this, &value]() {
+            return popOnce(value);
+        });
+        return value;
+    }
+
+  private:
+    bool pushOnce(const T& value) {
+        const std::size_t tail = mTail.load(std::memory_order_relaxed);
+        const std::size_t next = increment(tail);
+        if(next == mHead.load(std::memory_order_acquire)) {
+            return false;
+        }
+        mBuffer[tail] = value;
+        mTail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool popOnce(T& value) {
+        const std::size_t head = mHead.load(std::memory_order_relaxed);
+        if(head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = mBuffer[head];
+        mHead.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    std::size_t increment(std::size_t index) const {
+        return (index + 1 == mBuffer.size()) ? 0 : index + 1;
+    }
+
+    template <typename Try>
+    void wait(Try tryOnce) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWaiting.fetch_add(1);
+            // Pairs with the fence in wakeWaiting, either the retry sees the other side's update or the other side sees mWaiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while(!tryOnce()) {
+                mCondition.wait(lock);
+            }
+            mWaiting.fetch_sub(1);
+        }
+        wakeWaiting();
+    }
+
+    void wakeWaiting() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(mWaiting.load(std::memory_order_relaxed) > 0) {
+            // Taking the lock orders the notify after the waiter's last retry
+            { std::lock_guard<std::mutex> lock(mMutex); }
+            mCondition.notify_all();
+        }
+    }
+
+  private:
+    // Retries before the blocking calls sleep, a block of the pipelines is usually ready within this
+    static constexpr int cSpinCount = 64;
+
+  private:
+    std::vector<T> mBuffer;
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<std::size_t> mHead;
+    alignas(64) std::atomic<std::size_t> mTail;
+    std::atomic<int> mWaiting;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+#endif // SPSCQUEUE_H